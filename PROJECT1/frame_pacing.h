@@ -0,0 +1,276 @@
+/**
+ * @file frame_pacing.h
+ * @brief Ritmo de frames: vsync, límite de FPS, modo de baja latencia y medición
+ * @details FramePacer reemplaza a glfwSwapBuffers en el bucle principal:
+ *            - vsync apagado, encendido o adaptativo (swap interval -1, que deja
+ *              pasar un frame tarde en lugar de esperar al siguiente refresco; si el
+ *              driver no tiene *_swap_control_tear se usa vsync normal);
+ *            - límite de FPS opcional: duerme hasta poco antes del plazo y espera
+ *              activa solo el último tramo, así que un benchmark sin ventana visible
+ *              no quema un núcleo entero;
+ *            - baja latencia: tras cada swap deja un fence y, al empezar el frame
+ *              siguiente, espera a que la GPU lo pase antes de leer la entrada, para
+ *              que la CPU no se adelante frames enteros;
+ *            - mide el intervalo real entre swaps (media, mínimo, máximo, desvío)
+ *              sobre una ventana de frames recientes.
+ *
+ *          framePacingOptionsFromEnvironment() lee la configuración de variables
+ *          de entorno para cambiarla sin recompilar:
+ *            FRAME_VSYNC=off|on|adaptive  FRAME_FPS=<límite>  FRAME_LOW_LATENCY=1
+ */
+#ifndef FRAME_PACING_H
+#define FRAME_PACING_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+/**
+ * @enum VsyncMode
+ * @brief Sincronización del swap con el refresco de la pantalla
+ */
+enum class VsyncMode
+{
+    Off,     ///< Swap inmediato (puede haber tearing)
+    On,      ///< Espera al refresco
+    Adaptive ///< Espera al refresco salvo que el frame llegue tarde
+};
+
+/**
+ * @struct FramePacingOptions
+ * @brief Configuración de FramePacer
+ */
+struct FramePacingOptions
+{
+    VsyncMode vsync = VsyncMode::On;
+    double targetFps = 0.0;       ///< Límite de FPS; 0 = sin límite
+    bool lowLatency = false;      ///< Esperar el fence del frame anterior en beginFrame
+    double spinSeconds = 0.002;   ///< Tramo final del límite que se espera activamente
+};
+
+/**
+ * @struct FramePacingStats
+ * @brief Intervalo medido entre swaps, en segundos
+ */
+struct FramePacingStats
+{
+    size_t frames = 0;     ///< Swaps desde que se creó el FramePacer
+    double average = 0.0;  ///< Media de la ventana reciente
+    double minimum = 0.0;
+    double maximum = 0.0;
+    double deviation = 0.0; ///< Desvío estándar (jitter)
+    double fenceWait = 0.0; ///< Media de espera del fence (modo de baja latencia)
+
+    double fps() const { return average > 0.0 ? 1.0 / average : 0.0; }
+};
+
+/**
+ * @brief Opciones desde FRAME_VSYNC, FRAME_FPS y FRAME_LOW_LATENCY
+ * @param defaults Valores para las variables que no estén definidas
+ */
+inline FramePacingOptions framePacingOptionsFromEnvironment(FramePacingOptions defaults = FramePacingOptions())
+{
+    if (const char* vsync = std::getenv("FRAME_VSYNC"))
+    {
+        if (std::strcmp(vsync, "off") == 0 || std::strcmp(vsync, "0") == 0)
+            defaults.vsync = VsyncMode::Off;
+        else if (std::strcmp(vsync, "adaptive") == 0 || std::strcmp(vsync, "-1") == 0)
+            defaults.vsync = VsyncMode::Adaptive;
+        else
+            defaults.vsync = VsyncMode::On;
+    }
+    if (const char* fps = std::getenv("FRAME_FPS"))
+        defaults.targetFps = std::max(0.0, std::atof(fps));
+    if (const char* lowLatency = std::getenv("FRAME_LOW_LATENCY"))
+        defaults.lowLatency = std::atoi(lowLatency) != 0;
+    return defaults;
+}
+
+/**
+ * @class FramePacer
+ * @brief Control del ritmo de presentación de una ventana
+ * @details Uso por frame: beginFrame() antes de glfwPollEvents/leer la entrada y
+ *          endFrame() en lugar de glfwSwapBuffers. El contexto de la ventana debe
+ *          ser el actual.
+ */
+class FramePacer
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    /// Cantidad de intervalos recientes que se usan para las estadísticas
+    static constexpr size_t WINDOW = 120;
+
+    explicit FramePacer(GLFWwindow* window, const FramePacingOptions& options = FramePacingOptions())
+        : window(window), options(options), fence(0), swaps(0), fenceWaitTotal(0.0), fenceWaits(0)
+    {
+        setVsync(options.vsync);
+        lastSwap = Clock::now();
+        deadline = lastSwap;
+    }
+
+    ~FramePacer()
+    {
+        // tras glfwTerminate no hay contexto y el fence ya no existe
+        if (fence && glfwGetCurrentContext())
+            glDeleteSync(fence);
+    }
+
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    /**
+     * @brief Cambia el modo de vsync
+     * @return El modo aplicado (Adaptive cae a On si el driver no lo soporta)
+     */
+    VsyncMode setVsync(VsyncMode mode)
+    {
+        if (mode == VsyncMode::Adaptive && !glfwExtensionSupported("WGL_EXT_swap_control_tear")
+            && !glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+        {
+            std::cout << "WARNING::FRAME_PACING::ADAPTIVE_VSYNC_NOT_SUPPORTED (usando vsync)" << std::endl;
+            mode = VsyncMode::On;
+        }
+        glfwSwapInterval(mode == VsyncMode::Off ? 0 : (mode == VsyncMode::On ? 1 : -1));
+        options.vsync = mode;
+        return mode;
+    }
+
+    /// Límite de FPS; 0 lo quita
+    void setTargetFps(double fps)
+    {
+        options.targetFps = std::max(0.0, fps);
+        deadline = Clock::now();
+    }
+
+    void setLowLatency(bool enabled)
+    {
+        options.lowLatency = enabled;
+        if (!enabled && fence)
+        {
+            glDeleteSync(fence);
+            fence = 0;
+        }
+    }
+
+    const FramePacingOptions& settings() const { return options; }
+
+    /**
+     * @brief Inicio del frame: en baja latencia espera a que la GPU termine el anterior
+     */
+    void beginFrame()
+    {
+        if (!fence)
+            return;
+        Clock::time_point start = Clock::now();
+        // hasta 100 ms: si la GPU se colgó, mejor seguir que bloquear la ventana
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);
+        glDeleteSync(fence);
+        fence = 0;
+        fenceWaitTotal += std::chrono::duration<double>(Clock::now() - start).count();
+        fenceWaits++;
+    }
+
+    /**
+     * @brief Fin del frame: respeta el límite de FPS, presenta y mide el intervalo
+     */
+    void endFrame()
+    {
+        if (options.targetFps > 0.0)
+            waitForDeadline();
+        glfwSwapBuffers(window);
+        if (options.lowLatency)
+        {
+            if (fence)
+                glDeleteSync(fence);
+            fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+
+        Clock::time_point now = Clock::now();
+        double interval = std::chrono::duration<double>(now - lastSwap).count();
+        lastSwap = now;
+        if (swaps++ > 0)
+        {
+            if (intervals.size() < WINDOW)
+                intervals.push_back(interval);
+            else
+                intervals[(swaps - 2) % WINDOW] = interval;
+        }
+    }
+
+    /// Intervalo medido entre swaps sobre los últimos WINDOW frames
+    FramePacingStats statistics() const
+    {
+        FramePacingStats stats;
+        stats.frames = swaps;
+        stats.fenceWait = fenceWaits ? fenceWaitTotal / fenceWaits : 0.0;
+        if (intervals.empty())
+            return stats;
+        double sum = 0.0;
+        stats.minimum = intervals[0];
+        stats.maximum = intervals[0];
+        for (double interval : intervals)
+        {
+            sum += interval;
+            stats.minimum = std::min(stats.minimum, interval);
+            stats.maximum = std::max(stats.maximum, interval);
+        }
+        stats.average = sum / intervals.size();
+        double squares = 0.0;
+        for (double interval : intervals)
+            squares += (interval - stats.average) * (interval - stats.average);
+        stats.deviation = std::sqrt(squares / intervals.size());
+        return stats;
+    }
+
+    /// Resumen de una línea para consola o título de ventana
+    void printStatistics(std::ostream& out) const
+    {
+        FramePacingStats stats = statistics();
+        out << "Frames: " << stats.frames << ", intervalo medio " << stats.average * 1000.0 << " ms ("
+            << stats.fps() << " FPS), min " << stats.minimum * 1000.0 << " ms, max " << stats.maximum * 1000.0
+            << " ms, desvio " << stats.deviation * 1000.0 << " ms";
+        if (options.lowLatency)
+            out << ", espera de fence " << stats.fenceWait * 1000.0 << " ms";
+        out << std::endl;
+    }
+
+private:
+    GLFWwindow* window;
+    FramePacingOptions options;
+    GLsync fence;
+    Clock::time_point lastSwap;
+    Clock::time_point deadline; ///< Momento del próximo swap con límite de FPS
+    size_t swaps;
+    std::vector<double> intervals; ///< Ventana circular de intervalos
+    double fenceWaitTotal;
+    size_t fenceWaits;
+
+    /// Duerme hasta cerca del plazo y espera activamente el resto
+    void waitForDeadline()
+    {
+        Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / options.targetFps));
+        Clock::time_point now = Clock::now();
+        deadline += period;
+        // si el frame llegó muy tarde no se intenta recuperar el atraso
+        if (deadline < now - period)
+            deadline = now;
+        Clock::duration spin = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(options.spinSeconds));
+        if (deadline - now > spin)
+            std::this_thread::sleep_for(deadline - now - spin);
+        while (Clock::now() < deadline)
+            std::this_thread::yield();
+    }
+};
+
+#endif
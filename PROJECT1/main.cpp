@@ -9,6 +9,9 @@
 #include "glad/glad.h"  // Cargador de funciones OpenGL (debe incluirse antes que GLFW)
 #include <GLFW/glfw3.h> // Biblioteca para manejo de ventanas y entrada de dispositivos
 #include <iostream>     // Para salida de consola (debugging y mensajes de error)
+#include "shader_preprocessor.h" // Permutaciones de shaders desde una sola fuente
+#include "frame_pacing.h"       // vsync, límite de FPS y baja latencia
+#include "scene_buffer.h"       // VBO de la escena con subida incremental
 
 using namespace std;    // Usar el espacio de nombres estándar para simplificar código
 
@@ -46,15 +49,13 @@ typedef float VertexArray[27];
 /**
  * @struct Figure
  * @brief Estructura que representa una figura geométrica renderizable
- * @details Contiene los datos de vértices y los objetos OpenGL necesarios para el renderizado
+ * @details Contiene los datos de vértices; en GPU viven en el SceneVertexBuffer
+ *          compartido, que se actualiza solo cuando la figura cambia
  */
 typedef struct {
     VertexArray figureVertex;   ///< Array con las coordenadas de los vértices (3 vértices x 3 coordenadas)
-    unsigned int VBO;           ///< Vertex Buffer Object (almacena datos en memoria de GPU)
-    unsigned int vertexShader;  ///< ID del vertex shader compilado
-    unsigned int fragmentShader;///< ID del fragment shader compilado
-    unsigned int VAO;
-    const char* fragmentShaderSource;
+    const char* shaderPermutation; ///< Nombre de la permutación de shader con la que se dibuja
+    bool dirty;                 ///< Vértices modificados desde la última subida
 } Figure;
 
 // Constantes de configuración
@@ -73,8 +74,24 @@ const char* vertexShaderSource = "#version 330 core\n"
     "   gl_Position = vec4(aPos.x, aPos.y, aPos.z, 1.0);\n"
     "}\0";
 
+/**
+ * @var fragmentShaderSource
+ * @brief Código fuente GLSL único del fragment shader
+ * @details Cada figura es una permutación que solo cambia FIGURE_COLOR; ver registerFigureShaders()
+ */
+const char* fragmentShaderSource = "#version 330 core\n"
+    "out vec4 FragColor;\n"
+    "#ifndef FIGURE_COLOR\n"
+    "#define FIGURE_COLOR vec4(1.0f, 1.0f, 1.0f, 1.0f)\n"
+    "#endif\n"
+    "void main()\n"
+    "{\n"
+    "   FragColor = FIGURE_COLOR;\n"
+    "}\0";
+
 
 SceneRenderer WindowSceneDisplay = 0;  ///< Índice de la escena actualmente activa (0-2)
+bool SceneChanged = true;              ///< La escena activa cambió desde el último frame
 
 // Prototipos de funciones
 /**
@@ -107,19 +124,18 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void keyCallbackListener(GLFWwindow *window, int key, int scanCode, int action, int mods);
 
 /**
- * @brief Crea y configura las figuras geométricas
+ * @brief Crea las figuras geométricas (solo datos, sin objetos OpenGL)
  * @return Puntero a arreglo de figuras o NULL en fallo de memoria
  * @note El llamante debe liberar la memoria con free()
  */
-Figure* getFiguresShapes(SceneRenderer figure, int coordFactor);
+Figure* getFiguresShapes();
 
 /**
- * @brief Configura y compila un shader OpenGL
- * @param shader ID del shader a configurar
- * @param source Primer carácter del código fuente del shader
- * @warning Versión simplificada - maneja solo primer carácter del source
+ * @brief Declara las permutaciones de shader de cada figura
+ * @param preprocessor Preprocesador donde se registran las fuentes en memoria
+ * @param cache Caché donde se declaran las permutaciones
  */
-void configureShader(unsigned int shader, const char* source);
+void registerFigureShaders(ShaderPreprocessor& preprocessor, ShaderPermutationCache& cache);
 
 /**
  * @var SCENE_BACKGROUND
@@ -160,31 +176,40 @@ int main(){
     // Configurar callback de teclado
     glfwSetKeyCallback(window, keyCallbackListener);
 
+    // Ritmo de frames: FRAME_VSYNC=off|on|adaptive, FRAME_FPS, FRAME_LOW_LATENCY
+    FramePacer framePacer(window, framePacingOptionsFromEnvironment());
+
+    // Shaders (fuera del loop): una permutación por figura, compiladas una sola vez.
+    // Las figuras con el mismo color comparten programa.
+    ShaderBuilder::enableParallelCompile();
+    ShaderPreprocessor shaderPreprocessor;
+    ShaderPermutationCache shaderCache(shaderPreprocessor);
+    registerFigureShaders(shaderPreprocessor, shaderCache);
+    shaderCache.prewarm();
+
+    // Figuras (una sola vez) y VBO compartido con capacidad para la mayor
+    Figure* figures = getFiguresShapes();
+    if (figures == NULL) {
+        glfwTerminate();
+        return -1;
+    }
+    SceneVertexBuffer sceneBuffer(sizeof(VertexArray) / sizeof(float));
+
     // Loop principal de renderizado
     while (!glfwWindowShouldClose(window)) {
-        // Configurar shaders (fuera del loop)
-        Figure* figure = getFiguresShapes(WindowSceneDisplay, WindowSceneDisplay  + 1);
-        configureShader(figure[WindowSceneDisplay].vertexShader, vertexShaderSource);
-        configureShader(figure[WindowSceneDisplay].fragmentShader, figure[WindowSceneDisplay].fragmentShaderSource);
-        
-        // Crear y linkear programa de shaders
-        unsigned int shaderProgram = glCreateProgram();
-        glAttachShader(shaderProgram, figure[WindowSceneDisplay].vertexShader);
-        glAttachShader(shaderProgram, figure[WindowSceneDisplay].fragmentShader);
-        glLinkProgram(shaderProgram);
-        
-        // Verificar errores de linking
-        int success;
-        char infoLog[512];
-        glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-        if(!success) {
-            glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-            std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+        // en baja latencia espera a la GPU antes de leer la entrada
+        framePacer.beginFrame();
+        glfwPollEvents();
+
+        // Solo se sube lo que difiere de lo que ya está en el VBO; un frame sin
+        // cambios no sube nada
+        Figure& figure = figures[WindowSceneDisplay];
+        if (SceneChanged || figure.dirty) {
+            sceneBuffer.write(0, figure.figureVertex, 3 * 3 * (WindowSceneDisplay + 1));
+            figure.dirty = false;
+            SceneChanged = false;
         }
-        
-        // Eliminar los shaders (ya están linkeados)
-        glDeleteShader(figure[WindowSceneDisplay].vertexShader);
-        glDeleteShader(figure[WindowSceneDisplay].fragmentShader);
+        sceneBuffer.flush();
 
         // Limpiar pantalla
         glClearColor(
@@ -196,20 +221,18 @@ int main(){
         glClear(GL_COLOR_BUFFER_BIT);
 
         // Dibujar el triángulo
-        glUseProgram(shaderProgram);
-        glBindVertexArray(figure[WindowSceneDisplay].VAO);
+        glUseProgram(shaderCache.program(figure.shaderPermutation));
+        glBindVertexArray(sceneBuffer.vertexArray());
         glDrawArrays(GL_TRIANGLES, 0, 3 * (WindowSceneDisplay + 1));
         
-        // Intercambiar buffers y procesar eventos
-        glfwSwapBuffers(window);
-        glfwPollEvents();
-        glDeleteProgram(shaderProgram);
-        // Limpieza final
-        glDeleteVertexArrays(1, &figure[WindowSceneDisplay].VAO);
-        glDeleteBuffers(1, &figure[WindowSceneDisplay].VBO);
-        free(figure);
+        // Intercambiar buffers con el ritmo configurado
+        framePacer.endFrame();
     }
 
+    framePacer.printStatistics(cout);
+    cout << "Subidas de vertices: " << sceneBuffer.statistics().uploads << " ("
+         << sceneBuffer.statistics().bytesUploaded << " bytes)" << endl;
+    free(figures);
     glfwTerminate();
     return 0;
 }
@@ -295,11 +318,13 @@ void keyCallbackListener(GLFWwindow* window, int key, int scanCode, int action,
             case GLFW_KEY_LEFT:  // Tecla izquierda: escena anterior
                 if (WindowSceneDisplay > 0) {
                     WindowSceneDisplay--;
+                    SceneChanged = true;
                 } 
                 break;
             case GLFW_KEY_RIGHT: // Tecla derecha: siguiente escena
                 if (WindowSceneDisplay < 2) {
                     WindowSceneDisplay++;
+                    SceneChanged = true;
                 } 
                 break;
             case GLFW_KEY_ESCAPE: // Tecla ESC: cerrar ventana
@@ -311,11 +336,11 @@ void keyCallbackListener(GLFWwindow* window, int key, int scanCode, int action,
 }
 
 /**
- * @brief Crea y configura las figuras geométricas
+ * @brief Crea las figuras geométricas de las 3 escenas
  * @return Puntero a arreglo de figuras o NULL en error
- * @note Actualmente solo inicializa un triángulo pero reserva espacio para 3 figuras
+ * @note Se llama una vez; las figuras nacen marcadas como sucias
  */
-Figure* getFiguresShapes(SceneRenderer figure, int coordFactor) {
+Figure* getFiguresShapes() {
     Figure* figures = (Figure*)malloc(sizeof(Figure)*3);
     if (figures == NULL) {
         cout << "Error de asignación de memoria" << endl;
@@ -329,14 +354,8 @@ Figure* getFiguresShapes(SceneRenderer figure, int coordFactor) {
             0.5f, -0.5f, 0.0f,   // Vértice inferior derecho
             0.0f, 0.5f, 0.0f     // Vértice superior central
         },
-        .vertexShader = glCreateShader(GL_VERTEX_SHADER),
-        .fragmentShader = glCreateShader(GL_FRAGMENT_SHADER),
-        .fragmentShaderSource = "#version 330 core\n"
-                                "out vec4 FragColor;\n"
-                                "void main()\n"
-                                "{\n"
-                                "   FragColor = vec4(1.0f, 0.5f, 0.2f, 1.0f);\n"
-                                "}\0"
+        .shaderPermutation = "triangle",
+        .dirty = true
     };
 
 
@@ -352,14 +371,8 @@ Figure* getFiguresShapes(SceneRenderer figure, int coordFactor) {
             -0.5f, -0.5f, 0.0f,  // bottom left
             -0.5f,  0.5f, 0.0f   // top left
         },
-        .vertexShader = glCreateShader(GL_VERTEX_SHADER),
-        .fragmentShader = glCreateShader(GL_FRAGMENT_SHADER),
-        .fragmentShaderSource = "#version 330 core\n"
-                                "out vec4 FragColor;\n"
-                                "void main()\n"
-                                "{\n"
-                                "   FragColor = vec4(0.0f, 0.0f, 0.98f, 1.0f);\n"
-                                "}\0"
+        .shaderPermutation = "rectangle",
+        .dirty = true
     };
 
 
@@ -378,63 +391,26 @@ Figure* getFiguresShapes(SceneRenderer figure, int coordFactor) {
             -0.3f, 0.2f, 0.0f, // bottom left
             0.3f, 0.2f, 0.0f, // bottom right       
         },
-        .vertexShader = glCreateShader(GL_VERTEX_SHADER),
-        .fragmentShader = glCreateShader(GL_FRAGMENT_SHADER),
-        .fragmentShaderSource = "#version 330 core\n"
-                                "out vec4 FragColor;\n"
-                                "void main()\n"
-                                "{\n"
-                                "   FragColor = vec4(0.0f, 0.0f, 0.98f, 1.0f);\n"
-                                "}\0"
+        .shaderPermutation = "house",
+        .dirty = true
     };
     
-    
-    figures[0].VBO = 0;
-    figures[0].VAO = 0;
-
-    figures[1].VBO = 0;
-    figures[1].VAO = 0;
-
-    figures[2].VBO = 0;
-    figures[2].VAO = 0;
-
-    // Generar y configurar VAO y VBO
-    glGenVertexArrays(1, &figures[figure].VAO);
-    glGenBuffers(1, &figures[figure].VBO);
-    
-    // Bind VAO primero
-    glBindVertexArray(figures[figure].VAO);
-    
-    // Luego bind y configura el VBO
-    glBindBuffer(GL_ARRAY_BUFFER, figures[figure].VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(figures[figure].figureVertex), figures[figure].figureVertex, GL_STATIC_DRAW);
-    
-    // Configurar atributos de vértice
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    // Desbindear VBO y VAO (VBO primero)
-    glBindBuffer(GL_ARRAY_BUFFER, 0); 
-    glBindVertexArray(0);
 
     return figures;
 }
 
 /**
- * @brief Configura y compila un shader OpenGL
- * @param shader ID del shader a configurar
- * @param source Primer carácter del código fuente
- * @warning Implementación simplificada - solo usa primer carácter del source
- * @note En una implementación real debería manejar strings completos y verificar errores
+ * @brief Declara las permutaciones de shader de cada figura
+ * @param preprocessor Preprocesador donde se registran las fuentes en memoria
+ * @param cache Caché donde se declaran las permutaciones
+ * @details Todas salen de fragmentShaderSource cambiando solo FIGURE_COLOR.
+ *          "rectangle" y "house" generan el mismo código y comparten un programa.
  */
-void configureShader(unsigned int shader, const char* source) {
-    glShaderSource(shader, 1, &source, NULL);
-    glCompileShader(shader);
-
-    int success;
-    char shaderInfoLog[521];
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        cout << "ERROR::SHADER::COMPILATION_FAIL" << shaderInfoLog << endl;
-    }
-}
\ No newline at end of file
+void registerFigureShaders(ShaderPreprocessor& preprocessor, ShaderPermutationCache& cache) {
+    preprocessor.addVirtualFile("figure.vs", vertexShaderSource);
+    preprocessor.addVirtualFile("figure.fs", fragmentShaderSource);
+
+    cache.define("triangle", "figure.vs", "figure.fs", {{"FIGURE_COLOR", "vec4(1.0f, 0.5f, 0.2f, 1.0f)"}});
+    cache.define("rectangle", "figure.vs", "figure.fs", {{"FIGURE_COLOR", "vec4(0.0f, 0.0f, 0.98f, 1.0f)"}});
+    cache.define("house", "figure.vs", "figure.fs", {{"FIGURE_COLOR", "vec4(0.0f, 0.0f, 0.98f, 1.0f)"}});
+}
@@ -0,0 +1,301 @@
+/**
+ * @file shader_async.h
+ * @brief Compilación asíncrona de programas de shaders
+ * @details Emite la compilación y el enlazado de muchos programas por adelantado
+ *          sin consultar su estado, de modo que el driver pueda trabajar en paralelo
+ *          (GL_KHR_parallel_shader_compile / GL_ARB_parallel_shader_compile).
+ *          Cada programa se representa con un ShaderFuture: solo el primer uso
+ *          bloquea, y el arranque queda acotado por el shader más lento en lugar
+ *          de por la suma de todos.
+ */
+#ifndef SHADER_ASYNC_H
+#define SHADER_ASYNC_H
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+/**
+ * @brief Verifica errores de compilación/enlazado de un shader o programa
+ * @param shader ID del shader (o del programa si type == "PROGRAM")
+ * @param type Tipo de shader: "VERTEX", "FRAGMENT" o "PROGRAM"
+ * @return true si la compilación/enlazado fue correcta
+ */
+inline bool checkShaderErrors(unsigned int shader, const std::string& type)
+{
+    int success;
+    char infoLog[1024];
+    if (type != "PROGRAM")
+    {
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            glGetShaderInfoLog(shader, 1024, NULL, infoLog);
+            std::cout << "ERROR::SHADER::ERROR_DE_COMPILACION de tipo: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+        }
+    }
+    else
+    {
+        glGetProgramiv(shader, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            glGetProgramInfoLog(shader, 1024, NULL, infoLog);
+            std::cout << "ERROR::SHADER::ERROR_DE_ENLACE de tipo: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+        }
+    }
+    return success != 0;
+}
+
+/**
+ * @brief Lee el contenido completo de un archivo de shader
+ * @param path Ruta del archivo
+ * @return Código fuente, o cadena vacía si no se pudo leer
+ */
+inline std::string readShaderFile(const char* path)
+{
+    std::ifstream shaderFile;
+    // configurar ifstream para que lance excepciones:
+    shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    try
+    {
+        shaderFile.open(path);
+        std::stringstream shaderStream;
+        shaderStream << shaderFile.rdbuf();
+        shaderFile.close();
+        return shaderStream.str();
+    }
+    catch (std::ifstream::failure& e)
+    {
+        std::cout << "ERROR::SHADER::ARCHIVO_NO_LEIDO_CORRECTAMENTE: " << path << " " << e.what() << std::endl;
+    }
+    return std::string();
+}
+
+/**
+ * @class ShaderFuture
+ * @brief Handle a un programa cuya compilación/enlazado puede estar en curso
+ * @details El ID del programa es válido desde la creación; lo que se difiere es la
+ *          verificación de errores y la liberación de los shaders intermedios.
+ *          No es copiable: es dueño de los shaders hasta que se resuelve.
+ */
+class ShaderFuture
+{
+public:
+    ShaderFuture() : program(0), vertex(0), fragment(0), resolved(true), linked(false) {}
+
+    ShaderFuture(ShaderFuture&& other) noexcept
+        : program(other.program), vertex(other.vertex), fragment(other.fragment),
+          resolved(other.resolved), linked(other.linked)
+    {
+        other.program = other.vertex = other.fragment = 0;
+        other.resolved = true;
+    }
+
+    ShaderFuture& operator=(ShaderFuture&& other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            program = other.program;
+            vertex = other.vertex;
+            fragment = other.fragment;
+            resolved = other.resolved;
+            linked = other.linked;
+            other.program = other.vertex = other.fragment = 0;
+            other.resolved = true;
+        }
+        return *this;
+    }
+
+    ShaderFuture(const ShaderFuture&) = delete;
+    ShaderFuture& operator=(const ShaderFuture&) = delete;
+
+    ~ShaderFuture() { release(); }
+
+    /// ID del programa (válido inmediatamente, aunque usarlo puede bloquear)
+    unsigned int id() const { return program; }
+
+    /// true si el handle apunta a un programa
+    bool valid() const { return program != 0; }
+
+    /**
+     * @brief Consulta sin bloquear si el driver terminó de compilar y enlazar
+     * @details Sin la extensión de compilación paralela no hay forma de preguntar
+     *          sin bloquear, así que se reporta como listo.
+     */
+    bool isReady() const
+    {
+        if (resolved || !parallelCompileSupported())
+            return true;
+        int done = GL_FALSE;
+        glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &done);
+        return done == GL_TRUE;
+    }
+
+    /**
+     * @brief Bloquea hasta que el programa esté enlazado y reporta errores
+     * @return ID del programa (también si el enlazado falló)
+     */
+    unsigned int get()
+    {
+        if (!resolved)
+        {
+            // Solo ahora se consulta el estado: esto fuerza al driver a terminar
+            bool vertexOk = checkShaderErrors(vertex, "VERTEX");
+            bool fragmentOk = checkShaderErrors(fragment, "FRAGMENT");
+            linked = checkShaderErrors(program, "PROGRAM") && vertexOk && fragmentOk;
+            // eliminar los shaders, ya están vinculados al programa y no son necesarios
+            glDeleteShader(vertex);
+            glDeleteShader(fragment);
+            vertex = fragment = 0;
+            resolved = true;
+        }
+        return program;
+    }
+
+    /// true si ya se resolvió y el enlazado fue correcto
+    bool succeeded() const { return resolved && linked; }
+
+    /**
+     * @brief Resuelve el programa y lo cede al llamante
+     * @details Bloquea como get() hasta que termine el enlazado, para que los
+     *          shaders intermedios se liberen aquí. Tras esto el future queda
+     *          vacío; útil para descartar un build fallido o transferir el ID a
+     *          otro dueño.
+     */
+    unsigned int detach()
+    {
+        get();
+        unsigned int id = program;
+        program = 0;
+        return id;
+    }
+
+    /// true si el contexto actual soporta consultar GL_COMPLETION_STATUS_KHR
+    static bool parallelCompileSupported()
+    {
+        return GLAD_GL_KHR_parallel_shader_compile || GLAD_GL_ARB_parallel_shader_compile;
+    }
+
+private:
+    friend class ShaderBuilder;
+
+    unsigned int program;
+    unsigned int vertex;
+    unsigned int fragment;
+    bool resolved;
+    bool linked;
+
+    void release()
+    {
+        if (!resolved)
+        {
+            if (vertex) glDeleteShader(vertex);
+            if (fragment) glDeleteShader(fragment);
+            if (program) glDeleteProgram(program);
+        }
+        vertex = fragment = program = 0;
+        resolved = true;
+    }
+};
+
+/**
+ * @struct ShaderSourcePair
+ * @brief Código fuente de vertex y fragment shader de un programa
+ */
+struct ShaderSourcePair
+{
+    std::string vertex;   ///< Código GLSL del vertex shader
+    std::string fragment; ///< Código GLSL del fragment shader
+};
+
+/**
+ * @class ShaderBuilder
+ * @brief Emite compilaciones y enlazados sin esperar resultados
+ */
+class ShaderBuilder
+{
+public:
+    /**
+     * @brief Pide al driver que use hilos de compilación en segundo plano
+     * @param threads Número máximo de hilos (0xFFFFFFFF = lo que decida el driver)
+     * @details Debe llamarse una vez, con el contexto ya creado y GLAD cargado.
+     */
+    static void enableParallelCompile(unsigned int threads = 0xFFFFFFFFu)
+    {
+        if (GLAD_GL_KHR_parallel_shader_compile)
+            glMaxShaderCompilerThreadsKHR(threads);
+        else if (GLAD_GL_ARB_parallel_shader_compile)
+            glMaxShaderCompilerThreadsARB(threads);
+    }
+
+    /**
+     * @brief Emite compilación y enlazado de un programa
+     * @return Future del programa; no consulta estados, así que no bloquea
+     */
+    static ShaderFuture compile(const std::string& vertexCode, const std::string& fragmentCode)
+    {
+        const char* vShaderCode = vertexCode.c_str();
+        const char* fShaderCode = fragmentCode.c_str();
+
+        ShaderFuture future;
+        future.vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(future.vertex, 1, &vShaderCode, NULL);
+        glCompileShader(future.vertex);
+
+        future.fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(future.fragment, 1, &fShaderCode, NULL);
+        glCompileShader(future.fragment);
+
+        future.program = glCreateProgram();
+        glAttachShader(future.program, future.vertex);
+        glAttachShader(future.program, future.fragment);
+        glLinkProgram(future.program);
+        future.resolved = false;
+        return future;
+    }
+
+    /**
+     * @brief Lee los archivos y emite la compilación del programa
+     */
+    static ShaderFuture compileFiles(const char* vertexPath, const char* fragmentPath)
+    {
+        return compile(readShaderFile(vertexPath), readShaderFile(fragmentPath));
+    }
+
+    /**
+     * @brief Emite todos los programas de un lote antes de esperar a ninguno
+     * @details Primero se compilan todos los shaders y luego se enlazan todos los
+     *          programas, para que las colas del driver estén llenas desde el inicio.
+     */
+    static std::vector<ShaderFuture> compileAll(const std::vector<ShaderSourcePair>& sources)
+    {
+        std::vector<ShaderFuture> futures(sources.size());
+        for (size_t i = 0; i < sources.size(); i++)
+        {
+            const char* vShaderCode = sources[i].vertex.c_str();
+            const char* fShaderCode = sources[i].fragment.c_str();
+            futures[i].vertex = glCreateShader(GL_VERTEX_SHADER);
+            glShaderSource(futures[i].vertex, 1, &vShaderCode, NULL);
+            glCompileShader(futures[i].vertex);
+            futures[i].fragment = glCreateShader(GL_FRAGMENT_SHADER);
+            glShaderSource(futures[i].fragment, 1, &fShaderCode, NULL);
+            glCompileShader(futures[i].fragment);
+            futures[i].resolved = false;
+        }
+        for (ShaderFuture& future : futures)
+        {
+            future.program = glCreateProgram();
+            glAttachShader(future.program, future.vertex);
+            glAttachShader(future.program, future.fragment);
+            glLinkProgram(future.program);
+        }
+        return futures;
+    }
+};
+
+#endif
@@ -0,0 +1,434 @@
+/**
+ * @file shader_preprocessor.h
+ * @brief Preprocesador de shaders con #include, #define inyectados y permutaciones
+ * @details GLSL no tiene #include, así que se resuelve aquí antes de compilar.
+ *          Las permutaciones (p.ej. con/sin textura, color por vértice/uniforme)
+ *          se generan desde una sola fuente inyectando #define después de #version,
+ *          se deduplican por hash del código resultante y se compilan de forma
+ *          perezosa o se precalientan con prewarm().
+ */
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "shader_async.h"
+
+/**
+ * @struct ShaderDefine
+ * @brief Macro que se inyecta en el código del shader (#define name value)
+ */
+struct ShaderDefine
+{
+    std::string name;  ///< Nombre de la macro
+    std::string value; ///< Valor (puede estar vacío)
+};
+
+/**
+ * @struct PreprocessedShader
+ * @brief Resultado de preprocesar un shader
+ */
+struct PreprocessedShader
+{
+    std::string code;                      ///< Código GLSL listo para glShaderSource
+    std::vector<std::string> dependencies; ///< Archivos leídos (fuente + includes), para recarga
+    bool ok = true;                        ///< false si algún #include no se pudo resolver
+};
+
+/**
+ * @brief Hash FNV-1a de 64 bits
+ * @param data Bytes a mezclar
+ * @param size Cantidad de bytes
+ * @param seed Valor inicial (permite encadenar varios bloques)
+ */
+inline uint64_t fnv1a64(const void* data, size_t size, uint64_t seed = 14695981039346656037ull)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * @class ShaderPreprocessor
+ * @brief Resuelve #include e inyecta #define en código GLSL
+ * @details Los includes se buscan, en orden: junto al archivo que incluye, en los
+ *          directorios registrados y entre los archivos virtuales (código en memoria).
+ *          Cada archivo se incluye una sola vez por shader, lo que también corta ciclos.
+ */
+class ShaderPreprocessor
+{
+public:
+    /// Agrega un directorio donde buscar los #include
+    void addIncludeDirectory(const std::string& directory)
+    {
+        includeDirectories.push_back(directory);
+    }
+
+    /// Registra código en memoria que puede incluirse o usarse como fuente por nombre
+    void addVirtualFile(const std::string& name, const std::string& code)
+    {
+        virtualFiles[name] = code;
+    }
+
+    /**
+     * @brief Preprocesa un archivo (o archivo virtual) de shader
+     * @param path Ruta o nombre virtual
+     * @param defines Macros a inyectar tras la línea #version
+     */
+    PreprocessedShader processFile(const std::string& path, const std::vector<ShaderDefine>& defines = {}) const
+    {
+        PreprocessedShader result;
+        std::string resolved;
+        std::string source;
+        if (!load(path, "", resolved, source))
+        {
+            std::cout << "ERROR::SHADER::ARCHIVO_NO_LEIDO_CORRECTAMENTE: " << path << std::endl;
+            result.ok = false;
+            return result;
+        }
+        return process(source, resolved, defines);
+    }
+
+    /**
+     * @brief Preprocesa código ya cargado
+     * @param source Código GLSL
+     * @param sourceName Nombre para resolver includes relativos y mensajes de error
+     * @param defines Macros a inyectar tras la línea #version
+     */
+    PreprocessedShader process(const std::string& source, const std::string& sourceName,
+                               const std::vector<ShaderDefine>& defines = {}) const
+    {
+        PreprocessedShader result;
+        std::set<std::string> included;
+        included.insert(sourceName);
+        result.dependencies.push_back(sourceName);
+
+        // los #define van justo después de #version (que puede ir tras comentarios);
+        // si no hay #version, al principio
+        bool hasVersion = false;
+        {
+            std::istringstream scan(source);
+            std::string line;
+            while (!hasVersion && std::getline(scan, line))
+                hasVersion = isDirective(line, "version");
+        }
+
+        std::ostringstream out;
+        if (!hasVersion)
+        {
+            writeDefines(out, defines);
+            out << "#line 1 0\n";
+        }
+        std::istringstream in(source);
+        std::string line;
+        int lineNumber = 0;
+        bool versionSeen = false;
+        while (std::getline(in, line))
+        {
+            lineNumber++;
+            if (!versionSeen && isDirective(line, "version"))
+            {
+                versionSeen = true;
+                out << line << "\n";
+                writeDefines(out, defines);
+                out << "#line " << lineNumber + 1 << " 0\n";
+                continue;
+            }
+            if (isDirective(line, "include"))
+            {
+                expandInclude(line, sourceName, included, result, out, 1);
+                out << "#line " << lineNumber + 1 << " 0\n";
+                continue;
+            }
+            out << line << "\n";
+        }
+        result.code = out.str();
+        return result;
+    }
+
+private:
+    std::vector<std::string> includeDirectories;
+    std::map<std::string, std::string> virtualFiles;
+
+    /// true si la línea es la directiva indicada ("#  include ...")
+    static bool isDirective(const std::string& line, const char* name)
+    {
+        size_t pos = line.find_first_not_of(" \t");
+        if (pos == std::string::npos || line[pos] != '#')
+            return false;
+        pos = line.find_first_not_of(" \t", pos + 1);
+        if (pos == std::string::npos)
+            return false;
+        return line.compare(pos, std::string(name).size(), name) == 0;
+    }
+
+    static void writeDefines(std::ostringstream& out, const std::vector<ShaderDefine>& defines)
+    {
+        for (const ShaderDefine& define : defines)
+            out << "#define " << define.name << (define.value.empty() ? "" : " ") << define.value << "\n";
+    }
+
+    static bool readFile(const std::string& path, std::string& code)
+    {
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        if (!file)
+            return false;
+        std::stringstream stream;
+        stream << file.rdbuf();
+        code = stream.str();
+        return true;
+    }
+
+    /**
+     * @brief Busca un archivo por nombre y carga su contenido
+     * @param name Nombre tal como aparece en el #include
+     * @param includer Archivo que lo incluye ("" si es la fuente principal)
+     * @param resolved Nombre canónico encontrado
+     */
+    bool load(const std::string& name, const std::string& includer, std::string& resolved, std::string& code) const
+    {
+        std::vector<std::string> candidates;
+        if (!includer.empty())
+            candidates.push_back((std::filesystem::path(includer).parent_path() / name).lexically_normal().string());
+        else
+            candidates.push_back(std::filesystem::path(name).lexically_normal().string());
+        for (const std::string& directory : includeDirectories)
+            candidates.push_back((std::filesystem::path(directory) / name).lexically_normal().string());
+
+        for (const std::string& candidate : candidates)
+        {
+            if (readFile(candidate, code))
+            {
+                resolved = candidate;
+                return true;
+            }
+        }
+        std::map<std::string, std::string>::const_iterator found = virtualFiles.find(name);
+        if (found != virtualFiles.end())
+        {
+            resolved = name;
+            code = found->second;
+            return true;
+        }
+        return false;
+    }
+
+    void expandInclude(const std::string& line, const std::string& includer, std::set<std::string>& included,
+                       PreprocessedShader& result, std::ostringstream& out, int depth) const
+    {
+        size_t open = line.find_first_of("\"<");
+        size_t close = open == std::string::npos ? open : line.find_first_of("\">", open + 1);
+        if (close == std::string::npos)
+        {
+            std::cout << "ERROR::SHADER::INCLUDE_MAL_FORMADO en " << includer << ": " << line << std::endl;
+            result.ok = false;
+            return;
+        }
+        std::string name = line.substr(open + 1, close - open - 1);
+        std::string resolved;
+        std::string code;
+        if (!load(name, includer, resolved, code))
+        {
+            std::cout << "ERROR::SHADER::INCLUDE_NO_ENCONTRADO: " << name << " (desde " << includer << ")" << std::endl;
+            result.ok = false;
+            return;
+        }
+        if (!included.insert(resolved).second)
+            return;
+        if (depth > 32)
+        {
+            std::cout << "ERROR::SHADER::INCLUDE_DEMASIADO_PROFUNDO: " << resolved << std::endl;
+            result.ok = false;
+            return;
+        }
+        result.dependencies.push_back(resolved);
+
+        int sourceIndex = static_cast<int>(result.dependencies.size()) - 1;
+        out << "#line 1 " << sourceIndex << "\n";
+        std::istringstream in(code);
+        std::string includedLine;
+        int lineNumber = 0;
+        while (std::getline(in, includedLine))
+        {
+            lineNumber++;
+            if (isDirective(includedLine, "version"))
+            {
+                // un include no puede redefinir la versión; se deja como línea vacía
+                out << "\n";
+                continue;
+            }
+            if (isDirective(includedLine, "include"))
+            {
+                expandInclude(includedLine, resolved, included, result, out, depth + 1);
+                out << "#line " << lineNumber + 1 << " " << sourceIndex << "\n";
+                continue;
+            }
+            out << includedLine << "\n";
+        }
+    }
+};
+
+/**
+ * @brief Preprocesa y emite la compilación de un par de archivos de shader
+ * @return Future del programa (ver ShaderBuilder::compile)
+ */
+inline ShaderFuture compileShaderFiles(const ShaderPreprocessor& preprocessor, const char* vertexPath,
+                                       const char* fragmentPath, const std::vector<ShaderDefine>& defines = {})
+{
+    PreprocessedShader vertex = preprocessor.processFile(vertexPath, defines);
+    PreprocessedShader fragment = preprocessor.processFile(fragmentPath, defines);
+    return ShaderBuilder::compile(vertex.code, fragment.code);
+}
+
+/**
+ * @brief Preprocesador compartido por Shader y la recarga en caliente
+ */
+inline ShaderPreprocessor& defaultShaderPreprocessor()
+{
+    static ShaderPreprocessor preprocessor;
+    return preprocessor;
+}
+
+/**
+ * @class ShaderPermutationCache
+ * @brief Permutaciones con nombre de un mismo par de fuentes
+ * @details Dos permutaciones cuyo código preprocesado coincide comparten el mismo
+ *          programa. Nada se compila hasta que se pide program() o prewarm().
+ */
+class ShaderPermutationCache
+{
+public:
+    explicit ShaderPermutationCache(const ShaderPreprocessor& preprocessor) : preprocessor(preprocessor) {}
+
+    ~ShaderPermutationCache()
+    {
+        for (std::unique_ptr<CompiledProgram>& compiled : programs)
+        {
+            if (compiled->build.valid())
+                glDeleteProgram(compiled->build.detach());
+        }
+    }
+
+    ShaderPermutationCache(const ShaderPermutationCache&) = delete;
+    ShaderPermutationCache& operator=(const ShaderPermutationCache&) = delete;
+
+    /**
+     * @brief Declara una permutación (no preprocesa ni compila todavía)
+     * @param name Nombre con el que se pedirá el programa
+     * @param vertexSource Archivo o nombre virtual del vertex shader
+     * @param fragmentSource Archivo o nombre virtual del fragment shader
+     * @param defines Macros que distinguen esta permutación
+     */
+    void define(const std::string& name, const std::string& vertexSource, const std::string& fragmentSource,
+                const std::vector<ShaderDefine>& defines = {})
+    {
+        Permutation permutation;
+        permutation.vertexSource = vertexSource;
+        permutation.fragmentSource = fragmentSource;
+        permutation.defines = defines;
+        permutations[name] = permutation;
+    }
+
+    /**
+     * @brief ID del programa de una permutación; la compila si hace falta
+     * @details Bloquea si el programa aún no terminó de compilar. Devuelve 0 si la
+     *          permutación no existe.
+     */
+    unsigned int program(const std::string& name)
+    {
+        CompiledProgram* compiled = resolve(name);
+        return compiled ? compiled->build.get() : 0;
+    }
+
+    /// true si la permutación ya está compilada (no bloquea)
+    bool isReady(const std::string& name)
+    {
+        std::unordered_map<std::string, Permutation>::iterator found = permutations.find(name);
+        return found != permutations.end() && found->second.compiled && found->second.compiled->build.isReady();
+    }
+
+    /**
+     * @brief Emite la compilación de todas las permutaciones declaradas sin esperar
+     * @details Usar al arrancar (o en una pantalla de carga) para que el primer uso
+     *          de cada variante no espere al compilador.
+     */
+    void prewarm()
+    {
+        for (std::unordered_map<std::string, Permutation>::value_type& entry : permutations)
+            resolve(entry.first);
+    }
+
+    /// Cantidad de programas distintos compilados (tras deduplicar)
+    size_t uniqueProgramCount() const { return programs.size(); }
+
+private:
+    struct CompiledProgram
+    {
+        uint64_t hash;
+        ShaderFuture build;
+    };
+
+    struct Permutation
+    {
+        std::string vertexSource;
+        std::string fragmentSource;
+        std::vector<ShaderDefine> defines;
+        CompiledProgram* compiled = nullptr;
+    };
+
+    const ShaderPreprocessor& preprocessor;
+    std::unordered_map<std::string, Permutation> permutations;
+    std::unordered_map<uint64_t, CompiledProgram*> programsByHash;
+    std::vector<std::unique_ptr<CompiledProgram>> programs;
+
+    CompiledProgram* resolve(const std::string& name)
+    {
+        std::unordered_map<std::string, Permutation>::iterator found = permutations.find(name);
+        if (found == permutations.end())
+        {
+            std::cout << "ERROR::SHADER::PERMUTACION_DESCONOCIDA: " << name << std::endl;
+            return nullptr;
+        }
+        Permutation& permutation = found->second;
+        if (permutation.compiled)
+            return permutation.compiled;
+
+        PreprocessedShader vertex = preprocessor.processFile(permutation.vertexSource, permutation.defines);
+        PreprocessedShader fragment = preprocessor.processFile(permutation.fragmentSource, permutation.defines);
+        // el separador evita que "ab"+"c" y "a"+"bc" colisionen
+        uint64_t hash = fnv1a64(vertex.code.data(), vertex.code.size());
+        hash = fnv1a64("\0", 1, hash);
+        hash = fnv1a64(fragment.code.data(), fragment.code.size(), hash);
+
+        std::unordered_map<uint64_t, CompiledProgram*>::iterator existing = programsByHash.find(hash);
+        if (existing != programsByHash.end())
+        {
+            permutation.compiled = existing->second;
+            return permutation.compiled;
+        }
+        std::unique_ptr<CompiledProgram> compiled(new CompiledProgram());
+        compiled->hash = hash;
+        compiled->build = ShaderBuilder::compile(vertex.code, fragment.code);
+        permutation.compiled = compiled.get();
+        programsByHash[hash] = compiled.get();
+        programs.push_back(std::move(compiled));
+        return permutation.compiled;
+    }
+};
+
+#endif
@@ -0,0 +1,147 @@
+/**
+ * @file game_loop.h
+ * @brief Simulación a paso fijo con acumulador e interpolación al dibujar
+ * @details La simulación avanza siempre en pasos de la misma duración, sin
+ *          importar a cuántos FPS se dibuje: cada frame suma al acumulador el
+ *          tiempo real transcurrido y ejecuta tantos pasos como quepan. Lo que
+ *          sobra (menos de un paso) es la fracción alpha entre el estado anterior y
+ *          el actual con la que se interpola lo que se dibuja, así que a 144 Hz la
+ *          animación es suave aunque la simulación corra a 60 Hz.
+ *
+ *          Para que un frame lento (arrastrar la ventana, un breakpoint) no
+ *          dispare una avalancha de pasos, cada frame ejecuta como mucho
+ *          maxStepsPerFrame; el tiempo que no entra se descarta y se informa.
+ *
+ *          simulate() corre pasos sin reloj ni ventana, tan rápido como se pueda:
+ *          para trabajos por lotes y pruebas deterministas.
+ *
+ *          State debe ser copiable y tener
+ *            static State interpolate(const State& a, const State& b, float alpha);
+ *          update recibe (State&, double dt) y avanza el estado un paso.
+ */
+#ifndef GAME_LOOP_H
+#define GAME_LOOP_H
+
+#include <algorithm>
+#include <chrono>
+
+/**
+ * @struct GameLoopStats
+ * @brief Contadores de la simulación
+ */
+struct GameLoopStats
+{
+    unsigned long long steps = 0; ///< Pasos ejecutados en total
+    int lastFrameSteps = 0;       ///< Pasos del último advance()
+    double droppedSeconds = 0.0;  ///< Tiempo real descartado por exceder maxStepsPerFrame
+};
+
+/**
+ * @class FixedTimestepLoop
+ * @brief Núcleo del bucle de juego: estado anterior y actual de paso fijo
+ */
+template <typename State>
+class FixedTimestepLoop
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * @param initial Estado inicial (anterior y actual)
+     * @param step Duración de un paso en segundos (1/60 por defecto)
+     * @param maxStepsPerFrame Pasos máximos por advance(); el resto se descarta
+     */
+    explicit FixedTimestepLoop(const State& initial, double step = 1.0 / 60.0, int maxStepsPerFrame = 8)
+        : previousState(initial), currentState(initial), step(step), maxSteps(std::max(1, maxStepsPerFrame)),
+          accumulator(0.0), time(0.0), started(false)
+    {
+    }
+
+    /**
+     * @brief Avanza según el reloj: mide el tiempo desde la llamada anterior
+     * @return Pasos ejecutados
+     */
+    template <typename Update>
+    int advance(Update update)
+    {
+        Clock::time_point now = Clock::now();
+        double elapsed = started ? std::chrono::duration<double>(now - lastAdvance).count() : 0.0;
+        lastAdvance = now;
+        started = true;
+        return advance(elapsed, update);
+    }
+
+    /**
+     * @brief Avanza un tiempo real dado (reloj propio, repeticiones, pruebas)
+     * @return Pasos ejecutados
+     */
+    template <typename Update>
+    int advance(double elapsed, Update update)
+    {
+        accumulator += std::max(0.0, elapsed);
+        int steps = 0;
+        while (accumulator >= step && steps < maxSteps)
+        {
+            runStep(update);
+            accumulator -= step;
+            steps++;
+        }
+        if (accumulator >= step)
+        {
+            // no se intenta recuperar: se queda lo que falta para el próximo paso
+            double kept = accumulator - step * (long long)(accumulator / step);
+            stats.droppedSeconds += accumulator - kept;
+            accumulator = kept;
+        }
+        stats.lastFrameSteps = steps;
+        return steps;
+    }
+
+    /**
+     * @brief Simula sin reloj, tan rápido como se pueda
+     * @param seconds Tiempo simulado; se redondea hacia abajo a pasos enteros
+     * @return Pasos ejecutados
+     */
+    template <typename Update>
+    unsigned long long simulate(double seconds, Update update)
+    {
+        unsigned long long steps = (unsigned long long)(std::max(0.0, seconds) / step + 1e-9);
+        for (unsigned long long i = 0; i < steps; i++)
+            runStep(update);
+        return steps;
+    }
+
+    /// Estado para dibujar: entre el anterior y el actual según alpha()
+    State interpolated() const { return State::interpolate(previousState, currentState, (float)alpha()); }
+
+    /// Fracción del paso en curso ya transcurrida (0-1)
+    double alpha() const { return accumulator / step; }
+
+    const State& previous() const { return previousState; }
+    const State& current() const { return currentState; }
+    double simulationTime() const { return time; }
+    double stepSeconds() const { return step; }
+    const GameLoopStats& statistics() const { return stats; }
+
+private:
+    State previousState;
+    State currentState;
+    double step;
+    int maxSteps;
+    double accumulator; ///< Tiempo real todavía no simulado
+    double time;        ///< Tiempo simulado
+    bool started;
+    Clock::time_point lastAdvance;
+    GameLoopStats stats;
+
+    template <typename Update>
+    void runStep(Update& update)
+    {
+        previousState = currentState;
+        update(currentState, step);
+        time += step;
+        stats.steps++;
+    }
+};
+
+#endif
@@ -9,7 +9,14 @@
 #include "glad/glad.h"  // Cargador de funciones OpenGL (debe incluirse antes que GLFW)
 #include <GLFW/glfw3.h> // Biblioteca para manejo de ventanas y entrada de dispositivos
 #include <iostream>     // Para salida de consola (debugging y mensajes de error)
+#include <chrono>       // Para medir la simulación sin ventana
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include "shader_s.h"
+#include "frame_pacing.h" // vsync, límite de FPS y baja latencia
+#include "game_loop.h"    // Simulación a paso fijo
+#include "scene_buffer.h" // VBO de la escena con subida incremental
 
 using namespace std;    // Usar el espacio de nombres estándar para simplificar código
 
@@ -47,22 +54,41 @@ typedef float VertexArray[60];
 /**
  * @struct Figure
  * @brief Estructura que representa una figura geométrica renderizable
- * @details Contiene los datos de vértices y los objetos OpenGL necesarios para el renderizado
+ * @details Contiene los datos de vértices; en GPU viven en el SceneVertexBuffer
+ *          compartido, que se actualiza solo cuando la figura cambia
  */
 typedef struct {
-    VertexArray figureVertex;   ///< Array con las coordenadas de los vértices (3 vértices x 3 coordenadas)
-    unsigned int VBO;           ///< Vertex Buffer Object (almacena datos en memoria de GPU)
-    unsigned int vertexShader;  ///< ID del vertex shader compilado
-    unsigned int fragmentShader;///< ID del fragment shader compilado
-    unsigned int VAO;
+    VertexArray figureVertex;   ///< Vértices intercalados: posición x,y,z y color r,g,b
+    bool dirty;                 ///< Vértices modificados desde la última subida
 } Figure;
 
+/**
+ * @struct ColorAnimation
+ * @brief Estado de la simulación: el color de la figura, que varía con el tiempo
+ * @details Avanza en pasos fijos (FixedTimestepLoop) y se interpola al dibujar,
+ *          así que el costo de simularlo no depende de los FPS.
+ */
+typedef struct ColorAnimation {
+    double time;    ///< Tiempo simulado en segundos
+    float color[3]; ///< RGB en rango 0-1
+
+    /// Mezcla lineal entre dos estados para dibujar entre pasos
+    static ColorAnimation interpolate(const ColorAnimation& a, const ColorAnimation& b, float alpha) {
+        ColorAnimation result = b;
+        result.time = a.time + (b.time - a.time) * alpha;
+        for (int i = 0; i < 3; i++)
+            result.color[i] = a.color[i] + (b.color[i] - a.color[i]) * alpha;
+        return result;
+    }
+} ColorAnimation;
+
 // Constantes de configuración
 const WindowSize HEIGH = 600;  ///< Altura inicial de la ventana en píxeles
 const WindowSize WIDTH = 800;  ///< Ancho inicial de la ventana en píxeles
 
 
 SceneRenderer WindowSceneDisplay = 0;  ///< Índice de la escena actualmente activa (0-2)
+bool SceneChanged = true;              ///< La escena activa cambió desde el último frame
 
 // Prototipos de funciones
 /**
@@ -95,13 +121,27 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void keyCallbackListener(GLFWwindow *window, int key, int scanCode, int action, int mods);
 
 /**
- * @brief Crea y configura las figuras geométricas
+ * @brief Crea las figuras geométricas (solo datos, sin objetos OpenGL)
  * @return Puntero a arreglo de figuras o NULL en fallo de memoria
  * @note El llamante debe liberar la memoria con free()
  */
-Figure* getFiguresShapes(SceneRenderer figure, int coordFactor);
+Figure* getFiguresShapes();
+
+void calculateFPS(GLFWwindow* window, const FramePacer& framePacer);
 
-void calculateFPS(GLFWwindow* window);
+/**
+ * @brief Avanza la animación de color un paso de simulación
+ * @param state Estado a avanzar
+ * @param dt Duración del paso en segundos
+ */
+void updateColorAnimation(ColorAnimation& state, double dt);
+
+/**
+ * @brief Corre la simulación sin ventana, más rápido que el tiempo real
+ * @param seconds Tiempo a simular en segundos
+ * @return 0 siempre
+ */
+int runHeadless(double seconds);
 
 
 /**
@@ -129,7 +169,12 @@ const WindowBackground SCENE_BACKGROUND[3][4] = {
  * 3. Loop principal
  * 4. Limpieza
  */
-int main(){
+int main(int argc, char** argv){
+    // ./main --headless [segundos]: solo la simulación, sin ventana ni GPU
+    if (argc > 1 && strcmp(argv[1], "--headless") == 0) {
+        return runHeadless(argc > 2 ? atof(argv[2]) : 60.0);
+    }
+
     // Inicialización de GLFW y creación de ventana
     initializeGlfw();
     GLFWwindow* window = getWindowObject();
@@ -144,10 +189,38 @@ int main(){
     // Configurar callback de teclado
     glfwSetKeyCallback(window, keyCallbackListener);
 
+    // Ritmo de frames: FRAME_VSYNC=off|on|adaptive, FRAME_FPS, FRAME_LOW_LATENCY
+    FramePacer framePacer(window, framePacingOptionsFromEnvironment());
+
+    // Simulación a 60 pasos por segundo, independiente de los FPS
+    ColorAnimation initialAnimation = { 0.0, { 0.0f, 0.0f, 0.0f } };
+    updateColorAnimation(initialAnimation, 0.0);
+    FixedTimestepLoop<ColorAnimation> simulation(initialAnimation);
+
+    // Figuras (una sola vez) y VBO compartido con capacidad para la mayor:
+    // posición en la location 0 y color en la 1
+    Figure* figures = getFiguresShapes();
+    if (figures == NULL) {
+        glfwTerminate();
+        return -1;
+    }
+    SceneVertexBuffer sceneBuffer(sizeof(VertexArray) / sizeof(float), { 3, 3 });
+
     // Loop principal de renderizado
     while (!glfwWindowShouldClose(window)) {
-        // Configurar shaders (fuera del loop)
-        Figure* figure = getFiguresShapes(WindowSceneDisplay, WindowSceneDisplay  + 1);
+        // en baja latencia espera a la GPU antes de leer la entrada
+        framePacer.beginFrame();
+        glfwPollEvents();
+
+        // Solo se sube lo que difiere de lo que ya está en el VBO; un frame sin
+        // cambios no sube nada
+        Figure& figure = figures[WindowSceneDisplay];
+        if (SceneChanged || figure.dirty) {
+            sceneBuffer.write(0, figure.figureVertex, 3 * 6 * (WindowSceneDisplay + 1));
+            figure.dirty = false;
+            SceneChanged = false;
+        }
+        sceneBuffer.flush();
         
         // Limpiar pantalla
         glClearColor(
@@ -157,21 +230,23 @@ int main(){
             1.0f
         );
         glClear(GL_COLOR_BUFFER_BIT);
+        simulation.advance(updateColorAnimation);
+        ColorAnimation animation = simulation.interpolated();
         ourShader.use();
-        calculateFPS(window);
+        ourShader.setVec4("uColor", animation.color[0], animation.color[1], animation.color[2], 1.0f);
+        calculateFPS(window, framePacer);
         // Dibujar el triángulo
-        glBindVertexArray(figure[WindowSceneDisplay].VAO);
+        glBindVertexArray(sceneBuffer.vertexArray());
         glDrawArrays(GL_TRIANGLES, 0, 3 * (WindowSceneDisplay + 1));
         
-        // Intercambiar buffers y procesar eventos
-        glfwSwapBuffers(window);
-        glfwPollEvents();
-        // Limpieza final
-        glDeleteVertexArrays(1, &figure[WindowSceneDisplay].VAO);
-        glDeleteBuffers(1, &figure[WindowSceneDisplay].VBO);
-        free(figure);
+        // Intercambiar buffers con el ritmo configurado
+        framePacer.endFrame();
     }
 
+    framePacer.printStatistics(cout);
+    cout << "Subidas de vertices: " << sceneBuffer.statistics().uploads << " ("
+         << sceneBuffer.statistics().bytesUploaded << " bytes)" << endl;
+    free(figures);
     glfwTerminate();
     return 0;
 }
@@ -260,6 +335,7 @@ void keyCallbackListener(GLFWwindow* window, int key, int scanCode, int action,
                 } else {
                     WindowSceneDisplay = 2;
                 }
+                SceneChanged = true;
                 break;
             case GLFW_KEY_RIGHT: // Tecla derecha: siguiente escena
                 if (WindowSceneDisplay < 2) {
@@ -267,6 +343,7 @@ void keyCallbackListener(GLFWwindow* window, int key, int scanCode, int action,
                 } else {
                     WindowSceneDisplay = 0;
                 }
+                SceneChanged = true;
                 break;
             case GLFW_KEY_ESCAPE: // Tecla ESC: cerrar ventana
                 glfwSetWindowShouldClose(window, true);
@@ -277,11 +354,11 @@ void keyCallbackListener(GLFWwindow* window, int key, int scanCode, int action,
 }
 
 /**
- * @brief Crea y configura las figuras geométricas
+ * @brief Crea las figuras geométricas de las 3 escenas
  * @return Puntero a arreglo de figuras o NULL en error
- * @note Actualmente solo inicializa un triángulo pero reserva espacio para 3 figuras
+ * @note Se llama una vez; las figuras nacen marcadas como sucias
  */
-Figure* getFiguresShapes(SceneRenderer figure, int coordFactor) {
+Figure* getFiguresShapes() {
     Figure* figures = (Figure*)malloc(sizeof(Figure)*3);
     if (figures == NULL) {
         cout << "Error de asignación de memoria" << endl;
@@ -295,8 +372,7 @@ Figure* getFiguresShapes(SceneRenderer figure, int coordFactor) {
             0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 0.0f,  // Vértice inferior derecho
             0.0f, 0.5f, 0.0f,  0.0f, 0.0f, 1.0f  // Vértice superior central
         },
-        .vertexShader = glCreateShader(GL_VERTEX_SHADER),
-        .fragmentShader = glCreateShader(GL_FRAGMENT_SHADER),
+        .dirty = true
     };
 
 
@@ -312,8 +388,7 @@ Figure* getFiguresShapes(SceneRenderer figure, int coordFactor) {
             -0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f,  // bottom left
             -0.5f,  0.5f, 0.0f, 1.0f, 0.0f, 0.0f,   // top left
         },
-        .vertexShader = glCreateShader(GL_VERTEX_SHADER),
-        .fragmentShader = glCreateShader(GL_FRAGMENT_SHADER),
+        .dirty = true
     };
 
 
@@ -332,51 +407,42 @@ Figure* getFiguresShapes(SceneRenderer figure, int coordFactor) {
             -0.3f, 0.2f, 0.0f, 1.0f, 0.0f, 0.0f,  // bottom left
             0.3f, 0.2f, 0.0f, 1.0f, 0.0f, 0.0f,  // bottom right       
         },
-        .vertexShader = glCreateShader(GL_VERTEX_SHADER),
-        .fragmentShader = glCreateShader(GL_FRAGMENT_SHADER),
+        .dirty = true
     };
-    
-    
-    figures[0].VBO = 0;
-    figures[0].VAO = 0;
-
-    figures[1].VBO = 0;
-    figures[1].VAO = 0;
-
-    figures[2].VBO = 0;
-    figures[2].VAO = 0;
 
+    return figures;
+}
 
-    // Generar y configurar VAO y VBO
-    glGenVertexArrays(1, &figures[figure].VAO);
-    glGenBuffers(1, &figures[figure].VBO);
-    
-    // Bind VAO primero
-    glBindVertexArray(figures[figure].VAO);
-    
-    // Luego bind y configura el VBO
-    glBindBuffer(GL_ARRAY_BUFFER, figures[figure].VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(figures[figure].figureVertex), figures[figure].figureVertex, GL_STATIC_DRAW);
-    
-    // Configurar atributos de vértice
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+void updateColorAnimation(ColorAnimation& state, double dt) {
+    state.time += dt;
+    float timeValue = (float)state.time;
+    // Generar valores de color que varían con el tiempo
+    state.color[0] = (sin(timeValue * 1.5f) * 0.5f) + 0.5f;  // Rango 0-1
+    state.color[1] = (sin(timeValue * 2.0f) * 0.5f) + 0.5f;  // Frecuencia diferente
+    state.color[2] = (sin(timeValue * 1.0f) * 0.5f) + 0.5f;  // Frecuencia base
+}
 
+int runHeadless(double seconds) {
+    ColorAnimation initialAnimation = { 0.0, { 0.0f, 0.0f, 0.0f } };
+    updateColorAnimation(initialAnimation, 0.0);
+    FixedTimestepLoop<ColorAnimation> simulation(initialAnimation);
 
-    // color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
-    // Desbindear VBO y VAO (VBO primero)
-    glBindBuffer(GL_ARRAY_BUFFER, 0); 
-    glBindVertexArray(0);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    unsigned long long steps = simulation.simulate(seconds, updateColorAnimation);
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
 
-    return figures;
+    const ColorAnimation& state = simulation.current();
+    cout << "Simulados " << simulation.simulationTime() << " s en " << steps << " pasos, "
+         << elapsed * 1000.0 << " ms reales (x" << (elapsed > 0.0 ? simulation.simulationTime() / elapsed : 0.0)
+         << " tiempo real)" << endl;
+    cout << "Color final: " << state.color[0] << ", " << state.color[1] << ", " << state.color[2] << endl;
+    return 0;
 }
 
 // Función para calcular y mostrar los FPS (Fotogramas Por Segundo)
-// Recibe como parámetro la ventana GLFW donde se mostrarán los FPS
-void calculateFPS(GLFWwindow* window) {
+// Recibe como parámetro la ventana GLFW donde se mostrarán los FPS y el
+// FramePacer que mide el intervalo real entre swaps
+void calculateFPS(GLFWwindow* window, const FramePacer& framePacer) {
     // Variables estáticas para mantener su valor entre llamadas:
     static double lastTime = glfwGetTime();  // Guarda el tiempo del último cálculo
     static int frameCount = 0;               // Contador de frames en el intervalo
@@ -389,7 +455,10 @@ void calculateFPS(GLFWwindow* window) {
     // Comprobamos si ha pasado 1 segundo desde el último cálculo
     if (currentTime - lastTime >= 1.0) {
         // Construimos el string para el título de la ventana
-        string title = "OpenGL App - FPS: " + to_string(frameCount);
+        // (el conteo del último segundo y el intervalo medio/máximo de los últimos frames)
+        FramePacingStats pacing = framePacer.statistics();
+        string title = "OpenGL App - FPS: " + to_string(frameCount) + " - frame: "
+            + to_string(pacing.average * 1000.0) + " ms (max " + to_string(pacing.maximum * 1000.0) + " ms)";
         
         // Actualizamos el título de la ventana con los FPS
         glfwSetWindowTitle(window, title.c_str());
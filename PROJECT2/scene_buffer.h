@@ -0,0 +1,216 @@
+/**
+ * @file scene_buffer.h
+ * @brief Vértices de la escena con rangos sucios: solo se sube lo que cambió
+ * @details SceneVertexBuffer guarda una copia en CPU de lo que hay en el VBO.
+ *          write() compara los datos nuevos con esa copia y marca como sucio solo
+ *          el tramo que difiere; flush() sube cada tramo con glBufferSubData y
+ *          deja la lista vacía. Un frame sin cambios no hace ninguna llamada de
+ *          subida, y cambiar de escena sube solo los vértices que no coinciden con
+ *          los que ya estaban.
+ *
+ *          El VAO y el VBO se crean una vez, con la capacidad máxima de la escena.
+ */
+#ifndef SCENE_BUFFER_H
+#define SCENE_BUFFER_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <vector>
+
+/**
+ * @class DirtyRanges
+ * @brief Tramos [begin, end) modificados, ordenados y sin solapes
+ * @details Los tramos que se tocan o están a menos de mergeGap elementos se
+ *          unen: una sola subida un poco más larga sale más barata que varias.
+ */
+class DirtyRanges
+{
+public:
+    struct Range
+    {
+        size_t begin;
+        size_t end;
+    };
+
+    explicit DirtyRanges(size_t mergeGap = 0) : mergeGap(mergeGap) {}
+
+    void add(size_t begin, size_t end)
+    {
+        if (begin >= end)
+            return;
+        Range range = { begin, end };
+        std::vector<Range> merged;
+        bool inserted = false;
+        for (const Range& current : list)
+        {
+            if (current.end + mergeGap < range.begin)
+            {
+                merged.push_back(current);
+            }
+            else if (range.end + mergeGap < current.begin)
+            {
+                if (!inserted)
+                {
+                    merged.push_back(range);
+                    inserted = true;
+                }
+                merged.push_back(current);
+            }
+            else
+            {
+                range.begin = std::min(range.begin, current.begin);
+                range.end = std::max(range.end, current.end);
+            }
+        }
+        if (!inserted)
+            merged.push_back(range);
+        list.swap(merged);
+    }
+
+    const std::vector<Range>& ranges() const { return list; }
+    bool empty() const { return list.empty(); }
+    void clear() { list.clear(); }
+
+private:
+    std::vector<Range> list;
+    size_t mergeGap;
+};
+
+/**
+ * @struct SceneBufferStats
+ * @brief Contadores de subidas
+ */
+struct SceneBufferStats
+{
+    size_t writes = 0;        ///< Llamadas a write()
+    size_t unchangedWrites = 0; ///< write() sin ningún valor distinto
+    size_t uploads = 0;       ///< Llamadas a glBufferSubData
+    size_t bytesUploaded = 0;
+};
+
+/**
+ * @class SceneVertexBuffer
+ * @brief VAO + VBO de floats con copia en CPU y subida incremental
+ */
+class SceneVertexBuffer
+{
+public:
+    /**
+     * @param capacity Floats que caben en el VBO
+     * @param attributes Floats de cada atributo intercalado, en las locations 0, 1...
+     */
+    explicit SceneVertexBuffer(size_t capacity, std::initializer_list<int> attributes = { 3 })
+        : shadow(capacity, 0.0f), dirty(vertexFloats(attributes)), VAO(0), VBO(0)
+    {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        // se inicializa con la copia (ceros) para que la comparación de write() sea válida
+        glBufferData(GL_ARRAY_BUFFER, shadow.size() * sizeof(float), shadow.data(), GL_DYNAMIC_DRAW);
+        GLsizei stride = (GLsizei)(vertexFloats(attributes) * sizeof(float));
+        GLuint location = 0;
+        size_t offset = 0;
+        for (int components : attributes)
+        {
+            glVertexAttribPointer(location, components, GL_FLOAT, GL_FALSE, stride, (void*)(offset * sizeof(float)));
+            glEnableVertexAttribArray(location);
+            location++;
+            offset += components;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+    ~SceneVertexBuffer()
+    {
+        // tras glfwTerminate no hay contexto y los objetos ya no existen
+        if (glfwGetCurrentContext())
+        {
+            glDeleteVertexArrays(1, &VAO);
+            glDeleteBuffers(1, &VBO);
+        }
+    }
+
+    SceneVertexBuffer(const SceneVertexBuffer&) = delete;
+    SceneVertexBuffer& operator=(const SceneVertexBuffer&) = delete;
+
+    /**
+     * @brief Escribe floats en la copia y marca sucio solo el tramo que difiere
+     * @param offset Primer float a escribir
+     * @return true si algún valor cambió
+     */
+    bool write(size_t offset, const float* data, size_t count)
+    {
+        stats.writes++;
+        if (offset + count > shadow.size())
+        {
+            std::cout << "ERROR::SCENE_BUFFER::OUT_OF_RANGE " << offset + count << " > " << shadow.size() << std::endl;
+            return false;
+        }
+        size_t first = 0;
+        while (first < count && shadow[offset + first] == data[first])
+            first++;
+        if (first == count)
+        {
+            stats.unchangedWrites++;
+            return false;
+        }
+        size_t last = count;
+        while (shadow[offset + last - 1] == data[last - 1])
+            last--;
+        std::copy(data + first, data + last, shadow.begin() + offset + first);
+        dirty.add(offset + first, offset + last);
+        return true;
+    }
+
+    /**
+     * @brief Sube los tramos sucios con glBufferSubData
+     * @return Bytes subidos (0 si no había cambios)
+     */
+    size_t flush()
+    {
+        if (dirty.empty())
+            return 0;
+        size_t bytes = 0;
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        for (const DirtyRanges::Range& range : dirty.ranges())
+        {
+            size_t size = (range.end - range.begin) * sizeof(float);
+            glBufferSubData(GL_ARRAY_BUFFER, range.begin * sizeof(float), size, shadow.data() + range.begin);
+            bytes += size;
+            stats.uploads++;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        dirty.clear();
+        stats.bytesUploaded += bytes;
+        return bytes;
+    }
+
+    /// VAO con el VBO como atributo 0
+    unsigned int vertexArray() const { return VAO; }
+    size_t capacity() const { return shadow.size(); }
+    const SceneBufferStats& statistics() const { return stats; }
+
+private:
+    std::vector<float> shadow; ///< Contenido del VBO tras el próximo flush
+    DirtyRanges dirty;         ///< En floats; une tramos a menos de un vértice
+    unsigned int VAO;
+    unsigned int VBO;
+    SceneBufferStats stats;
+
+    static size_t vertexFloats(std::initializer_list<int> attributes)
+    {
+        size_t floats = 0;
+        for (int components : attributes)
+            floats += components;
+        return floats;
+    }
+};
+
+#endif
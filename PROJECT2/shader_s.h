@@ -3,7 +3,6 @@
 
 #include <glad/glad.h>
 
-#include <cmath>
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -70,20 +69,12 @@ public:
         glDeleteShader(fragment);
     }
     // activar el shader
+    // El color animado lo calcula la simulación (game_loop.h) y llega con
+    // setVec4; aquí solo se activa el programa.
     // ----------------------------------------------------------------
     void use() 
     { 
-        float timeValue = glfwGetTime();
-        
-        // Generar valores de color que varían con el tiempo
-        float redValue   = (sin(timeValue * 1.5f) * 0.5f) + 0.5f;  // Rango 0-1
-        float greenValue = (sin(timeValue * 2.0f) * 0.5f) + 0.5f;  // Frecuencia diferente
-        float blueValue  = (sin(timeValue * 1.0f) * 0.5f) + 0.5f; // Frecuencia base
-        
-        // Obtener la ubicación del uniform y asignar el color
-        int vertexColorLocation = glGetUniformLocation(ID, "uColor");
         glUseProgram(ID);
-        glUniform4f(vertexColorLocation, redValue, greenValue, blueValue, 1.0f);
     }
     // funciones de utilidad para uniforms
     // ----------------------------------------------------------------
@@ -101,6 +92,11 @@ public:
     { 
         glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
     }
+    // ----------------------------------------------------------------
+    void setVec4(const std::string &name, float x, float y, float z, float w) const
+    { 
+        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w); 
+    }
 
 private:
     // función de utilidad para verificar errores de compilación/enlazado
@@ -0,0 +1,229 @@
+/**
+ * @file asset_io.h
+ * @brief Carga de assets sin copias: archivos proyectados en memoria
+ * @details Los assets se proyectan de solo lectura y se entregan como vistas
+ *          (puntero + longitud) directamente a quien los consume: glShaderSource
+ *          con longitudes explícitas o decodeImage. Así no hay ni el
+ *          buffer de stdio ni las copias ifstream -> stringstream -> std::string, y
+ *          la memoria de la lectura es caché de páginas compartida, no heap.
+ *          Cada asset se abre con una sugerencia madvise según cómo se va a leer.
+ *
+ *          Si hay archivos .lpak montados, los assets se buscan primero en ellos
+ *          (una búsqueda en el índice, sin syscalls) y solo después en disco.
+ */
+#ifndef ASSET_IO_H
+#define ASSET_IO_H
+
+#include <cstddef>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "image_decode.h"
+#include "mapped_file.h"
+#include "pack_archive.h"
+
+/**
+ * @struct AssetSpan
+ * @brief Vista de bytes de un asset; no es dueña de la memoria
+ */
+struct AssetSpan
+{
+    const char* data = nullptr;
+    size_t size = 0;
+};
+
+/**
+ * @class Asset
+ * @brief Contenido de un asset abierto: un archivo proyectado o una entrada de un .lpak
+ */
+class Asset
+{
+public:
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    friend std::shared_ptr<const Asset> openAsset(const std::string& path, MappedFileAccess access);
+    friend std::shared_ptr<const Asset> openDiskAsset(const std::string& path, MappedFileAccess access);
+
+    MappedFile file;                   ///< Archivo suelto proyectado
+    std::shared_ptr<const void> owner; ///< .lpak que contiene la entrada
+    std::vector<unsigned char> buffer; ///< Entrada descomprimida
+    const unsigned char* bytes = nullptr;
+    size_t length = 0;
+};
+
+/// Asset abierto; compartido para que las vistas lo mantengan vivo mientras se usan
+typedef std::shared_ptr<const Asset> AssetFile;
+
+/**
+ * @struct MountedAssetPack
+ * @brief .lpak montado y el directorio contra el que se resuelven sus nombres
+ */
+struct MountedAssetPack
+{
+    std::shared_ptr<const PackArchive> archive;
+    std::filesystem::path root;
+};
+
+/// Packs montados, en orden de búsqueda
+inline std::vector<MountedAssetPack>& mountedAssetPacks()
+{
+    static std::vector<MountedAssetPack> packs;
+    return packs;
+}
+
+/**
+ * @brief Monta un .lpak para que openAsset lo consulte antes que el disco
+ * @details Los nombres del pack se resuelven contra el directorio de trabajo al
+ *          montar, de modo que "./wall.jpg" y su ruta absoluta encuentran la misma
+ *          entrada. Montar antes de crear hilos que carguen assets.
+ * @return false si el archivo no existe o no es válido
+ */
+inline bool mountAssetPack(const std::string& path)
+{
+    std::string error;
+    std::shared_ptr<const PackArchive> archive = PackArchive::open(path, error);
+    if (!archive)
+    {
+        std::cout << "ERROR::ASSET::PACK_NO_MONTADO: " << path << " " << error << std::endl;
+        return false;
+    }
+    std::error_code ignored;
+    MountedAssetPack pack;
+    pack.archive = archive;
+    pack.root = std::filesystem::current_path(ignored);
+    mountedAssetPacks().push_back(pack);
+    return true;
+}
+
+/// Desmonta todos los packs (los assets ya abiertos siguen siendo válidos)
+inline void unmountAssetPacks()
+{
+    mountedAssetPacks().clear();
+}
+
+/**
+ * @brief Busca un asset en los packs montados
+ * @return La entrada y su pack, o nullptr si no está en ninguno
+ */
+inline const PackEntry* findPackedAsset(const std::string& path, std::shared_ptr<const PackArchive>* archive = nullptr)
+{
+    if (mountedAssetPacks().empty())
+        return nullptr;
+    for (const MountedAssetPack& pack : mountedAssetPacks())
+    {
+        std::filesystem::path name(path);
+        if (name.is_absolute())
+        {
+            name = name.lexically_normal().lexically_relative(pack.root);
+            if (name.empty() || *name.begin() == "..")
+                continue;
+        }
+        const PackEntry* entry = pack.archive->find(name.string());
+        if (entry)
+        {
+            if (archive)
+                *archive = pack.archive;
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Abre un archivo del disco proyectado en memoria, ignorando los packs
+ * @details Para lo que se edita con el programa corriendo (shaders con recarga
+ *          en caliente): la copia del pack quedaría desactualizada.
+ */
+inline AssetFile openDiskAsset(const std::string& path, MappedFileAccess access = MappedFileAccess::Sequential)
+{
+    std::shared_ptr<Asset> asset = std::make_shared<Asset>();
+    if (!asset->file.open(path))
+        return nullptr;
+    asset->file.advise(access);
+    asset->bytes = asset->file.data();
+    asset->length = asset->file.size();
+    return asset;
+}
+
+/**
+ * @brief Abre un asset: primero en los packs montados, luego en disco
+ * @param path Ruta del archivo
+ * @param access Sugerencia de acceso (por defecto, lectura secuencial completa)
+ * @return El asset, o nullptr si no se encontró
+ */
+inline AssetFile openAsset(const std::string& path, MappedFileAccess access = MappedFileAccess::Sequential)
+{
+    std::shared_ptr<Asset> asset = std::make_shared<Asset>();
+    std::shared_ptr<const PackArchive> archive;
+    const PackEntry* entry = findPackedAsset(path, &archive);
+    if (entry)
+    {
+        if (!archive->read(*entry, asset->bytes, asset->length, asset->buffer))
+        {
+            std::cout << "ERROR::ASSET::ENTRADA_CORRUPTA: " << path << std::endl;
+            return nullptr;
+        }
+        asset->owner = archive;
+        return asset;
+    }
+    return openDiskAsset(path, access);
+}
+
+/**
+ * @brief true si el asset existe en un pack montado o en disco
+ */
+inline bool assetExists(const std::string& path)
+{
+    std::error_code ignored;
+    return findPackedAsset(path) != nullptr || std::filesystem::exists(path, ignored);
+}
+
+/**
+ * @brief Vista al contenido completo de un asset abierto
+ */
+inline AssetSpan assetSpan(const Asset& asset)
+{
+    AssetSpan span;
+    span.data = reinterpret_cast<const char*>(asset.data());
+    span.size = asset.size();
+    return span;
+}
+
+/**
+ * @brief Decodifica una imagen desde su asset
+ * @details Equivale a stbi_load, pero los backends de image_decode.h leen de la
+ *          proyección (o del pack) en lugar de pasar por un FILE* con su propio buffer.
+ * @return Píxeles a liberar con stbi_image_free, o NULL si falla
+ */
+inline unsigned char* loadImageAsset(const std::string& path, int* width, int* height, int* channels, int desiredChannels = 0)
+{
+    AssetFile file = openAsset(path, MappedFileAccess::Sequential);
+    if (!file || file->size() == 0)
+        return NULL;
+    return decodeImage(file->data(), file->size(), width, height, channels, desiredChannels);
+}
+
+/**
+ * @brief Dimensiones y canales de la imagen de un asset abierto (solo la cabecera)
+ */
+inline bool imageAssetInfo(const AssetFile& file, int* width, int* height, int* channels)
+{
+    return file && file->size() > 0 && imageInfo(file->data(), file->size(), width, height, channels);
+}
+
+/**
+ * @brief Decodifica la imagen de un asset abierto directo en el destino
+ * @details El destino se dimensiona antes con imageAssetInfo; así un PBO
+ *          mapeado o un búfer de staging recibe los píxeles sin copias.
+ */
+inline bool decodeImageAsset(const AssetFile& file, const ImageDecodeTarget& target)
+{
+    return file && file->size() > 0 && decodeImageInto(file->data(), file->size(), target);
+}
+
+#endif
@@ -0,0 +1,617 @@
+/**
+ * @file bc_encoder.h
+ * @brief Compresor de texturas a bloques BC1, BC3 y BC7
+ * @details Cada bloque de 4x4 píxeles se codifica de forma independiente:
+ *          - BC1 (8 bytes): dos colores 5:6:5 y 2 bits por píxel. Rápido; sin alfa.
+ *          - BC3 (16 bytes): bloque de alfa de 8 niveles + bloque de color BC1.
+ *          - BC7 (16 bytes): modo 6, un solo subconjunto RGBA con extremos de 7 bits
+ *            + p-bit e índices de 4 bits. Más lento y de mayor calidad.
+ *          Los extremos salen del eje principal (PCA) del bloque y se refinan por
+ *          mínimos cuadrados; la proyección de los 16 píxeles sobre el eje, que es
+ *          lo que se repite en cada intento, tiene versión SSE2 y NEON. Las filas
+ *          de bloques se reparten en el JobSystem. No depende de GL.
+ */
+#ifndef BC_ENCODER_H
+#define BC_ENCODER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "job_system.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BC_ENCODER_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BC_ENCODER_NEON 1
+#endif
+
+/**
+ * @enum BlockFormat
+ * @brief Formato de compresión por bloques
+ */
+enum class BlockFormat
+{
+    BC1, ///< RGB, 4 bits por píxel
+    BC3, ///< RGBA, 8 bits por píxel
+    BC7  ///< RGBA de alta calidad, 8 bits por píxel
+};
+
+/// Bytes de un bloque de 4x4
+inline size_t blockBytes(BlockFormat format)
+{
+    return format == BlockFormat::BC1 ? 8 : 16;
+}
+
+/// Bytes de una imagen comprimida (los bloques del borde se completan)
+inline size_t blockCompressedSize(BlockFormat format, int width, int height)
+{
+    return (size_t)((width + 3) / 4) * (size_t)((height + 3) / 4) * blockBytes(format);
+}
+
+/**
+ * @struct BlockPixels
+ * @brief Los 16 píxeles de un bloque por canal (SoA), en float [0, 255]
+ */
+struct BlockPixels
+{
+    alignas(16) float channel[4][16];
+};
+
+/**
+ * @brief Proyecta los 16 píxeles sobre un eje
+ * @details result[i] = dot(pixel[i] - origin, axis) * scale, con 3 o 4 canales.
+ */
+inline void projectBlock(const BlockPixels& block, int channels, const float origin[4], const float axis[4],
+                         float scale, float result[16], bool simd)
+{
+#if defined(BC_ENCODER_SSE2)
+    if (simd)
+    {
+        for (int i = 0; i < 16; i += 4)
+        {
+            __m128 sum = _mm_setzero_ps();
+            for (int c = 0; c < channels; c++)
+            {
+                __m128 delta = _mm_sub_ps(_mm_load_ps(block.channel[c] + i), _mm_set1_ps(origin[c]));
+                sum = _mm_add_ps(sum, _mm_mul_ps(delta, _mm_set1_ps(axis[c])));
+            }
+            _mm_storeu_ps(result + i, _mm_mul_ps(sum, _mm_set1_ps(scale)));
+        }
+        return;
+    }
+#elif defined(BC_ENCODER_NEON)
+    if (simd)
+    {
+        for (int i = 0; i < 16; i += 4)
+        {
+            float32x4_t sum = vdupq_n_f32(0.0f);
+            for (int c = 0; c < channels; c++)
+                sum = vmlaq_n_f32(sum, vsubq_f32(vld1q_f32(block.channel[c] + i), vdupq_n_f32(origin[c])), axis[c]);
+            vst1q_f32(result + i, vmulq_n_f32(sum, scale));
+        }
+        return;
+    }
+#endif
+    for (int i = 0; i < 16; i++)
+    {
+        float sum = 0.0f;
+        for (int c = 0; c < channels; c++)
+            sum += (block.channel[c][i] - origin[c]) * axis[c];
+        result[i] = sum * scale;
+    }
+}
+
+/**
+ * @brief Media y eje principal de los píxeles (iteración de potencias)
+ */
+inline void principalAxis(const BlockPixels& block, int channels, float mean[4], float axis[4])
+{
+    for (int c = 0; c < 4; c++)
+    {
+        mean[c] = 0.0f;
+        axis[c] = 0.0f;
+        if (c >= channels)
+            continue;
+        for (int i = 0; i < 16; i++)
+            mean[c] += block.channel[c][i];
+        mean[c] /= 16.0f;
+    }
+    float covariance[4][4] = {};
+    for (int i = 0; i < 16; i++)
+    {
+        float delta[4] = {};
+        for (int c = 0; c < channels; c++)
+            delta[c] = block.channel[c][i] - mean[c];
+        for (int a = 0; a < channels; a++)
+        {
+            for (int b = a; b < channels; b++)
+                covariance[a][b] += delta[a] * delta[b];
+        }
+    }
+    for (int a = 0; a < channels; a++)
+    {
+        for (int b = 0; b < a; b++)
+            covariance[a][b] = covariance[b][a];
+    }
+    // arranque: la fila de mayor varianza, que nunca es ortogonal al eje buscado
+    int start = 0;
+    for (int c = 1; c < channels; c++)
+    {
+        if (covariance[c][c] > covariance[start][start])
+            start = c;
+    }
+    float vector[4] = {};
+    for (int c = 0; c < channels; c++)
+        vector[c] = covariance[start][c];
+    for (int iteration = 0; iteration < 8; iteration++)
+    {
+        float next[4] = {};
+        float length = 0.0f;
+        for (int a = 0; a < channels; a++)
+        {
+            for (int b = 0; b < channels; b++)
+                next[a] += covariance[a][b] * vector[b];
+            length = std::max(length, std::fabs(next[a]));
+        }
+        if (length < 1e-6f)
+            break;
+        for (int c = 0; c < channels; c++)
+            vector[c] = next[c] / length;
+    }
+    float length = 0.0f;
+    for (int c = 0; c < channels; c++)
+        length += vector[c] * vector[c];
+    length = std::sqrt(length);
+    for (int c = 0; c < channels; c++)
+        axis[c] = length > 1e-6f ? vector[c] / length : 1.0f / std::sqrt((float)channels);
+}
+
+/**
+ * @brief Ajuste por mínimos cuadrados de los extremos dados los pesos de cada píxel
+ * @param weights Posición de cada píxel entre los extremos, en [0, 1]
+ * @return false si el sistema es singular (todos los píxeles en el mismo peso)
+ */
+inline bool leastSquaresEndpoints(const BlockPixels& block, int channels, const float weights[16],
+                                  float endpoint0[4], float endpoint1[4])
+{
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[4] = {}, bx[4] = {};
+    for (int i = 0; i < 16; i++)
+    {
+        float b = weights[i];
+        float a = 1.0f - b;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int c = 0; c < channels; c++)
+        {
+            ax[c] += a * block.channel[c][i];
+            bx[c] += b * block.channel[c][i];
+        }
+    }
+    float determinant = aa * bb - ab * ab;
+    if (std::fabs(determinant) < 1e-6f)
+        return false;
+    float inverse = 1.0f / determinant;
+    for (int c = 0; c < channels; c++)
+    {
+        endpoint0[c] = std::min(255.0f, std::max(0.0f, (ax[c] * bb - bx[c] * ab) * inverse));
+        endpoint1[c] = std::min(255.0f, std::max(0.0f, (bx[c] * aa - ax[c] * ab) * inverse));
+    }
+    return true;
+}
+
+/**
+ * @brief Copia un bloque de la imagen a RGBA; fuera de la imagen repite el borde
+ * @details 1 y 2 canales son gris y gris + alfa: 1 -> (l,l,l,255), 2 -> (l,l,l,a),
+ *          como los muestrea una textura sin comprimir con setGreyscaleSwizzle.
+ */
+inline void loadBlock(const unsigned char* pixels, int width, int height, int channels,
+                      int blockX, int blockY, BlockPixels& block)
+{
+    for (int y = 0; y < 4; y++)
+    {
+        int sourceY = std::min(height - 1, blockY * 4 + y);
+        for (int x = 0; x < 4; x++)
+        {
+            int sourceX = std::min(width - 1, blockX * 4 + x);
+            const unsigned char* pixel = pixels + ((size_t)sourceY * width + sourceX) * channels;
+            int i = y * 4 + x;
+            if (channels <= 2)
+            {
+                block.channel[0][i] = block.channel[1][i] = block.channel[2][i] = pixel[0];
+                block.channel[3][i] = channels == 2 ? pixel[1] : 255.0f;
+                continue;
+            }
+            for (int c = 0; c < 4; c++)
+                block.channel[c][i] = c < channels ? pixel[c] : 255.0f;
+        }
+    }
+}
+
+/// Color 5:6:5 más cercano
+inline uint16_t quantize565(const float color[4])
+{
+    int r = std::min(31, std::max(0, (int)(color[0] * 31.0f / 255.0f + 0.5f)));
+    int g = std::min(63, std::max(0, (int)(color[1] * 63.0f / 255.0f + 0.5f)));
+    int b = std::min(31, std::max(0, (int)(color[2] * 31.0f / 255.0f + 0.5f)));
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+/// Color 5:6:5 a 8 bits por canal, como lo expande el hardware
+inline void expand565(uint16_t packed, float color[4])
+{
+    int r = (packed >> 11) & 31;
+    int g = (packed >> 5) & 63;
+    int b = packed & 31;
+    color[0] = (float)((r << 3) | (r >> 2));
+    color[1] = (float)((g << 2) | (g >> 4));
+    color[2] = (float)((b << 3) | (b >> 2));
+    color[3] = 255.0f;
+}
+
+/**
+ * @brief Elige los índices BC1 (modo de 4 colores) para dos extremos ya cuantizados
+ * @param positions Posición de cada píxel: 0 = color0 ... 3 = color1
+ * @return Error cuadrático del bloque
+ */
+inline float selectBC1Positions(const BlockPixels& block, uint16_t color0, uint16_t color1, int positions[16], bool simd)
+{
+    float c0[4], c1[4];
+    expand565(color0, c0);
+    expand565(color1, c1);
+    float axis[4] = { c1[0] - c0[0], c1[1] - c0[1], c1[2] - c0[2], 0.0f };
+    float length = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    float projected[16];
+    projectBlock(block, 3, c0, axis, length > 0.0f ? 3.0f / length : 0.0f, projected, simd);
+    float palette[4][3];
+    for (int c = 0; c < 3; c++)
+    {
+        palette[0][c] = c0[c];
+        palette[1][c] = (2.0f * c0[c] + c1[c]) / 3.0f;
+        palette[2][c] = (c0[c] + 2.0f * c1[c]) / 3.0f;
+        palette[3][c] = c1[c];
+    }
+    float error = 0.0f;
+    for (int i = 0; i < 16; i++)
+    {
+        int position = std::min(3, std::max(0, (int)(projected[i] + 0.5f)));
+        positions[i] = position;
+        for (int c = 0; c < 3; c++)
+        {
+            float delta = block.channel[c][i] - palette[position][c];
+            error += delta * delta;
+        }
+    }
+    return error;
+}
+
+/**
+ * @brief Codifica el color de un bloque en BC1 (modo de 4 colores)
+ */
+inline void encodeBC1Color(const BlockPixels& block, unsigned char* out, bool simd)
+{
+    float mean[4], axis[4];
+    principalAxis(block, 3, mean, axis);
+    float projected[16];
+    projectBlock(block, 3, mean, axis, 1.0f, projected, simd);
+    float minimum = projected[0], maximum = projected[0];
+    for (int i = 1; i < 16; i++)
+    {
+        minimum = std::min(minimum, projected[i]);
+        maximum = std::max(maximum, projected[i]);
+    }
+    // acercar los extremos un poco compensa que los puntos intermedios caen entre píxeles
+    float inset = (maximum - minimum) / 16.0f;
+    float endpoint0[4], endpoint1[4];
+    for (int c = 0; c < 3; c++)
+    {
+        endpoint0[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * (minimum + inset)));
+        endpoint1[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * (maximum - inset)));
+    }
+    uint16_t color0 = quantize565(endpoint0);
+    uint16_t color1 = quantize565(endpoint1);
+    int positions[16];
+    float error = selectBC1Positions(block, color0, color1, positions, simd);
+
+    // un refinamiento por mínimos cuadrados; se queda si mejora
+    float weights[16];
+    for (int i = 0; i < 16; i++)
+        weights[i] = positions[i] / 3.0f;
+    if (leastSquaresEndpoints(block, 3, weights, endpoint0, endpoint1))
+    {
+        uint16_t refined0 = quantize565(endpoint0);
+        uint16_t refined1 = quantize565(endpoint1);
+        int refinedPositions[16];
+        float refinedError = selectBC1Positions(block, refined0, refined1, refinedPositions, simd);
+        if (refinedError < error)
+        {
+            color0 = refined0;
+            color1 = refined1;
+            memcpy(positions, refinedPositions, sizeof(positions));
+        }
+    }
+
+    // el modo de 4 colores exige color0 > color1
+    if (color0 < color1)
+    {
+        std::swap(color0, color1);
+        for (int i = 0; i < 16; i++)
+            positions[i] = 3 - positions[i];
+    }
+    static const int positionToIndex[4] = { 0, 2, 3, 1 };
+    uint32_t indices = 0;
+    for (int i = 0; i < 16; i++)
+        indices |= (uint32_t)(color0 == color1 ? 0 : positionToIndex[positions[i]]) << (2 * i);
+    out[0] = (unsigned char)(color0 & 0xFF);
+    out[1] = (unsigned char)(color0 >> 8);
+    out[2] = (unsigned char)(color1 & 0xFF);
+    out[3] = (unsigned char)(color1 >> 8);
+    for (int i = 0; i < 4; i++)
+        out[4 + i] = (unsigned char)(indices >> (8 * i));
+}
+
+/**
+ * @brief Codifica el alfa de un bloque como en BC3 (8 niveles entre mínimo y máximo)
+ */
+inline void encodeBC3Alpha(const BlockPixels& block, unsigned char* out)
+{
+    float minimum = 255.0f, maximum = 0.0f;
+    for (int i = 0; i < 16; i++)
+    {
+        minimum = std::min(minimum, block.channel[3][i]);
+        maximum = std::max(maximum, block.channel[3][i]);
+    }
+    int alpha0 = (int)maximum;
+    int alpha1 = (int)minimum;
+    out[0] = (unsigned char)alpha0;
+    out[1] = (unsigned char)alpha1;
+    uint64_t indices = 0;
+    if (alpha0 > alpha1)
+    {
+        float scale = 7.0f / (float)(alpha0 - alpha1);
+        for (int i = 0; i < 16; i++)
+        {
+            // posición 0 = alpha1 ... 7 = alpha0; índice 0 = alpha0, 1 = alpha1, 2-7 intermedios
+            int position = (int)((block.channel[3][i] - alpha1) * scale + 0.5f);
+            int index = position == 7 ? 0 : (position == 0 ? 1 : 8 - position);
+            indices |= (uint64_t)index << (3 * i);
+        }
+    }
+    for (int i = 0; i < 6; i++)
+        out[2 + i] = (unsigned char)(indices >> (8 * i));
+}
+
+/// Pesos de interpolación de los índices de 4 bits de BC7
+const int BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+/// Índice de 4 bits cuyo peso es el más cercano a w (0-64)
+inline const unsigned char* bc7NearestWeightTable()
+{
+    static const std::vector<unsigned char> table = []() {
+        std::vector<unsigned char> values(65);
+        for (int w = 0; w <= 64; w++)
+        {
+            int best = 0;
+            for (int i = 1; i < 16; i++)
+            {
+                if (std::abs(BC7_WEIGHTS4[i] - w) < std::abs(BC7_WEIGHTS4[best] - w))
+                    best = i;
+            }
+            values[w] = (unsigned char)best;
+        }
+        return values;
+    }();
+    return table.data();
+}
+
+/**
+ * @struct BC7Mode6
+ * @brief Parámetros de un bloque BC7 en modo 6
+ */
+struct BC7Mode6
+{
+    int endpoint[2][4]; ///< Extremos de 7 bits por canal
+    int pbit[2];
+    int indices[16];
+    float error;
+};
+
+/// Extremo de 8 bits reconstruido: 7 bits + p-bit
+inline int bc7Expand(int value7, int pbit)
+{
+    return (value7 << 1) | pbit;
+}
+
+/**
+ * @brief Cuantiza dos extremos con p-bits dados y elige los índices
+ */
+inline void bc7EvaluateMode6(const BlockPixels& block, const float endpoint0[4], const float endpoint1[4],
+                             int pbit0, int pbit1, BC7Mode6& result, bool simd)
+{
+    float expanded[2][4];
+    for (int c = 0; c < 4; c++)
+    {
+        result.endpoint[0][c] = std::min(127, std::max(0, (int)std::floor((endpoint0[c] - pbit0) / 2.0f + 0.5f)));
+        result.endpoint[1][c] = std::min(127, std::max(0, (int)std::floor((endpoint1[c] - pbit1) / 2.0f + 0.5f)));
+        expanded[0][c] = (float)bc7Expand(result.endpoint[0][c], pbit0);
+        expanded[1][c] = (float)bc7Expand(result.endpoint[1][c], pbit1);
+    }
+    result.pbit[0] = pbit0;
+    result.pbit[1] = pbit1;
+
+    float axis[4];
+    float length = 0.0f;
+    for (int c = 0; c < 4; c++)
+    {
+        axis[c] = expanded[1][c] - expanded[0][c];
+        length += axis[c] * axis[c];
+    }
+    float projected[16];
+    projectBlock(block, 4, expanded[0], axis, length > 0.0f ? 64.0f / length : 0.0f, projected, simd);
+    const unsigned char* nearest = bc7NearestWeightTable();
+    result.error = 0.0f;
+    for (int i = 0; i < 16; i++)
+    {
+        int weight = std::min(64, std::max(0, (int)(projected[i] + 0.5f)));
+        int index = nearest[weight];
+        result.indices[i] = index;
+        int w = BC7_WEIGHTS4[index];
+        for (int c = 0; c < 4; c++)
+        {
+            int value = ((64 - w) * (int)expanded[0][c] + w * (int)expanded[1][c] + 32) >> 6;
+            float delta = block.channel[c][i] - (float)value;
+            result.error += delta * delta;
+        }
+    }
+}
+
+/// Escribe bits en un bloque de 128 bits, del menos significativo al más
+struct BlockBitWriter
+{
+    unsigned char* out;
+    int position;
+
+    void write(uint32_t value, int bits)
+    {
+        for (int i = 0; i < bits; i++)
+        {
+            if (value & (1u << i))
+                out[position >> 3] |= (unsigned char)(1u << (position & 7));
+            position++;
+        }
+    }
+};
+
+/**
+ * @brief Codifica un bloque en BC7 modo 6
+ */
+inline void encodeBC7Block(const BlockPixels& block, unsigned char* out, bool simd = true)
+{
+    float mean[4], axis[4];
+    principalAxis(block, 4, mean, axis);
+    float projected[16];
+    projectBlock(block, 4, mean, axis, 1.0f, projected, simd);
+    float minimum = projected[0], maximum = projected[0];
+    for (int i = 1; i < 16; i++)
+    {
+        minimum = std::min(minimum, projected[i]);
+        maximum = std::max(maximum, projected[i]);
+    }
+    float endpoint0[4], endpoint1[4];
+    for (int c = 0; c < 4; c++)
+    {
+        endpoint0[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * minimum));
+        endpoint1[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * maximum));
+    }
+
+    BC7Mode6 best = {};
+    best.error = 1e30f;
+    for (int iteration = 0; iteration < 3; iteration++)
+    {
+        bool improved = false;
+        for (int p = 0; p < 4; p++)
+        {
+            BC7Mode6 candidate;
+            bc7EvaluateMode6(block, endpoint0, endpoint1, p & 1, p >> 1, candidate, simd);
+            if (candidate.error < best.error)
+            {
+                best = candidate;
+                improved = true;
+            }
+        }
+        if (!improved || best.error == 0.0f)
+            break;
+        float weights[16];
+        for (int i = 0; i < 16; i++)
+            weights[i] = BC7_WEIGHTS4[best.indices[i]] / 64.0f;
+        if (!leastSquaresEndpoints(block, 4, weights, endpoint0, endpoint1))
+            break;
+    }
+
+    // el bit más alto del índice del píxel 0 es implícito (0): si no, se invierten los extremos
+    if (best.indices[0] & 8)
+    {
+        for (int c = 0; c < 4; c++)
+            std::swap(best.endpoint[0][c], best.endpoint[1][c]);
+        std::swap(best.pbit[0], best.pbit[1]);
+        for (int i = 0; i < 16; i++)
+            best.indices[i] = 15 - best.indices[i];
+    }
+
+    memset(out, 0, 16);
+    BlockBitWriter writer = { out, 0 };
+    writer.write(1u << 6, 7); // modo 6: seis ceros y un uno
+    for (int c = 0; c < 4; c++)
+    {
+        writer.write((uint32_t)best.endpoint[0][c], 7);
+        writer.write((uint32_t)best.endpoint[1][c], 7);
+    }
+    writer.write((uint32_t)best.pbit[0], 1);
+    writer.write((uint32_t)best.pbit[1], 1);
+    writer.write((uint32_t)best.indices[0], 3);
+    for (int i = 1; i < 16; i++)
+        writer.write((uint32_t)best.indices[i], 4);
+}
+
+/**
+ * @brief Codifica un bloque en el formato indicado
+ */
+inline void encodeBlock(const BlockPixels& block, BlockFormat format, unsigned char* out, bool simd = true)
+{
+    switch (format)
+    {
+        case BlockFormat::BC1:
+            encodeBC1Color(block, out, simd);
+            break;
+        case BlockFormat::BC3:
+            encodeBC3Alpha(block, out);
+            encodeBC1Color(block, out + 8, simd);
+            break;
+        case BlockFormat::BC7:
+            encodeBC7Block(block, out, simd);
+            break;
+    }
+}
+
+/**
+ * @brief Comprime una imagen completa
+ * @param pixels Filas contiguas de 8 bits por canal
+ * @param width Ancho en píxeles
+ * @param height Alto en píxeles
+ * @param channels Canales por píxel (1-4)
+ * @param format Formato de salida
+ * @param parallel Repartir las filas de bloques en defaultJobSystem()
+ * @return Bloques en orden de filas, listos para glCompressedTexImage2D
+ */
+inline std::vector<unsigned char> compressImage(const unsigned char* pixels, int width, int height, int channels,
+                                                BlockFormat format, bool parallel = true, bool simd = true)
+{
+    int blocksX = (width + 3) / 4;
+    int blocksY = (height + 3) / 4;
+    size_t bytes = blockBytes(format);
+    std::vector<unsigned char> blocks((size_t)blocksX * blocksY * bytes);
+    std::function<void(size_t, size_t)> body = [&](size_t begin, size_t end) {
+        BlockPixels block;
+        for (size_t blockY = begin; blockY < end; blockY++)
+        {
+            for (int blockX = 0; blockX < blocksX; blockX++)
+            {
+                loadBlock(pixels, width, height, channels, blockX, (int)blockY, block);
+                encodeBlock(block, format, blocks.data() + ((size_t)blockY * blocksX + blockX) * bytes, simd);
+            }
+        }
+    };
+    if (parallel)
+        defaultJobSystem().parallelFor((size_t)blocksY, 4, body);
+    else
+        body(0, (size_t)blocksY);
+    return blocks;
+}
+
+#endif
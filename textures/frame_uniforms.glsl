@@ -0,0 +1,10 @@
+// Constantes por frame compartidas por todos los programas.
+// Espejo de FrameUniforms en uniform_buffer.h (layout std140, binding 0).
+layout (std140) uniform FrameData
+{
+    mat4 uView;
+    mat4 uProjection;
+    vec2 uResolution;
+    float uTime;
+    float uDeltaTime;
+};
@@ -0,0 +1,70 @@
+/**
+ * @file gl_state.h
+ * @brief Guardas que restauran enlaces GL al salir del ámbito
+ * @details Quien crea o sube objetos GL por su cuenta (el pool de targets, el
+ *          caché de texturas) los enlaza para configurarlos. Con estas guardas
+ *          deja el enlace anterior tal como estaba en lugar de dejar 0, así el
+ *          estado que recuerdan MaterialBinder o RenderGraph sigue siendo cierto.
+ */
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+/**
+ * @class ScopedTextureBinding
+ * @brief Recuerda la textura de un destino en la unidad activa y la vuelve a enlazar al destruirse
+ * @note No cambia la unidad activa: lo que se enlace dentro va a esa misma unidad.
+ */
+class ScopedTextureBinding
+{
+public:
+    /// @param target GL_TEXTURE_2D o GL_TEXTURE_2D_ARRAY
+    explicit ScopedTextureBinding(GLenum target = GL_TEXTURE_2D) : target(target)
+    {
+        GLint current = 0;
+        glGetIntegerv(target == GL_TEXTURE_2D_ARRAY ? GL_TEXTURE_BINDING_2D_ARRAY : GL_TEXTURE_BINDING_2D, &current);
+        previous = (GLuint)current;
+    }
+
+    ~ScopedTextureBinding() { glBindTexture(target, previous); }
+
+    ScopedTextureBinding(const ScopedTextureBinding&) = delete;
+    ScopedTextureBinding& operator=(const ScopedTextureBinding&) = delete;
+
+private:
+    GLenum target;
+    GLuint previous;
+};
+
+/**
+ * @class ScopedFramebufferBinding
+ * @brief Recuerda los framebuffers de dibujo y de lectura y los restaura al destruirse
+ */
+class ScopedFramebufferBinding
+{
+public:
+    ScopedFramebufferBinding()
+    {
+        GLint draw = 0, read = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &draw);
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &read);
+        previousDraw = (GLuint)draw;
+        previousRead = (GLuint)read;
+    }
+
+    ~ScopedFramebufferBinding()
+    {
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousDraw);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, previousRead);
+    }
+
+    ScopedFramebufferBinding(const ScopedFramebufferBinding&) = delete;
+    ScopedFramebufferBinding& operator=(const ScopedFramebufferBinding&) = delete;
+
+private:
+    GLuint previousDraw;
+    GLuint previousRead;
+};
+
+#endif
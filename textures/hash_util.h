@@ -0,0 +1,70 @@
+/**
+ * @file hash_util.h
+ * @brief Funciones de hash no criptográficas para deduplicar recursos
+ */
+#ifndef HASH_UTIL_H
+#define HASH_UTIL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Hash FNV-1a de 64 bits
+ * @param data Bytes a mezclar
+ * @param size Cantidad de bytes
+ * @param seed Valor inicial (permite encadenar varios bloques)
+ * @note Procesa byte a byte: adecuado para textos cortos (código, rutas)
+ */
+inline uint64_t fnv1a64(const void* data, size_t size, uint64_t seed = 14695981039346656037ull)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief Mezcla final de 64 bits (finalizador de MurmurHash3)
+ */
+inline uint64_t mix64(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdull;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ull;
+    value ^= value >> 33;
+    return value;
+}
+
+/**
+ * @brief Hash de 64 bits para bloques grandes (píxeles, archivos)
+ * @details Consume 32 bytes por iteración en cuatro carriles independientes, por
+ *          lo que es varias veces más rápido que FNV-1a sobre megabytes de datos.
+ */
+inline uint64_t hashContent64(const void* data, size_t size, uint64_t seed = 0)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    const uint64_t prime = 0x9e3779b97f4a7c15ull;
+    uint64_t lanes[4] = { seed + prime, seed ^ 0x2545f4914f6cdd1dull, seed - prime, ~seed };
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        for (int lane = 0; lane < 4; lane++)
+        {
+            uint64_t word;
+            memcpy(&word, bytes + i + lane * 8, 8);
+            lanes[lane] = (lanes[lane] ^ mix64(word)) * prime;
+            lanes[lane] = (lanes[lane] << 31) | (lanes[lane] >> 33);
+        }
+    }
+    uint64_t hash = mix64(lanes[0]) ^ mix64(lanes[1] + 1) ^ mix64(lanes[2] + 2) ^ mix64(lanes[3] + 3);
+    hash = fnv1a64(bytes + i, size - i, hash);
+    return mix64(hash ^ size);
+}
+
+#endif
@@ -0,0 +1,130 @@
+/**
+ * @file image_decode.h
+ * @brief Cadena de backends de decodificación de imágenes
+ * @details decodeImage prueba los backends registrados en orden; el primero que
+ *          no decline la imagen la decodifica. Por defecto la cadena es el JPEG
+ *          propio, que solo toma las imágenes grandes que reparte entre hilos (si
+ *          hay más de un núcleo), el PNG SIMD y stb_image, que lo acepta todo y
+ *          queda siempre como respaldo.
+ *
+ *          decodeImageInto es la variante que escribe en memoria del que llama:
+ *          primero imageInfo para dimensionar el destino y después la decodificación.
+ */
+#ifndef IMAGE_DECODE_H
+#define IMAGE_DECODE_H
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "stb_image.h"
+#include "image_decoder.h"
+#include "jpeg_decoder.h"
+#include "png_decoder.h"
+
+/**
+ * @class StbImageDecoder
+ * @brief Backend de respaldo: stbi_load_from_memory
+ */
+class StbImageDecoder : public ImageDecoder
+{
+public:
+    const char* name() const override { return "stb_image"; }
+
+    ImageDecodeStatus decode(const unsigned char* data, size_t size, unsigned char** pixels,
+                             int* width, int* height, int* channels, int desiredChannels) const override
+    {
+        if (size > 0x7FFFFFFF)
+            return ImageDecodeStatus::Unsupported;
+        unsigned char* result = stbi_load_from_memory(data, (int)size, width, height, channels, desiredChannels);
+        if (!result)
+            return ImageDecodeStatus::Failed;
+        *pixels = result;
+        return ImageDecodeStatus::Decoded;
+    }
+
+};
+
+typedef std::vector<std::shared_ptr<const ImageDecoder>> ImageDecoderChain;
+
+/// Cadena por defecto (ver el encabezado del archivo)
+inline ImageDecoderChain defaultImageDecoders()
+{
+    ImageDecoderChain chain;
+    // el JPEG propio declina todo lo que no puede repartir: en un núcleo no aporta
+    if (std::thread::hardware_concurrency() > 1)
+        chain.push_back(std::make_shared<JpegDecoder>());
+    chain.push_back(std::make_shared<PngDecoder>());
+    chain.push_back(std::make_shared<StbImageDecoder>());
+    return chain;
+}
+
+/// Cadena activa; se cambia al iniciar, antes de que haya decodificaciones en curso
+inline ImageDecoderChain& imageDecoders()
+{
+    static ImageDecoderChain chain = defaultImageDecoders();
+    return chain;
+}
+
+/**
+ * @brief Reemplaza la cadena de backends
+ * @details Si la cadena no termina en stb_image se agrega al final, para que
+ *          ninguna imagen se quede sin decodificar por falta de backend.
+ */
+inline void setImageDecoders(ImageDecoderChain chain)
+{
+    if (chain.empty() || !dynamic_cast<const StbImageDecoder*>(chain.back().get()))
+        chain.push_back(std::make_shared<StbImageDecoder>());
+    imageDecoders() = chain;
+}
+
+/**
+ * @brief Decodifica con la cadena dada; misma firma y resultado que stbi_load_from_memory
+ * @return Píxeles a liberar con stbi_image_free, o NULL si ningún backend pudo
+ */
+inline unsigned char* decodeImageWith(const ImageDecoderChain& chain, const unsigned char* data, size_t size,
+                                      int* width, int* height, int* channels, int desiredChannels = 0)
+{
+    for (const std::shared_ptr<const ImageDecoder>& decoder : chain)
+    {
+        unsigned char* pixels = nullptr;
+        ImageDecodeStatus status = decoder->decode(data, size, &pixels, width, height, channels, desiredChannels);
+        // Failed también sigue: stb_image tolera archivos truncados que los otros rechazan
+        if (status == ImageDecodeStatus::Decoded)
+            return pixels;
+    }
+    return NULL;
+}
+
+/// Decodifica con la cadena activa
+inline unsigned char* decodeImage(const unsigned char* data, size_t size, int* width, int* height, int* channels,
+                                  int desiredChannels = 0)
+{
+    return decodeImageWith(imageDecoders(), data, size, width, height, channels, desiredChannels);
+}
+
+/**
+ * @brief Dimensiones y canales de una imagen sin decodificarla (solo la cabecera)
+ */
+inline bool imageInfo(const unsigned char* data, size_t size, int* width, int* height, int* channels)
+{
+    return size <= 0x7FFFFFFF && stbi_info_from_memory(data, (int)size, width, height, channels) != 0;
+}
+
+/**
+ * @brief Decodifica con la cadena activa directo en el destino
+ * @return false si ningún backend pudo o las dimensiones no coinciden
+ */
+inline bool decodeImageInto(const unsigned char* data, size_t size, const ImageDecodeTarget& target)
+{
+    if (!target.pixels || target.width <= 0 || target.height <= 0 || target.stride() < target.rowBytes())
+        return false;
+    for (const std::shared_ptr<const ImageDecoder>& decoder : imageDecoders())
+    {
+        if (decoder->decodeInto(data, size, target) == ImageDecodeStatus::Decoded)
+            return true;
+    }
+    return false;
+}
+
+#endif
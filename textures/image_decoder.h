@@ -0,0 +1,224 @@
+/**
+ * @file image_decoder.h
+ * @brief Interfaz de los backends de decodificación de imágenes
+ * @details Cada backend decodifica desde memoria y entrega píxeles de 8 bits en
+ *          el mismo formato que stb_image (filas de arriba hacia abajo, canales
+ *          intercalados), en memoria que se libera con stbi_image_free (ambos usan
+ *          el pool de image_memory.h). Un backend
+ *          puede declinar una imagen (ImageDecodeStatus::Unsupported) para que la
+ *          intente el siguiente; stb_image es siempre el último (image_decode.h).
+ *
+ *          decodeInto escribe en un destino ajeno (un PBO mapeado, una página de
+ *          atlas, un búfer de staging reutilizado) con el formato y el paso de fila
+ *          que pida quien llama, sin la reserva ni la copia intermedias.
+ */
+#ifndef IMAGE_DECODER_H
+#define IMAGE_DECODER_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#include "image_memory.h"
+
+/**
+ * @enum ImageDecodeStatus
+ * @brief Resultado de un backend
+ */
+enum class ImageDecodeStatus
+{
+    Decoded,     ///< Píxeles listos
+    Unsupported, ///< Formato o variante que este backend no maneja: probar el siguiente
+    Failed       ///< Datos corruptos o sin memoria
+};
+
+/**
+ * @brief Reserva memoria para píxeles con el mismo asignador que stb_image
+ * @details Ambos pasan por el pool del hilo (STBI_MALLOC en image_memory.h).
+ */
+inline unsigned char* allocateImagePixels(size_t bytes)
+{
+    return (unsigned char*)imagePoolAllocate(bytes);
+}
+
+/// Libera píxeles de allocateImagePixels o de stb_image (equivale a stbi_image_free)
+inline void freeImagePixels(void* pixels)
+{
+    imagePoolFree(pixels);
+}
+
+/**
+ * @enum ImagePixelFormat
+ * @brief Formato de destino de decodeInto: 8 bits por canal
+ * @details Las variantes sRGB tienen los mismos bytes que RGB8/RGBA8; solo
+ *          cambian el formato interno con que se sube la textura.
+ */
+enum class ImagePixelFormat
+{
+    R8,
+    RG8,
+    RGB8,
+    RGBA8,
+    SRGB8,
+    SRGB8_ALPHA8
+};
+
+/// Canales por píxel del formato
+inline int imagePixelFormatChannels(ImagePixelFormat format)
+{
+    switch (format)
+    {
+        case ImagePixelFormat::R8: return 1;
+        case ImagePixelFormat::RG8: return 2;
+        case ImagePixelFormat::RGB8:
+        case ImagePixelFormat::SRGB8: return 3;
+        default: return 4;
+    }
+}
+
+/// Formato lineal de 1-4 canales
+inline ImagePixelFormat imagePixelFormatForChannels(int channels)
+{
+    switch (channels)
+    {
+        case 1: return ImagePixelFormat::R8;
+        case 2: return ImagePixelFormat::RG8;
+        case 3: return ImagePixelFormat::RGB8;
+        default: return ImagePixelFormat::RGBA8;
+    }
+}
+
+/// true si los colores del formato están codificados en sRGB
+inline bool imagePixelFormatIsSrgb(ImagePixelFormat format)
+{
+    return format == ImagePixelFormat::SRGB8 || format == ImagePixelFormat::SRGB8_ALPHA8;
+}
+
+/**
+ * @struct ImageDecodeTarget
+ * @brief Memoria donde decodeInto escribe la imagen
+ * @details width y height deben ser los de la imagen (imageInfo); si no
+ *          coinciden la decodificación falla sin escribir nada.
+ */
+struct ImageDecodeTarget
+{
+    ImagePixelFormat format = ImagePixelFormat::RGBA8;
+    unsigned char* pixels = nullptr;
+    size_t rowStride = 0; ///< Bytes entre filas; 0 = filas contiguas
+    int width = 0;
+    int height = 0;
+
+    size_t rowBytes() const { return (size_t)width * imagePixelFormatChannels(format); }
+    size_t stride() const { return rowStride ? rowStride : rowBytes(); }
+};
+
+/**
+ * @brief Copia filas entre búferes con distinto paso de fila
+ */
+inline void copyImageRows(const unsigned char* source, size_t sourceStride, unsigned char* target, size_t targetStride,
+                          size_t rowBytes, int rows)
+{
+    for (int y = 0; y < rows; y++)
+        memcpy(target + y * targetStride, source + y * sourceStride, rowBytes);
+}
+
+/**
+ * @class ImageDecoder
+ * @brief Backend de decodificación
+ */
+class ImageDecoder
+{
+public:
+    virtual ~ImageDecoder() {}
+
+    /// Nombre para logs y benchmarks
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief Decodifica una imagen completa
+     * @param data Archivo en memoria
+     * @param size Bytes del archivo
+     * @param pixels Recibe los píxeles (liberar con stbi_image_free) si retorna Decoded
+     * @param desiredChannels 0 = los de la imagen; 1-4 convierte como stb_image
+     * @details width, height y channels (los de la imagen, no los pedidos) se
+     *          escriben solo si retorna Decoded.
+     */
+    virtual ImageDecodeStatus decode(const unsigned char* data, size_t size, unsigned char** pixels,
+                                     int* width, int* height, int* channels, int desiredChannels) const = 0;
+
+    /**
+     * @brief Decodifica directo en la memoria del destino
+     * @details La implementación por defecto decodifica a un búfer propio y copia
+     *          las filas; los backends que pueden escribir en el destino la redefinen.
+     */
+    virtual ImageDecodeStatus decodeInto(const unsigned char* data, size_t size, const ImageDecodeTarget& target) const
+    {
+        unsigned char* pixels = nullptr;
+        int width, height, channels;
+        int targetChannels = imagePixelFormatChannels(target.format);
+        ImageDecodeStatus status = decode(data, size, &pixels, &width, &height, &channels, targetChannels);
+        if (status != ImageDecodeStatus::Decoded)
+            return status;
+        if (width == target.width && height == target.height)
+            copyImageRows(pixels, target.rowBytes(), target.pixels, target.stride(), target.rowBytes(), height);
+        else
+            status = ImageDecodeStatus::Failed;
+        freeImagePixels(pixels);
+        return status;
+    }
+};
+
+/// Luminancia con los pesos enteros de stb_image
+inline unsigned char imageLuminance(unsigned char r, unsigned char g, unsigned char b)
+{
+    return (unsigned char)((r * 77 + g * 150 + 29 * b) >> 8);
+}
+
+/**
+ * @brief Convierte entre 1-4 canales como stbi__convert_format
+ * @details Gris se replica a RGB, RGB se reduce a luminancia y el alfa que falta
+ *          vale 255. Sirve para que todos los backends entreguen lo mismo que stb.
+ */
+inline void convertImageChannels(const unsigned char* source, int sourceChannels, unsigned char* target,
+                                 int targetChannels, size_t pixelCount)
+{
+    for (size_t i = 0; i < pixelCount; i++, source += sourceChannels, target += targetChannels)
+    {
+        unsigned char r, g, b, a;
+        if (sourceChannels <= 2)
+        {
+            r = g = b = source[0];
+            a = sourceChannels == 2 ? source[1] : 255;
+        }
+        else
+        {
+            r = source[0];
+            g = source[1];
+            b = source[2];
+            a = sourceChannels == 4 ? source[3] : 255;
+        }
+        switch (targetChannels)
+        {
+            case 1:
+                target[0] = sourceChannels <= 2 ? r : imageLuminance(r, g, b);
+                break;
+            case 2:
+                target[0] = sourceChannels <= 2 ? r : imageLuminance(r, g, b);
+                target[1] = a;
+                break;
+            case 3:
+                target[0] = r;
+                target[1] = g;
+                target[2] = b;
+                break;
+            default:
+                target[0] = r;
+                target[1] = g;
+                target[2] = b;
+                target[3] = a;
+                break;
+        }
+    }
+}
+
+#endif
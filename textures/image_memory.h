@@ -0,0 +1,355 @@
+/**
+ * @file image_memory.h
+ * @brief Pool de memoria por hilo para los píxeles y el scratch de decodificación
+ * @details stb_image y los backends propios reservan y liberan un búfer por
+ *          imagen; al cargar miles de texturas eso fragmenta el heap y dispara el
+ *          RSS. Este pool redondea cada pedido a una clase de tamaño (cuatro por
+ *          potencia de dos, de 256 B a 64 MiB) y guarda los bloques liberados en
+ *          una caché del hilo, sin locks: un hilo que decodifica imagen tras imagen
+ *          reutiliza siempre los mismos bloques. Los pedidos más grandes van
+ *          directo a malloc.
+ *
+ *          Un bloque puede liberarse desde otro hilo: queda en la caché del hilo
+ *          que lo libera. Cada caché tiene un tope (setImagePoolCacheLimit); lo que
+ *          lo supera vuelve al sistema, igual que la caché entera al terminar el hilo.
+ *
+ *          Los macros STBI_MALLOC/STBI_REALLOC/STBI_FREE apuntan al pool (con los
+ *          bloques en cero, ver imagePoolAllocateZeroed), así que el
+ *          .cpp que define STB_IMAGE_IMPLEMENTATION debe incluir este header antes
+ *          que stb_image.h; allocateImagePixels/freeImagePixels (image_decoder.h)
+ *          usan el mismo pool.
+ */
+#ifndef IMAGE_MEMORY_H
+#define IMAGE_MEMORY_H
+
+#if defined(STB_IMAGE_IMPLEMENTATION) && defined(STBI_INCLUDE_STB_IMAGE_H) && !defined(STBI_MALLOC)
+#error "image_memory.h debe incluirse antes que la implementación de stb_image.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+const int IMAGE_POOL_MIN_SHIFT = 8;  ///< Clase menor: 256 B
+const int IMAGE_POOL_MAX_SHIFT = 26; ///< Clase mayor: 64 MiB
+const int IMAGE_POOL_CLASSES = (IMAGE_POOL_MAX_SHIFT - IMAGE_POOL_MIN_SHIFT) * 4 + 1;
+const uint32_t IMAGE_POOL_LARGE = 0xFFFFFFFFu; ///< Clase de los bloques que no pasan por el pool
+
+/**
+ * @struct ImagePoolStats
+ * @brief Contadores sumados de todos los hilos (los que ya terminaron incluidos)
+ */
+struct ImagePoolStats
+{
+    uint64_t allocations = 0;       ///< Pedidos (malloc y realloc que no cupieron en el bloque)
+    uint64_t poolHits = 0;          ///< Pedidos servidos desde la caché del hilo
+    uint64_t systemAllocations = 0; ///< Llamadas reales a malloc
+    uint64_t systemReleases = 0;    ///< Bloques devueltos a free (tope, trim o fin del hilo)
+    int64_t bytesInUse = 0;         ///< Capacidad de los bloques entregados y aún no liberados
+    int64_t bytesCached = 0;        ///< Capacidad de los bloques esperando en las cachés
+    int threads = 0;                ///< Hilos con caché viva
+
+    double hitRate() const { return allocations ? (double)poolHits / allocations : 0.0; }
+};
+
+/// Cabecera delante de cada bloque; mantiene la alineación de malloc
+struct alignas(alignof(std::max_align_t)) ImagePoolHeader
+{
+    uint32_t sizeClass; ///< Índice de clase o IMAGE_POOL_LARGE
+    size_t size;        ///< Bytes pedidos (para copiar en realloc)
+};
+
+/// Tamaño de la clase sizeClass
+inline size_t imagePoolClassSize(int sizeClass)
+{
+    int shift = IMAGE_POOL_MIN_SHIFT + sizeClass / 4;
+    return ((size_t)(4 + sizeClass % 4) << shift) >> 2;
+}
+
+/// Menor clase donde caben size bytes, o -1 si supera la clase mayor
+inline int imagePoolClassFor(size_t size)
+{
+    if (size <= ((size_t)1 << IMAGE_POOL_MIN_SHIFT))
+        return 0;
+    if (size > ((size_t)1 << IMAGE_POOL_MAX_SHIFT))
+        return -1;
+    int shift = IMAGE_POOL_MIN_SHIFT;
+    while (((size_t)2 << shift) < size)
+        shift++;
+    // size está en (2^shift, 2^(shift+1)]: cuartos de 2^shift
+    size_t step = (size_t)1 << (shift - 2);
+    int quarter = (int)((size + step - 1) / step) - 4; // 1..4
+    return (shift - IMAGE_POOL_MIN_SHIFT) * 4 + quarter;
+}
+
+/**
+ * @struct ImagePoolCounters
+ * @brief Contadores de un hilo
+ * @details Solo los escribe el hilo dueño (load + store, sin RMW compartido);
+ *          imagePoolStats los lee desde cualquier hilo.
+ */
+struct ImagePoolCounters
+{
+    std::atomic<uint64_t> allocations{ 0 };
+    std::atomic<uint64_t> poolHits{ 0 };
+    std::atomic<uint64_t> systemAllocations{ 0 };
+    std::atomic<uint64_t> systemReleases{ 0 };
+    std::atomic<int64_t> bytesInUse{ 0 };
+    std::atomic<int64_t> bytesCached{ 0 };
+
+    template <typename T>
+    static void add(std::atomic<T>& counter, T amount)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    void addTo(ImagePoolStats& stats) const
+    {
+        stats.allocations += allocations.load(std::memory_order_relaxed);
+        stats.poolHits += poolHits.load(std::memory_order_relaxed);
+        stats.systemAllocations += systemAllocations.load(std::memory_order_relaxed);
+        stats.systemReleases += systemReleases.load(std::memory_order_relaxed);
+        stats.bytesInUse += bytesInUse.load(std::memory_order_relaxed);
+        stats.bytesCached += bytesCached.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @struct ImagePoolRegistry
+ * @brief Cachés vivas y totales de los hilos terminados
+ * @details El mutex solo se toma al crear o destruir una caché y en imagePoolStats.
+ */
+struct ImagePoolRegistry
+{
+    std::mutex mutex;
+    std::vector<const ImagePoolCounters*> threads;
+    ImagePoolStats retired;
+    std::atomic<size_t> cacheLimit{ (size_t)64 << 20 };
+};
+
+/// Registro global; no se destruye para que los hilos que terminen tarde puedan usarlo
+inline ImagePoolRegistry& imagePoolRegistry()
+{
+    static ImagePoolRegistry* registry = new ImagePoolRegistry();
+    return *registry;
+}
+
+/**
+ * @class ImagePoolCache
+ * @brief Bloques libres de un hilo, una pila por clase
+ */
+class ImagePoolCache
+{
+public:
+    ImagePoolCache()
+    {
+        ImagePoolRegistry& registry = imagePoolRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.threads.push_back(&counters);
+    }
+
+    ~ImagePoolCache()
+    {
+        trim();
+        destroyed() = true;
+        ImagePoolRegistry& registry = imagePoolRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        counters.addTo(registry.retired);
+        registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), &counters));
+    }
+
+    /// Caché del hilo actual; nullptr si ya se destruyó (liberaciones durante la salida del hilo)
+    static ImagePoolCache* current()
+    {
+        if (destroyed())
+            return nullptr;
+        thread_local ImagePoolCache cache;
+        return &cache;
+    }
+
+    void* allocate(size_t size)
+    {
+        ImagePoolCounters::add<uint64_t>(counters.allocations, 1);
+        int sizeClass = imagePoolClassFor(size);
+        size_t capacity = sizeClass >= 0 ? imagePoolClassSize(sizeClass) : size;
+        ImagePoolHeader* header;
+        if (sizeClass >= 0 && !blocks[sizeClass].empty())
+        {
+            header = (ImagePoolHeader*)blocks[sizeClass].back();
+            blocks[sizeClass].pop_back();
+            ImagePoolCounters::add<uint64_t>(counters.poolHits, 1);
+            ImagePoolCounters::add<int64_t>(counters.bytesCached, -(int64_t)capacity);
+        }
+        else
+        {
+            header = (ImagePoolHeader*)malloc(sizeof(ImagePoolHeader) + capacity);
+            if (!header)
+                return nullptr;
+            ImagePoolCounters::add<uint64_t>(counters.systemAllocations, 1);
+        }
+        header->sizeClass = sizeClass >= 0 ? (uint32_t)sizeClass : IMAGE_POOL_LARGE;
+        header->size = size;
+        ImagePoolCounters::add<int64_t>(counters.bytesInUse, (int64_t)capacity);
+        return header + 1;
+    }
+
+    void release(ImagePoolHeader* header)
+    {
+        bool large = header->sizeClass == IMAGE_POOL_LARGE;
+        size_t capacity = large ? header->size : imagePoolClassSize(header->sizeClass);
+        ImagePoolCounters::add<int64_t>(counters.bytesInUse, -(int64_t)capacity);
+        size_t limit = imagePoolRegistry().cacheLimit.load(std::memory_order_relaxed);
+        if (large || (size_t)counters.bytesCached.load(std::memory_order_relaxed) + capacity > limit)
+        {
+            free(header);
+            ImagePoolCounters::add<uint64_t>(counters.systemReleases, 1);
+            return;
+        }
+        blocks[header->sizeClass].push_back(header);
+        ImagePoolCounters::add<int64_t>(counters.bytesCached, (int64_t)capacity);
+    }
+
+    /// Devuelve al sistema todos los bloques libres del hilo
+    void trim()
+    {
+        for (int sizeClass = 0; sizeClass < IMAGE_POOL_CLASSES; sizeClass++)
+        {
+            for (void* block : blocks[sizeClass])
+                free(block);
+            ImagePoolCounters::add<uint64_t>(counters.systemReleases, blocks[sizeClass].size());
+            ImagePoolCounters::add<int64_t>(counters.bytesCached,
+                                            -(int64_t)(blocks[sizeClass].size() * imagePoolClassSize(sizeClass)));
+            blocks[sizeClass].clear();
+            blocks[sizeClass].shrink_to_fit();
+        }
+    }
+
+    ImagePoolCounters counters;
+
+private:
+    static bool& destroyed()
+    {
+        thread_local bool value = false;
+        return value;
+    }
+
+    std::vector<void*> blocks[IMAGE_POOL_CLASSES];
+};
+
+/**
+ * @brief malloc del pool
+ */
+inline void* imagePoolAllocate(size_t size)
+{
+    if (ImagePoolCache* cache = ImagePoolCache::current())
+        return cache->allocate(size);
+    // el hilo está terminando: bloque suelto, que free reconoce por la clase
+    ImagePoolHeader* header = (ImagePoolHeader*)malloc(sizeof(ImagePoolHeader) + size);
+    if (!header)
+        return nullptr;
+    header->sizeClass = IMAGE_POOL_LARGE;
+    header->size = size;
+    return header + 1;
+}
+
+/**
+ * @brief free del pool; acepta nullptr
+ */
+inline void imagePoolFree(void* pointer)
+{
+    if (!pointer)
+        return;
+    ImagePoolHeader* header = (ImagePoolHeader*)pointer - 1;
+    if (ImagePoolCache* cache = ImagePoolCache::current())
+        cache->release(header);
+    else
+        free(header);
+}
+
+/**
+ * @brief realloc del pool
+ * @details Si el tamaño nuevo cabe en la clase del bloque lo devuelve tal cual;
+ *          si no, reserva otro bloque y copia. Como realloc, si falla deja el
+ *          bloque original intacto y retorna nullptr.
+ */
+inline void* imagePoolReallocate(void* pointer, size_t size)
+{
+    if (!pointer)
+        return imagePoolAllocate(size);
+    ImagePoolHeader* header = (ImagePoolHeader*)pointer - 1;
+    if (header->sizeClass != IMAGE_POOL_LARGE && size <= imagePoolClassSize(header->sizeClass))
+    {
+        header->size = size;
+        return pointer;
+    }
+    void* result = imagePoolAllocate(size);
+    if (!result)
+        return nullptr;
+    memcpy(result, pointer, std::min(header->size, size));
+    imagePoolFree(pointer);
+    return result;
+}
+
+/**
+ * @brief Como imagePoolAllocate, con el bloque en cero (calloc)
+ * @details Es el que usa stb_image: con datos truncados deja sin escribir parte
+ *          de sus búferes (coeficientes, filas de salida) y, al reutilizarse los
+ *          bloques, eso mostraría píxeles de imágenes anteriores. Con ceros el
+ *          resultado es el mismo en cada corrida. Los backends propios escriben
+ *          toda su salida y usan la versión sin limpiar.
+ */
+inline void* imagePoolAllocateZeroed(size_t size)
+{
+    void* pointer = imagePoolAllocate(size);
+    if (pointer)
+        memset(pointer, 0, size);
+    return pointer;
+}
+
+/// Como imagePoolReallocate, con los bytes que crecen en cero
+inline void* imagePoolReallocateZeroed(void* pointer, size_t size)
+{
+    size_t previous = pointer ? ((ImagePoolHeader*)pointer - 1)->size : 0;
+    void* result = imagePoolReallocate(pointer, size);
+    if (result && size > previous)
+        memset((unsigned char*)result + previous, 0, size - previous);
+    return result;
+}
+
+/// Devuelve al sistema la caché del hilo actual (p. ej. al terminar una carga masiva)
+inline void imagePoolTrim()
+{
+    if (ImagePoolCache* cache = ImagePoolCache::current())
+        cache->trim();
+}
+
+/// Tope de bytes libres que guarda cada hilo; lo que sobra se libera al momento
+inline void setImagePoolCacheLimit(size_t bytes)
+{
+    imagePoolRegistry().cacheLimit.store(bytes, std::memory_order_relaxed);
+}
+
+/// Estadísticas de todos los hilos
+inline ImagePoolStats imagePoolStats()
+{
+    ImagePoolRegistry& registry = imagePoolRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    ImagePoolStats stats = registry.retired;
+    for (const ImagePoolCounters* counters : registry.threads)
+        counters->addTo(stats);
+    stats.threads = (int)registry.threads.size();
+    return stats;
+}
+
+#ifndef STBI_MALLOC
+#define STBI_MALLOC(size) imagePoolAllocateZeroed(size)
+#define STBI_REALLOC(pointer, size) imagePoolReallocateZeroed(pointer, size)
+#define STBI_FREE(pointer) imagePoolFree(pointer)
+#endif
+
+#endif
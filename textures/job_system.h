@@ -0,0 +1,204 @@
+/**
+ * @file job_system.h
+ * @brief Pool de hilos para repartir trabajo de CPU en trozos
+ * @details parallelFor divide un rango en trozos que los hilos del pool toman de
+ *          un contador atómico; el hilo que llama también trabaja, así que un
+ *          parallelFor anidado (lanzado desde un trabajo) no puede bloquear el pool.
+ *          submit() encola tareas sueltas (p.ej. decodificar una imagen) que corren
+ *          en los mismos hilos, así hay un solo pool para todo el trabajo de CPU.
+ */
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class JobSystem
+ * @brief Hilos trabajadores y una cola de tareas compartida
+ */
+class JobSystem
+{
+public:
+    /**
+     * @param threads Hilos trabajadores; 0 usa uno menos que los núcleos disponibles
+     */
+    explicit JobSystem(unsigned int threads = 0) : running(true)
+    {
+        if (threads == 0)
+        {
+            unsigned int cores = std::thread::hardware_concurrency();
+            threads = cores > 1 ? cores - 1 : 0;
+        }
+        for (unsigned int i = 0; i < threads; i++)
+            workers.emplace_back(&JobSystem::workerLoop, this);
+    }
+
+    ~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /// Hilos trabajadores (sin contar al que llama a parallelFor)
+    unsigned int workerCount() const { return (unsigned int)workers.size(); }
+
+    /**
+     * @brief Ejecuta body sobre [0, count) en trozos de hasta grain elementos
+     * @param count Elementos del rango
+     * @param grain Elementos por trozo (al menos 1)
+     * @param body Recibe [begin, end) de cada trozo; debe ser seguro en paralelo
+     * @details Retorna cuando todos los trozos terminaron.
+     */
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body)
+    {
+        if (count == 0)
+            return;
+        grain = std::max<size_t>(1, grain);
+        size_t chunks = (count + grain - 1) / grain;
+        if (chunks == 1 || workers.empty())
+        {
+            body(0, count);
+            return;
+        }
+
+        std::shared_ptr<ParallelRange> range = std::make_shared<ParallelRange>();
+        range->count = count;
+        range->grain = grain;
+        range->chunks = chunks;
+        range->body = &body;
+        range->pending = chunks;
+        size_t helpers = std::min<size_t>(workers.size(), chunks - 1);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = 0; i < helpers; i++)
+                tasks.push_back([range]() { runChunks(*range); });
+        }
+        if (helpers == 1)
+            wake.notify_one();
+        else
+            wake.notify_all();
+
+        runChunks(*range);
+        std::unique_lock<std::mutex> lock(range->mutex);
+        range->done.wait(lock, [&range]() { return range->pending == 0; });
+    }
+
+    /**
+     * @brief Encola una tarea para algún hilo del pool y retorna sin esperarla
+     * @details Sin hilos trabajadores la tarea queda en la cola hasta que alguien
+     *          llame a runPending().
+     */
+    void submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        wake.notify_one();
+    }
+
+    /**
+     * @brief Ejecuta en el hilo que llama una tarea encolada, si hay alguna
+     * @return false si la cola estaba vacía
+     */
+    bool runPending()
+    {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tasks.empty())
+                return false;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+        return true;
+    }
+
+private:
+    /**
+     * @struct ParallelRange
+     * @brief Estado compartido de un parallelFor
+     * @details Vive en un shared_ptr: una tarea auxiliar puede empezar después de
+     *          que todos los trozos terminaron y solo encontrará el contador agotado.
+     */
+    struct ParallelRange
+    {
+        size_t count = 0;
+        size_t grain = 1;
+        size_t chunks = 0;
+        const std::function<void(size_t, size_t)>* body = nullptr;
+        std::atomic<size_t> next{ 0 };
+        size_t pending = 0; ///< Trozos sin terminar, protegido por mutex
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool running;
+
+    static void runChunks(ParallelRange& range)
+    {
+        size_t finished = 0;
+        for (size_t chunk = range.next++; chunk < range.chunks; chunk = range.next++)
+        {
+            size_t begin = chunk * range.grain;
+            (*range.body)(begin, std::min(range.count, begin + range.grain));
+            finished++;
+        }
+        if (finished == 0)
+            return;
+        std::lock_guard<std::mutex> lock(range.mutex);
+        range.pending -= finished;
+        if (range.pending == 0)
+            range.done.notify_all();
+    }
+
+    void workerLoop()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return !running || !tasks.empty(); });
+                if (!running && tasks.empty())
+                    return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+/**
+ * @brief Pool compartido por los sistemas que reparten trabajo de CPU
+ */
+inline JobSystem& defaultJobSystem()
+{
+    static JobSystem jobs;
+    return jobs;
+}
+
+#endif
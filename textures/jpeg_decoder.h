@@ -0,0 +1,1078 @@
+/**
+ * @file jpeg_decoder.h
+ * @brief Decodificador JPEG baseline que reparte los intervalos de reinicio entre hilos
+ * @details Decodifica JPEG secuenciales (SOF0/SOF1, Huffman, 8 bits) de 1 o 3
+ *          componentes con submuestreo 1x o 2x por eje. La IDCT entera es la de
+ *          jidctint (la misma que stb_image) y el sobremuestreo y la conversión
+ *          YCbCr -> RGB replican los de stb_image, así que el resultado es
+ *          idéntico bit a bit.
+ *
+ *          Solo toma lo que puede repartir en defaultJobSystem(): imágenes de al
+ *          menos JPEG_PARALLEL_MIN_PIXELS con intervalos de reinicio (DRI/RSTn).
+ *          Los intervalos son independientes, así que se localizan los marcadores
+ *          con una pasada rápida y cada hilo decodifica (Huffman + IDCT) los suyos;
+ *          después el sobremuestreo y la conversión de color se hacen en bandas de
+ *          filas. En un solo hilo stb_image es igual de rápido, así que lo demás
+ *          (imágenes chicas, sin reinicios, progresivos, CMYK, submuestreos raros)
+ *          se declina (Unsupported), y los datos truncados o con marcadores de
+ *          reinicio que no cuadran fallan: en ambos casos los decodifica stb_image.
+ */
+#ifndef JPEG_DECODER_H
+#define JPEG_DECODER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "image_decoder.h"
+#include "job_system.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define JPEG_SSE2 1
+#endif
+
+/// Orden zigzag -> natural, con 15 entradas de margen para corridas que se pasan de 63
+static const unsigned char JPEG_DEZIGZAG[64 + 15] =
+{
+     0,  1,  8, 16,  9,  2,  3, 10,
+    17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34,
+    27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36,
+    29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46,
+    53, 60, 61, 54, 47, 55, 62, 63,
+    63, 63, 63, 63, 63, 63, 63, 63,
+    63, 63, 63, 63, 63, 63, 63
+};
+
+/// Bits de la tabla rápida de Huffman
+static const int JPEG_FAST_BITS = 9;
+
+/// Píxeles desde los que conviene repartir la decodificación entre hilos
+static const size_t JPEG_PARALLEL_MIN_PIXELS = (size_t)1 << 21;
+
+/**
+ * @struct JpegHuffman
+ * @brief Tabla de Huffman con búsqueda rápida de JPEG_FAST_BITS bits
+ */
+struct JpegHuffman
+{
+    uint8_t fast[1 << JPEG_FAST_BITS];
+    int16_t fastAc[1 << JPEG_FAST_BITS]; ///< Corrida, longitud y valor juntos (solo AC)
+    uint16_t code[256];
+    uint8_t values[256];
+    uint8_t size[257];
+    uint32_t maxcode[18];
+    int delta[17];
+
+    /**
+     * @brief Construye la tabla desde las 16 cantidades de códigos por longitud
+     * @return false si las cantidades no forman un código válido
+     */
+    bool build(const uint8_t counts[16])
+    {
+        int k = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            for (int j = 0; j < counts[i]; j++)
+            {
+                if (k >= 256)
+                    return false;
+                size[k++] = (uint8_t)(i + 1);
+            }
+        }
+        size[k] = 0;
+
+        unsigned int next = 0;
+        k = 0;
+        for (int length = 1; length <= 16; length++)
+        {
+            delta[length] = k - (int)next;
+            if (size[k] == length)
+            {
+                while (size[k] == length)
+                    code[k++] = (uint16_t)next++;
+                if (next - 1 >= (1u << length))
+                    return false;
+            }
+            maxcode[length] = next << (16 - length);
+            next <<= 1;
+        }
+        maxcode[17] = 0xFFFFFFFFu;
+
+        memset(fast, 255, sizeof(fast));
+        for (int i = 0; i < k; i++)
+        {
+            int length = size[i];
+            if (length <= JPEG_FAST_BITS)
+            {
+                int first = code[i] << (JPEG_FAST_BITS - length);
+                int count = 1 << (JPEG_FAST_BITS - length);
+                for (int j = 0; j < count; j++)
+                    fast[first + j] = (uint8_t)i;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Precalcula los coeficientes AC que caben enteros en la tabla rápida
+     * @details Cada entrada guarda valor * 256 + corrida * 16 + bits consumidos.
+     */
+    void buildFastAc()
+    {
+        for (int i = 0; i < (1 << JPEG_FAST_BITS); i++)
+        {
+            fastAc[i] = 0;
+            uint8_t index = fast[i];
+            if (index == 255)
+                continue;
+            int rs = values[index];
+            int run = (rs >> 4) & 15;
+            int magnitude = rs & 15;
+            int length = size[index];
+            if (magnitude && length + magnitude <= JPEG_FAST_BITS)
+            {
+                int value = ((i << length) & ((1 << JPEG_FAST_BITS) - 1)) >> (JPEG_FAST_BITS - magnitude);
+                if (value < (1 << (magnitude - 1)))
+                    value -= (1 << magnitude) - 1;
+                if (value >= -128 && value <= 127)
+                    fastAc[i] = (int16_t)(value * 256 + run * 16 + length + magnitude);
+            }
+        }
+    }
+};
+
+/**
+ * @class JpegBitReader
+ * @brief Lector de bits del segmento entrópico (quita el relleno 0xFF00)
+ * @details Al encontrar un marcador deja de avanzar y entrega ceros; position()
+ *          queda apuntando al 0xFF del marcador.
+ */
+class JpegBitReader
+{
+public:
+    JpegBitReader(const uint8_t* begin = nullptr, const uint8_t* end = nullptr) { reset(begin, end); }
+
+    void reset(const uint8_t* begin, const uint8_t* end)
+    {
+        pos = begin;
+        limit = end;
+        buffer = 0;
+        bits = 0;
+        marker = 0;
+        noMore = false;
+    }
+
+    const uint8_t* position() const { return pos; }
+    int pendingMarker() const { return marker; }
+
+    void fill()
+    {
+        do
+        {
+            unsigned int byte = 0;
+            if (!noMore)
+            {
+                if (pos >= limit)
+                {
+                    noMore = true;
+                }
+                else if (pos[0] != 0xFF)
+                {
+                    byte = *pos++;
+                }
+                else
+                {
+                    const uint8_t* next = pos + 1;
+                    while (next < limit && *next == 0xFF)
+                        next++;
+                    if (next < limit && *next == 0)
+                    {
+                        byte = 0xFF;
+                        pos = next + 1;
+                    }
+                    else
+                    {
+                        marker = next < limit ? *next : 0xD9;
+                        pos = next - 1;
+                        noMore = true;
+                    }
+                }
+            }
+            buffer |= (uint64_t)byte << (56 - bits);
+            bits += 8;
+        } while (bits <= 56);
+    }
+
+    /// Decodifica un símbolo; -1 si el código no existe
+    int decode(const JpegHuffman& table)
+    {
+        if (bits < 16)
+            fill();
+        int index = table.fast[buffer >> (64 - JPEG_FAST_BITS)];
+        if (index < 255)
+        {
+            int length = table.size[index];
+            if (length > bits)
+                return -1;
+            buffer <<= length;
+            bits -= length;
+            return table.values[index];
+        }
+        uint32_t top = (uint32_t)(buffer >> 48);
+        int length = JPEG_FAST_BITS + 1;
+        while (top >= table.maxcode[length])
+            length++;
+        if (length == 17 || length > bits)
+        {
+            bits = 0;
+            return -1;
+        }
+        int symbol = (int)((buffer >> (64 - length)) & ((1u << length) - 1)) + table.delta[length];
+        if (symbol < 0 || symbol > 255)
+            return -1;
+        buffer <<= length;
+        bits -= length;
+        return table.values[symbol];
+    }
+
+    /// Lee n bits y los extiende con signo según la convención de JPEG
+    int receiveExtend(int n)
+    {
+        if (bits < n)
+            fill();
+        int value = (int)(buffer >> (64 - n));
+        buffer <<= n;
+        bits -= n;
+        if (value < (1 << (n - 1)))
+            value -= (1 << n) - 1;
+        return value;
+    }
+
+    /// Los JPEG_FAST_BITS bits siguientes sin consumirlos
+    int peekFast()
+    {
+        if (bits < 16)
+            fill();
+        return (int)(buffer >> (64 - JPEG_FAST_BITS));
+    }
+
+    void consume(int n)
+    {
+        buffer <<= n;
+        bits -= n;
+    }
+
+    int availableBits() const { return bits; }
+
+private:
+    const uint8_t* pos;
+    const uint8_t* limit;
+    uint64_t buffer; ///< Bits pendientes alineados a la izquierda
+    int bits;
+    int marker;
+    bool noMore;
+};
+
+/// Constante de la IDCT en punto fijo de 12 bits, redondeada como stbi__f2f
+constexpr int jpegFix(float x)
+{
+    return (int)(x * 4096 + 0.5);
+}
+
+/**
+ * @brief IDCT 1D de jidctint sobre 8 valores separados por step
+ * @param out 8 resultados separados por outStep, ya desplazados
+ */
+inline void jpegIdct1D(const int* s, int step, int* out, int outStep, int bias, int shift)
+{
+    constexpr int c0541 = jpegFix(0.5411961f), cm1847 = jpegFix(-1.847759065f), c0765 = jpegFix(0.765366865f);
+    constexpr int c1175 = jpegFix(1.175875602f), c0298 = jpegFix(0.298631336f), c2053 = jpegFix(2.053119869f);
+    constexpr int c3072 = jpegFix(3.072711026f), c1501 = jpegFix(1.501321110f), cm0899 = jpegFix(-0.899976223f);
+    constexpr int cm2562 = jpegFix(-2.562915447f), cm1961 = jpegFix(-1.961570560f), cm0390 = jpegFix(-0.390180644f);
+
+    int s0 = s[0], s1 = s[step], s2 = s[step * 2], s3 = s[step * 3];
+    int s4 = s[step * 4], s5 = s[step * 5], s6 = s[step * 6], s7 = s[step * 7];
+    int p1 = (s2 + s6) * c0541;
+    int t2 = p1 + s6 * cm1847;
+    int t3 = p1 + s2 * c0765;
+    int t0 = (s0 + s4) * 4096;
+    int t1 = (s0 - s4) * 4096;
+    int x0 = t0 + t3 + bias, x3 = t0 - t3 + bias, x1 = t1 + t2 + bias, x2 = t1 - t2 + bias;
+    int p3 = s7 + s3;
+    int p4 = s5 + s1;
+    p1 = s7 + s1;
+    int p2 = s5 + s3;
+    int p5 = (p3 + p4) * c1175;
+    t0 = s7 * c0298;
+    t1 = s5 * c2053;
+    t2 = s3 * c3072;
+    t3 = s1 * c1501;
+    p1 = p5 + p1 * cm0899;
+    p2 = p5 + p2 * cm2562;
+    p3 *= cm1961;
+    p4 *= cm0390;
+    t3 += p1 + p4;
+    t2 += p2 + p3;
+    t1 += p2 + p4;
+    t0 += p1 + p3;
+    out[0] = (x0 + t3) >> shift;
+    out[outStep * 7] = (x0 - t3) >> shift;
+    out[outStep] = (x1 + t2) >> shift;
+    out[outStep * 6] = (x1 - t2) >> shift;
+    out[outStep * 2] = (x2 + t1) >> shift;
+    out[outStep * 5] = (x2 - t1) >> shift;
+    out[outStep * 3] = (x3 + t0) >> shift;
+    out[outStep * 4] = (x3 - t0) >> shift;
+}
+
+/**
+ * @brief IDCT entera 8x8 (jidctint) de referencia
+ * @param out Destino de 8x8 bytes
+ * @param stride Bytes entre filas del destino
+ * @param data Coeficientes ya decuantizados, en orden natural
+ */
+inline void jpegIdctScalar(uint8_t* out, int stride, const short data[64])
+{
+    int coefficients[64], temp[64], row[8];
+    for (int i = 0; i < 64; i++)
+        coefficients[i] = data[i];
+    // columnas con 2 bits extra de precisión; filas quitando 1 << 17 con redondeo y sumando 128
+    for (int i = 0; i < 8; i++)
+        jpegIdct1D(coefficients + i, 8, temp + i, 8, 512, 10);
+    for (int i = 0; i < 8; i++)
+    {
+        jpegIdct1D(temp + i * 8, 1, row, 1, 65536 + (128 << 17), 17);
+        for (int k = 0; k < 8; k++)
+            out[i * stride + k] = (uint8_t)std::min(std::max(row[k], 0), 255);
+    }
+}
+
+/**
+ * @brief IDCT de un bloque
+ * @param acNonZero false si solo el DC es distinto de cero: el bloque es plano
+ */
+inline void jpegIdct(uint8_t* out, int stride, const short data[64], bool acNonZero)
+{
+    if (!acNonZero)
+    {
+        int value = (data[0] * 4 * 4096 + 65536 + (128 << 17)) >> 17;
+        uint8_t flat = (uint8_t)std::min(std::max(value, 0), 255);
+        for (int y = 0; y < 8; y++)
+            memset(out + y * stride, flat, 8);
+        return;
+    }
+    jpegIdctScalar(out, stride, data);
+}
+
+/// Punto fijo de la conversión de color de stb_image (precisión reducida a propósito)
+inline int jpegColorFix(float x)
+{
+    return ((int)(x * 4096.0f + 0.5f)) << 8;
+}
+
+/**
+ * @brief YCbCr -> RGB(A) de una fila, idéntico a stbi__YCbCr_to_RGB_row
+ * @param step 3 o 4 bytes por píxel de salida (con 4 el alfa vale 255)
+ */
+inline void jpegYCbCrToRgbRow(uint8_t* out, const uint8_t* y, const uint8_t* cb, const uint8_t* cr, int count, int step)
+{
+    for (int i = 0; i < count; i++)
+    {
+        int yf = (y[i] << 20) + (1 << 19);
+        int crc = cr[i] - 128;
+        int cbc = cb[i] - 128;
+        int r = (yf + crc * jpegColorFix(1.40200f)) >> 20;
+        int g = (yf + crc * -jpegColorFix(0.71414f) + ((cbc * -jpegColorFix(0.34414f)) & (int)0xFFFF0000u)) >> 20;
+        int b = (yf + cbc * jpegColorFix(1.77200f)) >> 20;
+        uint8_t* pixel = out + (size_t)i * step;
+        pixel[0] = (uint8_t)std::min(std::max(r, 0), 255);
+        pixel[1] = (uint8_t)std::min(std::max(g, 0), 255);
+        pixel[2] = (uint8_t)std::min(std::max(b, 0), 255);
+        if (step == 4)
+            pixel[3] = 255;
+    }
+}
+
+/**
+ * @brief Sobremuestreo 2x2 "fancy" de una fila, idéntico a stbi__resample_row_hv_2
+ * @param out 2 * w bytes
+ * @param near Fila de croma más cercana
+ * @param far Fila de croma vecina (arriba o abajo)
+ * @param temp w enteros de 16 bits de trabajo
+ */
+inline void jpegUpsampleH2V2(uint8_t* out, const uint8_t* near, const uint8_t* far, int w, int16_t* temp)
+{
+    if (w == 1)
+    {
+        out[0] = out[1] = (uint8_t)((3 * near[0] + far[0] + 2) >> 2);
+        return;
+    }
+    int i = 0;
+#if defined(JPEG_SSE2)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 8 <= w; i += 8)
+        {
+            __m128i n = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(near + i)), zero);
+            __m128i f = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(far + i)), zero);
+            _mm_storeu_si128((__m128i*)(temp + i), _mm_add_epi16(_mm_add_epi16(n, _mm_slli_epi16(n, 1)), f));
+        }
+    }
+#endif
+    for (; i < w; i++)
+        temp[i] = (int16_t)(3 * near[i] + far[i]);
+
+    out[0] = (uint8_t)((temp[0] + 2) >> 2);
+    i = 1;
+#if defined(JPEG_SSE2)
+    {
+        const __m128i eight = _mm_set1_epi16(8);
+        for (; i + 8 <= w; i += 8)
+        {
+            __m128i previous = _mm_loadu_si128((const __m128i*)(temp + i - 1));
+            __m128i current = _mm_loadu_si128((const __m128i*)(temp + i));
+            __m128i odd = _mm_add_epi16(_mm_add_epi16(previous, _mm_slli_epi16(previous, 1)), _mm_add_epi16(current, eight));
+            __m128i even = _mm_add_epi16(_mm_add_epi16(current, _mm_slli_epi16(current, 1)), _mm_add_epi16(previous, eight));
+            odd = _mm_srli_epi16(odd, 4);
+            even = _mm_srli_epi16(even, 4);
+            __m128i bytes = _mm_packus_epi16(_mm_unpacklo_epi16(odd, even), _mm_unpackhi_epi16(odd, even));
+            _mm_storeu_si128((__m128i*)(out + i * 2 - 1), bytes);
+        }
+    }
+#endif
+    for (; i < w; i++)
+    {
+        out[i * 2 - 1] = (uint8_t)((3 * temp[i - 1] + temp[i] + 8) >> 4);
+        out[i * 2] = (uint8_t)((3 * temp[i] + temp[i - 1] + 8) >> 4);
+    }
+    out[w * 2 - 1] = (uint8_t)((temp[w - 1] + 2) >> 2);
+}
+
+/// Sobremuestreo horizontal 2x (stbi__resample_row_h_2)
+inline void jpegUpsampleH2(uint8_t* out, const uint8_t* in, int w)
+{
+    if (w == 1)
+    {
+        out[0] = out[1] = in[0];
+        return;
+    }
+    out[0] = in[0];
+    out[1] = (uint8_t)((in[0] * 3 + in[1] + 2) >> 2);
+    int i = 1;
+    for (; i < w - 1; i++)
+    {
+        int n = 3 * in[i] + 2;
+        out[i * 2] = (uint8_t)((n + in[i - 1]) >> 2);
+        out[i * 2 + 1] = (uint8_t)((n + in[i + 1]) >> 2);
+    }
+    out[i * 2] = (uint8_t)((in[w - 2] * 3 + in[w - 1] + 2) >> 2);
+    out[i * 2 + 1] = in[w - 1];
+}
+
+/// Sobremuestreo vertical 2x (stbi__resample_row_v_2)
+inline void jpegUpsampleV2(uint8_t* out, const uint8_t* near, const uint8_t* far, int w)
+{
+    for (int i = 0; i < w; i++)
+        out[i] = (uint8_t)((3 * near[i] + far[i] + 2) >> 2);
+}
+
+/**
+ * @struct JpegComponent
+ * @brief Componente de la imagen y su plano decodificado (alineado a MCU)
+ */
+struct JpegComponent
+{
+    int id = 0;
+    int h = 1, v = 1;      ///< Factores de muestreo
+    int quant = 0;         ///< Tabla de cuantización
+    int dcTable = 0, acTable = 0;
+    int width = 0, height = 0; ///< Muestras reales
+    int stride = 0, rows = 0;  ///< Tamaño del plano, múltiplo de bloques de MCU
+    int dcPred = 0;
+    std::vector<uint8_t> plane;
+};
+
+/**
+ * @struct JpegImage
+ * @brief Estado de decodificación: tablas, cuadro y planos
+ */
+struct JpegImage
+{
+    int width = 0, height = 0;
+    int hmax = 1, vmax = 1;
+    int mcusX = 0, mcusY = 0;
+    int restartInterval = 0;
+    int adobeTransform = -1;
+    bool jfif = false;
+    bool frameSeen = false;
+    uint16_t quant[4][64];   ///< En orden natural
+    JpegHuffman dc[4];
+    JpegHuffman ac[4];
+    std::vector<JpegComponent> components;
+    // exploración actual
+    int scanComponents[4];
+    int scanCount = 0;
+};
+
+/**
+ * @class JpegDecoder
+ * @brief Backend JPEG baseline (ver el encabezado del archivo)
+ */
+class JpegDecoder : public ImageDecoder
+{
+public:
+    /// @param parallelMinPixels Píxeles desde los que se reparte; las imágenes más chicas se declinan
+    explicit JpegDecoder(size_t parallelMinPixels = JPEG_PARALLEL_MIN_PIXELS) : parallelMinPixels(parallelMinPixels)
+    {
+    }
+
+    const char* name() const override { return "jpeg-paralelo"; }
+
+    ImageDecodeStatus decode(const unsigned char* data, size_t size, unsigned char** pixels,
+                             int* width, int* height, int* channels, int desiredChannels) const override
+    {
+        if (size < 4 || data[0] != 0xFF || data[1] != 0xD8 || desiredChannels < 0 || desiredChannels > 4)
+            return ImageDecodeStatus::Unsupported;
+        JpegImage image;
+        ImageDecodeStatus status = decodeScans(image, data, data + size);
+        if (status != ImageDecodeStatus::Decoded)
+            return status;
+
+        int sourceChannels = (int)image.components.size();
+        int outChannels = desiredChannels ? desiredChannels : (sourceChannels >= 3 ? 3 : 1);
+        unsigned char* output = allocateImagePixels((size_t)outChannels * image.width * image.height);
+        if (!output)
+            return ImageDecodeStatus::Failed;
+        writeAllPixels(image, output, outChannels, (size_t)outChannels * image.width);
+        *pixels = output;
+        *width = image.width;
+        *height = image.height;
+        *channels = sourceChannels;
+        return ImageDecodeStatus::Decoded;
+    }
+
+    ImageDecodeStatus decodeInto(const unsigned char* data, size_t size, const ImageDecodeTarget& target) const override
+    {
+        if (size < 4 || data[0] != 0xFF || data[1] != 0xD8)
+            return ImageDecodeStatus::Unsupported;
+        JpegImage image;
+        ImageDecodeStatus status = decodeScans(image, data, data + size);
+        if (status != ImageDecodeStatus::Decoded)
+            return status;
+        if (image.width != target.width || image.height != target.height)
+            return ImageDecodeStatus::Failed;
+        writeAllPixels(image, target.pixels, imagePixelFormatChannels(target.format), target.stride());
+        return ImageDecodeStatus::Decoded;
+    }
+
+    /**
+     * @brief Lee los marcadores y decodifica todas las exploraciones en los planos
+     */
+    ImageDecodeStatus decodeScans(JpegImage& image, const uint8_t* begin, const uint8_t* end) const
+    {
+        const uint8_t* pos = begin + 2;
+        for (;;)
+        {
+            // buscar el siguiente marcador (tolera bytes de relleno)
+            while (pos < end && *pos != 0xFF)
+                pos++;
+            while (pos < end && *pos == 0xFF)
+                pos++;
+            if (pos >= end)
+                return image.frameSeen && image.scanCount > 0 ? ImageDecodeStatus::Decoded : ImageDecodeStatus::Failed;
+            int marker = *pos++;
+            if (marker == 0xD9)
+                return image.frameSeen && image.scanCount > 0 ? ImageDecodeStatus::Decoded : ImageDecodeStatus::Failed;
+            if (marker == 0xD8 || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7))
+                continue;
+            if (end - pos < 2)
+                return ImageDecodeStatus::Failed;
+            int length = (pos[0] << 8) | pos[1];
+            if (length < 2 || end - pos < length)
+                return ImageDecodeStatus::Failed;
+            const uint8_t* segment = pos + 2;
+            int segmentLength = length - 2;
+            pos += length;
+
+            ImageDecodeStatus status = ImageDecodeStatus::Decoded;
+            switch (marker)
+            {
+                case 0xC0:
+                case 0xC1:
+                    status = parseFrame(image, segment, segmentLength);
+                    break;
+                case 0xC4:
+                    status = parseHuffman(image, segment, segmentLength);
+                    break;
+                case 0xDB:
+                    status = parseQuant(image, segment, segmentLength);
+                    break;
+                case 0xDD:
+                    if (segmentLength != 2)
+                        return ImageDecodeStatus::Failed;
+                    image.restartInterval = (segment[0] << 8) | segment[1];
+                    break;
+                case 0xDA:
+                    status = parseScan(image, segment, segmentLength);
+                    if (status == ImageDecodeStatus::Decoded && !decodesInParallel(image))
+                        return ImageDecodeStatus::Unsupported;
+                    if (status == ImageDecodeStatus::Decoded)
+                        pos = decodeScan(image, pos, end);
+                    if (!pos)
+                        return ImageDecodeStatus::Failed;
+                    break;
+                case 0xE0:
+                    if (segmentLength >= 5 && memcmp(segment, "JFIF\0", 5) == 0)
+                        image.jfif = true;
+                    break;
+                case 0xEE:
+                    if (segmentLength >= 12 && memcmp(segment, "Adobe", 5) == 0)
+                        image.adobeTransform = segment[11];
+                    break;
+                default:
+                    // SOF2 (progresivo), aritmético, jerárquico...: que lo haga stb
+                    if ((marker >= 0xC2 && marker <= 0xCF) && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+                        return ImageDecodeStatus::Unsupported;
+                    break;
+            }
+            if (status != ImageDecodeStatus::Decoded)
+                return status;
+        }
+    }
+
+    /**
+     * @brief Decodifica un tramo de MCU entrelazados entre dos marcadores RST
+     * @param first Primer MCU (índice en orden de lectura)
+     * @param count MCU del tramo
+     * @return Posición tras el tramo (en su marcador), o nullptr si hay un error
+     * @details Los predictores DC deben estar en cero, como tras un RST. Tramos
+     *          distintos escriben bloques distintos de los planos.
+     */
+    const uint8_t* decodeInterleavedRange(JpegImage& image, const uint8_t* pos, const uint8_t* end,
+                                          int first, int count, int* dcPred) const
+    {
+        JpegBitReader reader(pos, end);
+        alignas(32) short block[64];
+        for (int mcu = first; mcu < first + count; mcu++)
+        {
+            int mcuX = mcu % image.mcusX;
+            int mcuY = mcu / image.mcusX;
+            for (int s = 0; s < image.scanCount; s++)
+            {
+                JpegComponent& component = image.components[image.scanComponents[s]];
+                for (int by = 0; by < component.v; by++)
+                {
+                    for (int bx = 0; bx < component.h; bx++)
+                    {
+                        bool acNonZero;
+                        if (!decodeBlock(image, reader, component, dcPred[s], block, acNonZero))
+                            return nullptr;
+                        int x = (mcuX * component.h + bx) * 8;
+                        int y = (mcuY * component.v + by) * 8;
+                        jpegIdct(component.plane.data() + (size_t)y * component.stride + x, component.stride,
+                                 block, acNonZero);
+                    }
+                }
+            }
+        }
+        return reader.position();
+    }
+
+    /**
+     * @brief Escribe los píxeles finales: sobremuestreo y conversión de color
+     * @param outChannels 1-4, convierte como stb_image
+     * @param rowStride Bytes entre filas del destino
+     */
+    void writePixels(const JpegImage& image, uint8_t* output, int outChannels, size_t rowStride,
+                     int firstRow = 0, int rowCount = -1) const
+    {
+        if (rowCount < 0)
+            rowCount = image.height - firstRow;
+        int sourceChannels = (int)image.components.size();
+        bool isRgb = sourceChannels == 3 && (rgbComponentIds(image) || (image.adobeTransform == 0 && !image.jfif));
+        int decodeCount = sourceChannels == 3 && outChannels < 3 && !isRgb ? 1 : sourceChannels;
+
+        std::vector<uint8_t> lines((size_t)decodeCount * (image.width + 16));
+        std::vector<int16_t> temp(image.width + 16);
+        const uint8_t* rows[3];
+        for (int j = firstRow; j < firstRow + rowCount; j++)
+        {
+            for (int k = 0; k < decodeCount; k++)
+                rows[k] = resampleRow(image, image.components[k], j, lines.data() + (size_t)k * (image.width + 16), temp.data());
+
+            uint8_t* out = output + (size_t)(j - firstRow) * rowStride;
+            if (outChannels >= 3)
+            {
+                if (sourceChannels == 3 && !isRgb)
+                {
+                    jpegYCbCrToRgbRow(out, rows[0], rows[1], rows[2], image.width, outChannels);
+                }
+                else
+                {
+                    for (int i = 0; i < image.width; i++, out += outChannels)
+                    {
+                        out[0] = rows[0][i];
+                        out[1] = sourceChannels == 3 ? rows[1][i] : rows[0][i];
+                        out[2] = sourceChannels == 3 ? rows[2][i] : rows[0][i];
+                        if (outChannels == 4)
+                            out[3] = 255;
+                    }
+                }
+            }
+            else
+            {
+                for (int i = 0; i < image.width; i++, out += outChannels)
+                {
+                    out[0] = isRgb ? imageLuminance(rows[0][i], rows[1][i], rows[2][i]) : rows[0][i];
+                    if (outChannels == 2)
+                        out[1] = 255;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief writePixels de la imagen completa, en bandas de filas repartidas entre hilos
+     */
+    void writeAllPixels(const JpegImage& image, uint8_t* output, int outChannels, size_t rowStride) const
+    {
+        JobSystem& jobs = defaultJobSystem();
+        size_t band = std::max<size_t>(16, image.height / (4 * (jobs.workerCount() + 1)));
+        jobs.parallelFor((size_t)image.height, band, [&](size_t first, size_t last) {
+            writePixels(image, output + first * rowStride, outChannels, rowStride, (int)first, (int)(last - first));
+        });
+    }
+
+private:
+    size_t parallelMinPixels;
+
+    /// true si la exploración actual se puede repartir entre hilos: grande y con más de un intervalo
+    bool decodesInParallel(const JpegImage& image) const
+    {
+        return image.restartInterval > 0 && image.restartInterval < scanUnits(image)
+            && (size_t)image.width * image.height >= parallelMinPixels && defaultJobSystem().workerCount() > 0;
+    }
+
+    static bool rgbComponentIds(const JpegImage& image)
+    {
+        return image.components.size() == 3 && image.components[0].id == 'R' && image.components[1].id == 'G'
+            && image.components[2].id == 'B';
+    }
+
+    static ImageDecodeStatus parseFrame(JpegImage& image, const uint8_t* p, int length)
+    {
+        if (image.frameSeen || length < 6 || p[0] != 8)
+            return ImageDecodeStatus::Unsupported;
+        image.height = (p[1] << 8) | p[2];
+        image.width = (p[3] << 8) | p[4];
+        int count = p[5];
+        if (image.width == 0 || image.height == 0 || (1 << 24) / image.width < image.height)
+            return ImageDecodeStatus::Unsupported; // altura 0 (DNL) o demasiado grande
+        if (count != 1 && count != 3)
+            return ImageDecodeStatus::Unsupported;
+        if (length < 6 + count * 3)
+            return ImageDecodeStatus::Failed;
+        image.components.resize(count);
+        for (int i = 0; i < count; i++)
+        {
+            JpegComponent& component = image.components[i];
+            component.id = p[6 + i * 3];
+            component.h = p[7 + i * 3] >> 4;
+            component.v = p[7 + i * 3] & 15;
+            component.quant = p[8 + i * 3];
+            if (component.h < 1 || component.h > 4 || component.v < 1 || component.v > 4 || component.quant > 3)
+                return ImageDecodeStatus::Failed;
+            image.hmax = std::max(image.hmax, component.h);
+            image.vmax = std::max(image.vmax, component.v);
+        }
+        if (count == 1)
+        {
+            // una sola componente: el MCU es un bloque, sea cual sea el factor declarado
+            image.components[0].h = image.components[0].v = 1;
+            image.hmax = image.vmax = 1;
+        }
+        image.mcusX = (image.width + image.hmax * 8 - 1) / (image.hmax * 8);
+        image.mcusY = (image.height + image.vmax * 8 - 1) / (image.vmax * 8);
+        for (JpegComponent& component : image.components)
+        {
+            // solo factores que stb sobremuestrea con los filtros 1x/2x
+            if (image.hmax % component.h || image.vmax % component.v || image.hmax / component.h > 2
+                || image.vmax / component.v > 2)
+                return ImageDecodeStatus::Unsupported;
+            component.width = (image.width * component.h + image.hmax - 1) / image.hmax;
+            component.height = (image.height * component.v + image.vmax - 1) / image.vmax;
+            component.stride = image.mcusX * component.h * 8;
+            component.rows = image.mcusY * component.v * 8;
+            component.plane.assign((size_t)component.stride * component.rows, 0);
+        }
+        image.frameSeen = true;
+        return ImageDecodeStatus::Decoded;
+    }
+
+    static ImageDecodeStatus parseHuffman(JpegImage& image, const uint8_t* p, int length)
+    {
+        while (length > 0)
+        {
+            if (length < 17)
+                return ImageDecodeStatus::Failed;
+            int tableClass = p[0] >> 4;
+            int id = p[0] & 15;
+            if (tableClass > 1 || id > 3)
+                return ImageDecodeStatus::Failed;
+            int total = 0;
+            for (int i = 0; i < 16; i++)
+                total += p[1 + i];
+            if (total > 256 || length < 17 + total)
+                return ImageDecodeStatus::Failed;
+            JpegHuffman& table = tableClass == 0 ? image.dc[id] : image.ac[id];
+            if (!table.build(p + 1))
+                return ImageDecodeStatus::Failed;
+            memcpy(table.values, p + 17, total);
+            if (tableClass == 1)
+                table.buildFastAc();
+            p += 17 + total;
+            length -= 17 + total;
+        }
+        return ImageDecodeStatus::Decoded;
+    }
+
+    static ImageDecodeStatus parseQuant(JpegImage& image, const uint8_t* p, int length)
+    {
+        while (length > 0)
+        {
+            int precision = p[0] >> 4;
+            int id = p[0] & 15;
+            int bytes = precision ? 129 : 65;
+            if (precision > 1 || id > 3 || length < bytes)
+                return ImageDecodeStatus::Failed;
+            for (int i = 0; i < 64; i++)
+                image.quant[id][JPEG_DEZIGZAG[i]] = precision ? (uint16_t)((p[1 + i * 2] << 8) | p[2 + i * 2]) : p[1 + i];
+            p += bytes;
+            length -= bytes;
+        }
+        return ImageDecodeStatus::Decoded;
+    }
+
+    static ImageDecodeStatus parseScan(JpegImage& image, const uint8_t* p, int length)
+    {
+        if (!image.frameSeen || length < 1)
+            return ImageDecodeStatus::Failed;
+        int count = p[0];
+        if (count < 1 || count > (int)image.components.size() || length < 4 + count * 2)
+            return ImageDecodeStatus::Failed;
+        for (int i = 0; i < count; i++)
+        {
+            int id = p[1 + i * 2];
+            int tables = p[2 + i * 2];
+            int index = -1;
+            for (size_t c = 0; c < image.components.size(); c++)
+            {
+                if (image.components[c].id == id)
+                    index = (int)c;
+            }
+            if (index < 0 || (tables >> 4) > 3 || (tables & 15) > 3)
+                return ImageDecodeStatus::Failed;
+            image.components[index].dcTable = tables >> 4;
+            image.components[index].acTable = tables & 15;
+            image.scanComponents[i] = index;
+        }
+        // baseline: espectro completo y sin aproximaciones sucesivas
+        const uint8_t* spectral = p + 1 + count * 2;
+        if (spectral[0] != 0 || spectral[1] != 63 || spectral[2] != 0)
+            return ImageDecodeStatus::Unsupported;
+        image.scanCount = count;
+        return ImageDecodeStatus::Decoded;
+    }
+
+    /**
+     * @brief Decodifica una exploración repartiendo sus intervalos de reinicio entre hilos
+     * @return Posición del marcador que la termina, o nullptr si hay un error o
+     *         los marcadores RSTn no cuadran con el intervalo
+     */
+    const uint8_t* decodeScan(JpegImage& image, const uint8_t* pos, const uint8_t* end) const
+    {
+        int total = scanUnits(image);
+        int interval = image.restartInterval;
+        int intervals = (total + interval - 1) / interval;
+        std::vector<const uint8_t*> starts;
+        const uint8_t* scanEnd;
+        if (!findRestartIntervals(pos, end, intervals, starts, scanEnd))
+            return nullptr;
+        std::atomic<bool> failed{ false };
+        JobSystem& jobs = defaultJobSystem();
+        size_t grain = std::max<size_t>(1, intervals / (8 * (jobs.workerCount() + 1)));
+        jobs.parallelFor((size_t)intervals, grain, [&](size_t begin, size_t last) {
+            for (size_t i = begin; i < last; i++)
+            {
+                int first = (int)i * interval;
+                int dcPred[4] = { 0, 0, 0, 0 };
+                if (!decodeRange(image, starts[i], end, first, std::min(interval, total - first), dcPred))
+                    failed = true;
+            }
+        });
+        return failed ? nullptr : scanEnd;
+    }
+
+    /// Unidades de la exploración: MCU si es entrelazada, bloques si tiene una componente
+    static int scanUnits(const JpegImage& image)
+    {
+        if (image.scanCount > 1)
+            return image.mcusX * image.mcusY;
+        const JpegComponent& component = image.components[image.scanComponents[0]];
+        return ((component.width + 7) / 8) * ((component.height + 7) / 8);
+    }
+
+    /// Tramo de unidades [first, first + count) sin marcadores en medio
+    const uint8_t* decodeRange(JpegImage& image, const uint8_t* pos, const uint8_t* end, int first, int count,
+                               int* dcPred) const
+    {
+        if (image.scanCount == 1)
+            return decodeComponentRange(image, pos, end, first, count, dcPred[0]);
+        return decodeInterleavedRange(image, pos, end, first, count, dcPred);
+    }
+
+    /// Exploración no entrelazada: bloques de una componente en orden de filas
+    const uint8_t* decodeComponentRange(JpegImage& image, const uint8_t* pos, const uint8_t* end, int first,
+                                        int count, int& dcPred) const
+    {
+        JpegComponent& component = image.components[image.scanComponents[0]];
+        int blocksX = (component.width + 7) / 8;
+        JpegBitReader reader(pos, end);
+        alignas(32) short block[64];
+        for (int index = first; index < first + count; index++)
+        {
+            int bx = index % blocksX;
+            int by = index / blocksX;
+            bool acNonZero;
+            if (!decodeBlock(image, reader, component, dcPred, block, acNonZero))
+                return nullptr;
+            jpegIdct(component.plane.data() + (size_t)by * 8 * component.stride + bx * 8, component.stride,
+                     block, acNonZero);
+        }
+        return reader.position();
+    }
+
+    /**
+     * @brief Localiza el comienzo de cada intervalo de reinicio de la exploración
+     * @param starts Recibe intervals posiciones (la primera es pos)
+     * @param scanEnd Recibe el marcador que termina la exploración
+     * @return false si los RSTn no son exactamente intervals - 1 (datos truncados
+     *         o extraños: stb_image sabe tolerarlos)
+     */
+    static bool findRestartIntervals(const uint8_t* pos, const uint8_t* end, int intervals,
+                                     std::vector<const uint8_t*>& starts, const uint8_t*& scanEnd)
+    {
+        starts.assign(1, pos);
+        for (;;)
+        {
+            pos = (const uint8_t*)memchr(pos, 0xFF, end - pos);
+            if (!pos || end - pos < 2)
+                return false;
+            if (pos[1] == 0x00 || pos[1] == 0xFF)
+            {
+                pos++; // byte de relleno o 0xFF repetido
+                continue;
+            }
+            if (pos[1] < 0xD0 || pos[1] > 0xD7)
+            {
+                scanEnd = pos;
+                return (int)starts.size() == intervals;
+            }
+            pos += 2;
+            starts.push_back(pos);
+            if ((int)starts.size() > intervals)
+                return false;
+        }
+    }
+
+    /**
+     * @brief Decodifica y decuantiza un bloque 8x8 (orden natural)
+     * @param acNonZero Recibe si algún coeficiente AC es distinto de cero
+     */
+    static bool decodeBlock(const JpegImage& image, JpegBitReader& reader, const JpegComponent& component,
+                            int& dcPred, short block[64], bool& acNonZero)
+    {
+        const JpegHuffman& dcTable = image.dc[component.dcTable];
+        const JpegHuffman& acTable = image.ac[component.acTable];
+        const uint16_t* quant = image.quant[component.quant];
+        memset(block, 0, 64 * sizeof(short));
+        acNonZero = false;
+
+        int t = reader.decode(dcTable);
+        if (t < 0 || t > 15)
+            return false;
+        int diff = t ? reader.receiveExtend(t) : 0;
+        dcPred += diff;
+        block[0] = (short)(dcPred * quant[0]);
+
+        int k = 1;
+        do
+        {
+            int fast = reader.peekFast();
+            int packed = acTable.fastAc[fast];
+            if (packed)
+            {
+                k += (packed >> 4) & 15;
+                reader.consume(packed & 15);
+                int zig = JPEG_DEZIGZAG[k++];
+                block[zig] = (short)((packed >> 8) * quant[zig]);
+                acNonZero = true;
+            }
+            else
+            {
+                int rs = reader.decode(acTable);
+                if (rs < 0)
+                    return false;
+                int s = rs & 15;
+                int r = rs >> 4;
+                if (s == 0)
+                {
+                    if (rs != 0xF0)
+                        break; // fin de bloque
+                    k += 16;
+                }
+                else
+                {
+                    k += r;
+                    int zig = JPEG_DEZIGZAG[k++];
+                    block[zig] = (short)(reader.receiveExtend(s) * quant[zig]);
+                    acNonZero = true;
+                }
+            }
+        } while (k < 64);
+        return true;
+    }
+
+    /**
+     * @brief Fila j de una componente llevada a resolución completa (como stb_image)
+     */
+    const uint8_t* resampleRow(const JpegImage& image, const JpegComponent& component, int j, uint8_t* line, int16_t* temp) const
+    {
+        int hs = image.hmax / component.h;
+        int vs = image.vmax / component.v;
+        int near = vs == 2 ? j >> 1 : j;
+        int far = near;
+        if (vs == 2)
+            far = std::min(std::max((j & 1) ? near + 1 : near - 1, 0), component.height - 1);
+        const uint8_t* nearRow = component.plane.data() + (size_t)near * component.stride;
+        const uint8_t* farRow = component.plane.data() + (size_t)far * component.stride;
+        int w = component.width;
+        if (hs == 1 && vs == 1)
+            return nearRow;
+        if (hs == 1)
+            jpegUpsampleV2(line, nearRow, farRow, w);
+        else if (vs == 1)
+            jpegUpsampleH2(line, nearRow, w);
+        else
+            jpegUpsampleH2V2(line, nearRow, farRow, w, temp);
+        return line;
+    }
+};
+
+#endif
@@ -0,0 +1,209 @@
+/**
+ * @file lz4_block.h
+ * @brief Compresor y descompresor del formato de bloque LZ4
+ * @details Implementación autocontenida (sin liblz4) del formato de bloque
+ *          estándar: secuencias de literales + coincidencia con offset de 16 bits.
+ *          El compresor es voraz con una tabla hash de 4 bytes, lo justo para
+ *          empaquetar assets; la descompresión, que es lo que corre al cargar,
+ *          valida todos los límites y no confía en los datos de entrada.
+ *          Los bloques producidos son legibles por cualquier decodificador LZ4.
+ */
+#ifndef LZ4_BLOCK_H
+#define LZ4_BLOCK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/// Distancia máxima de una coincidencia (offset de 16 bits)
+const size_t LZ4_MAX_OFFSET = 65535;
+/// Longitud mínima de una coincidencia
+const size_t LZ4_MIN_MATCH = 4;
+/// Los últimos 5 bytes del bloque son siempre literales
+const size_t LZ4_LAST_LITERALS = 5;
+/// Una coincidencia no puede empezar en los últimos 12 bytes
+const size_t LZ4_MATCH_FIND_LIMIT = 12;
+
+/**
+ * @brief Tamaño máximo que puede ocupar un bloque comprimido
+ */
+inline size_t lz4CompressBound(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+/// Escribe una longitud extendida (bytes de 255 y el resto)
+inline bool lz4WriteLength(size_t length, unsigned char*& out, const unsigned char* outEnd)
+{
+    while (length >= 255)
+    {
+        if (out >= outEnd)
+            return false;
+        *out++ = 255;
+        length -= 255;
+    }
+    if (out >= outEnd)
+        return false;
+    *out++ = (unsigned char)length;
+    return true;
+}
+
+/// Emite una secuencia: token, literales y, si matchLength > 0, la coincidencia
+inline bool lz4WriteSequence(const unsigned char* literals, size_t literalLength, size_t offset, size_t matchLength,
+                             unsigned char*& out, const unsigned char* outEnd)
+{
+    if (out >= outEnd)
+        return false;
+    unsigned char* token = out++;
+    size_t matchCode = matchLength ? matchLength - LZ4_MIN_MATCH : 0;
+    *token = (unsigned char)(((literalLength >= 15 ? 15 : literalLength) << 4) | (matchCode >= 15 ? 15 : matchCode));
+    if (literalLength >= 15 && !lz4WriteLength(literalLength - 15, out, outEnd))
+        return false;
+    if ((size_t)(outEnd - out) < literalLength)
+        return false;
+    memcpy(out, literals, literalLength);
+    out += literalLength;
+    if (matchLength == 0)
+        return true;
+    if (outEnd - out < 2)
+        return false;
+    *out++ = (unsigned char)(offset & 0xFF);
+    *out++ = (unsigned char)(offset >> 8);
+    return matchCode < 15 || lz4WriteLength(matchCode - 15, out, outEnd);
+}
+
+/**
+ * @brief Comprime un bloque
+ * @param source Datos de entrada
+ * @param size Bytes de entrada
+ * @param destination Salida, de al menos capacity bytes
+ * @param capacity Capacidad de la salida (lz4CompressBound(size) siempre alcanza)
+ * @return Bytes escritos, o 0 si no caben en capacity
+ */
+inline size_t lz4CompressBlock(const unsigned char* source, size_t size, unsigned char* destination, size_t capacity)
+{
+    const int HASH_BITS = 16;
+    unsigned char* out = destination;
+    const unsigned char* outEnd = destination + capacity;
+    size_t anchor = 0;
+
+    if (size > LZ4_MATCH_FIND_LIMIT)
+    {
+        std::vector<int64_t> table((size_t)1 << HASH_BITS, -1);
+        size_t matchFindLimit = size - LZ4_MATCH_FIND_LIMIT;
+        size_t matchEndLimit = size - LZ4_LAST_LITERALS;
+        size_t position = 0;
+        while (position < matchFindLimit)
+        {
+            uint32_t sequence;
+            memcpy(&sequence, source + position, 4);
+            uint32_t slot = (sequence * 2654435761u) >> (32 - HASH_BITS);
+            int64_t candidate = table[slot];
+            table[slot] = (int64_t)position;
+            uint32_t candidateSequence = 0;
+            if (candidate >= 0)
+                memcpy(&candidateSequence, source + candidate, 4);
+            if (candidate < 0 || position - (size_t)candidate > LZ4_MAX_OFFSET || candidateSequence != sequence)
+            {
+                position++;
+                continue;
+            }
+
+            size_t reference = (size_t)candidate;
+            // extender hacia atrás sobre los literales pendientes
+            while (position > anchor && reference > 0 && source[position - 1] == source[reference - 1])
+            {
+                position--;
+                reference--;
+            }
+            size_t length = LZ4_MIN_MATCH;
+            while (position + length < matchEndLimit && source[reference + length] == source[position + length])
+                length++;
+
+            if (!lz4WriteSequence(source + anchor, position - anchor, position - reference, length, out, outEnd))
+                return 0;
+            position += length;
+            anchor = position;
+        }
+    }
+
+    if (!lz4WriteSequence(source + anchor, size - anchor, 0, 0, out, outEnd))
+        return 0;
+    return (size_t)(out - destination);
+}
+
+/**
+ * @brief Descomprime un bloque cuyo tamaño original se conoce
+ * @param source Bloque comprimido
+ * @param size Bytes del bloque
+ * @param destination Salida
+ * @param originalSize Bytes que debe producir exactamente
+ * @return false si el bloque está corrupto o no produce originalSize bytes
+ */
+inline bool lz4DecompressBlock(const unsigned char* source, size_t size, unsigned char* destination, size_t originalSize)
+{
+    size_t in = 0;
+    size_t out = 0;
+    while (in < size)
+    {
+        unsigned char token = source[in++];
+        size_t literalLength = token >> 4;
+        if (literalLength == 15)
+        {
+            unsigned char extra;
+            do
+            {
+                if (in >= size)
+                    return false;
+                extra = source[in++];
+                literalLength += extra;
+            } while (extra == 255);
+        }
+        if (literalLength > size - in || literalLength > originalSize - out)
+            return false;
+        memcpy(destination + out, source + in, literalLength);
+        in += literalLength;
+        out += literalLength;
+        // la última secuencia no tiene coincidencia
+        if (in == size)
+            break;
+
+        if (size - in < 2)
+            return false;
+        size_t offset = (size_t)source[in] | ((size_t)source[in + 1] << 8);
+        in += 2;
+        if (offset == 0 || offset > out)
+            return false;
+        size_t matchLength = token & 15;
+        if (matchLength == 15)
+        {
+            unsigned char extra;
+            do
+            {
+                if (in >= size)
+                    return false;
+                extra = source[in++];
+                matchLength += extra;
+            } while (extra == 255);
+        }
+        matchLength += LZ4_MIN_MATCH;
+        if (matchLength > originalSize - out)
+            return false;
+        // la coincidencia puede solaparse con lo que escribe (offset < longitud)
+        const unsigned char* match = destination + out - offset;
+        if (offset >= matchLength)
+        {
+            memcpy(destination + out, match, matchLength);
+        }
+        else
+        {
+            for (size_t i = 0; i < matchLength; i++)
+                destination[out + i] = match[i];
+        }
+        out += matchLength;
+    }
+    return out == originalSize;
+}
+
+#endif
@@ -10,9 +10,22 @@
 #include "glad/glad.h"  // Cargador de funciones OpenGL (debe incluirse antes que GLFW)
 #include <GLFW/glfw3.h> // Biblioteca para manejo de ventanas y entrada de dispositivos
 #include <iostream>     // Para salida de consola (debugging y mensajes de err
+#include "image_memory.h" // STBI_MALLOC/STBI_FREE al pool; antes que stb_image.h
 #include "stb_image.h"
+#undef STB_IMAGE_IMPLEMENTATION // los demás headers solo necesitan las declaraciones
 #include <filesystem>
+#include <cmath>
+#include <string>
+#include <vector>
 #include "shader_s.h"
+#include "shader_hot_reload.h"
+#include "material.h"
+#include "texture_cache.h"
+#include "texture_atlas.h"
+#include "texture_array.h"
+#include "render_graph.h"
+#include "frame_pacing.h"
+#include "game_loop.h"
 
 using namespace std;    // Usar el espacio de nombres estándar para simplificar código
 using namespace std::filesystem;
@@ -20,10 +33,35 @@ using namespace std::filesystem;
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window);
 
+// Reloj de la animación: se simula a paso fijo y se interpola al escribir FrameData
+struct AnimationClock {
+    double time;
+
+    static AnimationClock interpolate(const AnimationClock& a, const AnimationClock& b, float alpha) {
+        AnimationClock result = b;
+        result.time = a.time + (b.time - a.time) * alpha;
+        return result;
+    }
+};
+void updateAnimationClock(AnimationClock& state, double dt);
+
+// Quads con el mismo formato de vértice que la pared: posición, color y UV
+struct Mesh {
+    unsigned int VAO, VBO, EBO;
+    GLsizei indexCount;
+};
+Mesh createMesh(const vector<float>& vertices, const vector<unsigned int>& indices, GLsizei stride);
+void appendQuad(vector<float>& vertices, vector<unsigned int>& indices, float left, float bottom, float size, size_t stride);
+vector<unsigned char> makeIcon(int size, const float color[3]);
+vector<unsigned char> makeTile(int size, const float color[3]);
+
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 
+// Targets de render fuera de pantalla; framebuffer_size_callback les avisa del nuevo tamaño
+RenderTargetPool* renderTargets = nullptr;
+
 int main() {
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -50,7 +88,28 @@ int main() {
         return -1;
     }
 
-    Shader ourShader("./shader.vs", "./shader.fs");
+    // vsync, límite de FPS y baja latencia: FRAME_VSYNC, FRAME_FPS, FRAME_LOW_LATENCY
+    FramePacer framePacer(window, framePacingOptionsFromEnvironment());
+
+    // Con ./assets.lpak (./pack_build assets.lpak wall.jpg) los assets salen del
+    // pack proyectado en lugar de abrirse uno por uno
+    if (exists("./assets.lpak")) {
+        mountAssetPack("./assets.lpak");
+    }
+    // Los shaders se recargan en caliente desde el disco: nunca se leen del pack
+    defaultShaderPreprocessor().setReadFromDisk(true);
+
+    // Emitir la compilación sin esperar: el driver compila mientras se cargan
+    // los buffers y la textura, y solo el primer use() bloquea
+    ShaderBuilder::enableParallelCompile();
+    Shader ourShader(compileShaderFiles(defaultShaderPreprocessor(), "./shader.vs", "./shader.fs"));
+
+    // Recompilar el shader al guardar shader.vs/shader.fs sin reiniciar el proceso
+    ShaderHotReloader shaderReloader;
+    shaderReloader.watch(ourShader, "./shader.vs", "./shader.fs");
+    // Baldosas: muestrean un GL_TEXTURE_2D_ARRAY con la capa como atributo de vértice
+    Shader tileShader(compileShaderFiles(defaultShaderPreprocessor(), "./tiles.vs", "./tiles.fs"));
+    shaderReloader.watch(tileShader, "./tiles.vs", "./tiles.fs");
 
     float vertices[] = {
         0.5f, 0.5f, 0.0f,   1.0f, 0.0f, 0.0f,   1.0f, 1.0f, // top right
@@ -93,52 +152,264 @@ int main() {
     glEnableVertexAttribArray(2);
 
     // load and create texture
-    unsigned int texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-
-    // set texture wrapping parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-    // set texture filtering paramters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    int width, height, nrChannels;
-
-    cout << "Ruta de la textura de pared: " << filesystem::path("./wall.jpg").c_str() ;
-    unsigned char* data = stbi_load(filesystem::path("./wall.jpg").c_str(), &width, &height, &nrChannels, 0);
-    if (data) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    } else {
-        cout << "Failed to load texture";
+    // La textura llega por streaming: su ID es válido ya (con un patrón de reemplazo)
+    // y los mipmaps se suben del más chico al más grande a medida que se decodifican
+    TextureCache textureCache;
+    // Las imágenes se comprimen a BC1/BC3 al cargarlas si el driver soporta S3TC
+    textureCache.setCompression(TextureCompression::Fast);
+    // Si existe la versión cocinada (./texture_cook wall.jpg wall.ltex) se usa esa:
+    // sin decodificar JPEG ni generar mipmaps en tiempo de ejecución
+    filesystem::path wallPath = assetExists("./wall.ltex") ? "./wall.ltex" : "./wall.jpg";
+    cout << "Ruta de la textura de pared: " << wallPath.c_str() << endl;
+    // el material guarda su propia copia del handle y resuelve el ID al dibujar
+    std::shared_ptr<TextureHandle> wallTexture = std::make_shared<TextureHandle>(textureCache.load(wallPath.string()));
+
+    // Constantes por frame compartidas por todos los programas (bloque FrameData)
+    FrameUniformBuffer frameUniforms;
+    FrameUniforms frame;
+    setIdentity(frame.view);
+    setIdentity(frame.projection);
+    float lastTime = glfwGetTime();
+    AnimationClock initialClock = { 0.0 };
+    FixedTimestepLoop<AnimationClock> simulation(initialClock);
+
+    // Material de la pared: programa + textura en "ourTexture" + bloque MaterialData.
+    // Se valida y hornea aquí; en el bucle solo se aplica.
+    MaterialUniformBuffer materialUniforms;
+    MaterialUniforms wallUniforms = { { 1.0f, 1.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, 0.0f, 0.0f } };
+    std::unique_ptr<Material> wallMaterial = Material::create(
+        ourShader, { { "ourTexture", wallTexture } }, materialUniforms, &wallUniforms, sizeof(wallUniforms));
+    if (!wallMaterial) {
+        cout << "Failed to create wall material";
+        return -1;
     }
+    MaterialBinder materialBinder;
 
-    stbi_image_free(data);
-
-    while(!glfwWindowShouldClose(window)) {
-        processInput(window);
-
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+    // Fila de iconos desde un atlas: cada uno ocupa una región de la misma página y
+    // sus vértices llevan las UV ya remapeadas, así la fila sale con un solo draw call
+    TextureAtlas iconAtlas(256);
+    const float iconColors[4][3] = {
+        { 0.9f, 0.3f, 0.2f }, { 0.3f, 0.8f, 0.3f }, { 0.2f, 0.5f, 0.9f }, { 0.9f, 0.8f, 0.2f },
+    };
+    vector<float> iconVertices;
+    vector<unsigned int> iconIndices;
+    for (int i = 0; i < 4; i++) {
+        vector<unsigned char> icon = makeIcon(32, iconColors[i]);
+        const AtlasRegion* region = iconAtlas.insert("icon" + to_string(i), icon.data(), 32, 32);
+        if (!region || region->page != 0) {
+            cout << "Failed to pack icon " << i << endl;
+            return -1;
+        }
+        size_t first = iconVertices.size() / 8;
+        appendQuad(iconVertices, iconIndices, -0.45f + i * 0.25f, 0.6f, 0.2f, 8);
+        remapUVs(iconVertices.data() + first * 8, 4, 8, 6, *region);
+    }
+    iconAtlas.flush();
+    Mesh iconMesh = createMesh(iconVertices, iconIndices, 8);
+
+    // Fila de baldosas desde un arreglo de texturas: una capa por imagen del mismo
+    // tamaño, sin márgenes y con GL_REPEAT; cada vértice lleva su capa y toda la
+    // fila también sale con un solo draw call
+    TextureArray tileArray(64, 64, 4);
+    vector<float> tileVertices;
+    vector<unsigned int> tileIndices;
+    for (int i = 0; i < 4; i++) {
+        vector<unsigned char> tile = makeTile(64, iconColors[i]);
+        int layer = tileArray.upload(tile.data(), 64, 64);
+        if (layer < 0) {
+            cout << "Failed to upload tile " << i << endl;
+            return -1;
+        }
+        size_t first = tileVertices.size() / 9;
+        appendQuad(tileVertices, tileIndices, -0.45f + i * 0.25f, -0.8f, 0.2f, 9);
+        for (size_t v = first; v < first + 4; v++)
+            tileVertices[v * 9 + 8] = (float)layer;
+    }
+    Mesh tileMesh = createMesh(tileVertices, tileIndices, 9);
+    setLayerAttribute(3, 9 * sizeof(float), 8 * sizeof(float));
+    // la textura se repite dos veces por baldosa: el arreglo usa GL_REPEAT
+    MaterialUniforms tileUniforms = { { 1.0f, 1.0f, 1.0f, 1.0f }, { 2.0f, 2.0f, 0.0f, 0.0f } };
+    std::unique_ptr<Material> tileMaterial = Material::create(
+        tileShader, { { "uTextures", tileArray.id() } }, materialUniforms, &tileUniforms, sizeof(tileUniforms));
+    if (!tileMaterial) {
+        cout << "Failed to create tile material";
+        return -1;
+    }
+    // las UV ya apuntan al atlas: escala 1 y sin desplazamiento en MaterialData
+    MaterialUniforms iconUniforms = { { 1.0f, 1.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, 0.0f, 0.0f } };
+    std::unique_ptr<Material> iconMaterial = Material::create(
+        ourShader, { { "ourTexture", iconAtlas.texture(0) } }, materialUniforms, &iconUniforms, sizeof(iconUniforms));
+    if (!iconMaterial) {
+        cout << "Failed to create icon material";
+        return -1;
+    }
 
-        glBindTexture(GL_TEXTURE_2D, texture);
-        ourShader.use();
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    // La escena se dibuja en un target del tamaño de la pantalla y se copia al
+    // framebuffer por defecto: el punto de entrada para post-proceso
+    int initialWidth, initialHeight;
+    glfwGetFramebufferSize(window, &initialWidth, &initialHeight);
+    RenderTargetPool targetPool(initialWidth, initialHeight);
+    renderTargets = &targetPool;
+    // Las pasadas se declaran cada frame; el grafo las ordena, descarta las que
+    // nadie consume y comparte texturas entre intermedios que no se solapan
+    RenderGraph renderGraph(targetPool);
 
-        glfwSwapBuffers(window);
+    while(!glfwWindowShouldClose(window)) {
+        // en baja latencia espera a la GPU antes de leer la entrada
+        framePacer.beginFrame();
         glfwPollEvents();
+        processInput(window);
+        // límite de frame: aplicar shaders recargados antes de dibujar
+        shaderReloader.applyPending();
+
+        // Escribir las constantes del frame una sola vez, sin importar cuántos programas haya
+        float timeValue = glfwGetTime();
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        frame.resolution[0] = (float)framebufferWidth;
+        frame.resolution[1] = (float)framebufferHeight;
+        frame.deltaTime = timeValue - lastTime;
+        lastTime = timeValue;
+        // la simulación avanza en pasos fijos; se dibuja el estado interpolado
+        simulation.advance(updateAnimationClock);
+        frame.time = (float)simulation.interpolated().time;
+        frameUniforms.update(frame);
+
+        // el quad mide 1x1 en NDC con vista y proyección identidad: medio framebuffer
+        textureCache.setScreenSize(*wallTexture, framebufferWidth * 0.5f, framebufferHeight * 0.5f);
+        textureCache.update();
+
+        RenderResource sceneColor = renderGraph.createTexture("sceneColor", RenderTargetDesc::screen(RenderTargetFormat::RGBA8));
+        renderGraph.addPass("scene", [&](RenderPassBuilder& pass) {
+            pass.write(sceneColor);
+        }, [&](RenderPassContext&) {
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            materialBinder.apply(*wallMaterial);
+            glBindVertexArray(VAO);
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+            materialBinder.apply(*iconMaterial);
+            glBindVertexArray(iconMesh.VAO);
+            glDrawElements(GL_TRIANGLES, iconMesh.indexCount, GL_UNSIGNED_INT, 0);
+
+            materialBinder.apply(*tileMaterial);
+            glBindVertexArray(tileMesh.VAO);
+            glDrawElements(GL_TRIANGLES, tileMesh.indexCount, GL_UNSIGNED_INT, 0);
+        });
+        renderGraph.addPass("present", [&](RenderPassBuilder& pass) {
+            pass.read(sceneColor);
+            pass.write(renderGraph.backbuffer());
+        }, [&](RenderPassContext& context) {
+            const RenderTarget* source = context.target(sceneColor);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, context.readFramebuffer(sceneColor));
+            glBlitFramebuffer(0, 0, source->width, source->height, 0, 0, context.width, context.height,
+                              GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        });
+        renderGraph.execute();
+        frameUniforms.endFrame();
+        targetPool.endFrame();
+
+        framePacer.endFrame();
     }
 
+    framePacer.printStatistics(cout);
+    renderTargets = nullptr;
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
+    glDeleteVertexArrays(1, &iconMesh.VAO);
+    glDeleteBuffers(1, &iconMesh.VBO);
+    glDeleteBuffers(1, &iconMesh.EBO);
+    glDeleteVertexArrays(1, &tileMesh.VAO);
+    glDeleteBuffers(1, &tileMesh.VBO);
+    glDeleteBuffers(1, &tileMesh.EBO);
     return 0;
 }
 
+Mesh createMesh(const vector<float>& vertices, const vector<unsigned int>& indices, GLsizei stride) {
+    Mesh mesh;
+    mesh.indexCount = (GLsizei)indices.size();
+    glGenVertexArrays(1, &mesh.VAO);
+    glGenBuffers(1, &mesh.VBO);
+    glGenBuffers(1, &mesh.EBO);
+
+    glBindVertexArray(mesh.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+
+    // mismos atributos que la pared; el VAO queda enlazado por si el llamador agrega más
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void *)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void *)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void *)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+    return mesh;
+}
+
+// Agrega un quad blanco de lado size con las UV de la pared; los floats
+// que sobran del stride (más allá de los 8 estándar) quedan en 0
+void appendQuad(vector<float>& vertices, vector<unsigned int>& indices, float left, float bottom, float size, size_t stride) {
+    const float corners[4][4] = {
+        { 1.0f, 1.0f, 1.0f, 1.0f }, // top right
+        { 1.0f, 0.0f, 1.0f, 0.0f }, // bottom right
+        { 0.0f, 0.0f, 0.0f, 0.0f }, // bottom left
+        { 0.0f, 1.0f, 0.0f, 1.0f }, // top left
+    };
+    unsigned int first = (unsigned int)(vertices.size() / stride);
+    for (const float* corner : corners) {
+        float vertex[8] = { left + corner[0] * size, bottom + corner[1] * size, 0.0f,
+                            1.0f, 1.0f, 1.0f, corner[2], corner[3] };
+        vertices.insert(vertices.end(), vertex, vertex + 8);
+        vertices.resize(vertices.size() + stride - 8, 0.0f);
+    }
+    const unsigned int quad[6] = { 0, 1, 3, 1, 2, 3 };
+    for (unsigned int index : quad)
+        indices.push_back(first + index);
+}
+
+// Baldosa de prueba: tablero de 4x4 casillas del color dado y uno más oscuro
+vector<unsigned char> makeTile(int size, const float color[3]) {
+    vector<unsigned char> pixels((size_t)size * size * 4);
+    int square = size / 4;
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            float shade = ((x / square) + (y / square)) % 2 == 0 ? 1.0f : 0.4f;
+            unsigned char* pixel = &pixels[((size_t)y * size + x) * 4];
+            for (int c = 0; c < 3; c++)
+                pixel[c] = (unsigned char)(color[c] * shade * 255.0f);
+            pixel[3] = 255;
+        }
+    }
+    return pixels;
+}
+
+// Icono de prueba: un disco del color dado sobre fondo oscuro, opaco
+vector<unsigned char> makeIcon(int size, const float color[3]) {
+    vector<unsigned char> pixels((size_t)size * size * 4);
+    float center = (size - 1) * 0.5f;
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            float distance = sqrt((x - center) * (x - center) + (y - center) * (y - center));
+            // borde suavizado de un píxel
+            float coverage = fmin(fmax(size * 0.4f - distance, 0.0f), 1.0f);
+            unsigned char* pixel = &pixels[((size_t)y * size + x) * 4];
+            for (int c = 0; c < 3; c++)
+                pixel[c] = (unsigned char)((0.1f + (color[c] - 0.1f) * coverage) * 255.0f);
+            pixel[3] = 255;
+        }
+    }
+    return pixels;
+}
+
+void updateAnimationClock(AnimationClock& state, double dt) {
+    state.time += dt;
+}
+
 void processInput(GLFWwindow* window) {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
         glfwSetWindowShouldClose(window, true);
@@ -147,4 +418,7 @@ void processInput(GLFWwindow* window) {
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0,0, width, height);
+    if (renderTargets) {
+        renderTargets->resize(width, height);
+    }
 }
\ No newline at end of file
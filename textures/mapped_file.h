@@ -0,0 +1,195 @@
+/**
+ * @file mapped_file.h
+ * @brief Archivo proyectado en memoria de solo lectura
+ * @details En POSIX usa mmap, de modo que leer el archivo no copia nada al heap:
+ *          las páginas se cargan bajo demanda desde la caché del sistema. En otras
+ *          plataformas lee el archivo completo a un buffer.
+ */
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPED_FILE_POSIX 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @enum MappedFileAccess
+ * @brief Patrón de acceso esperado, para las sugerencias de madvise
+ */
+enum class MappedFileAccess
+{
+    Normal,     ///< Sin sugerencia
+    Sequential, ///< Lectura de principio a fin: lectura anticipada agresiva
+    Random,     ///< Acceso disperso (p.ej. un índice): sin lectura anticipada
+    WillNeed    ///< Se leerá todo pronto: cargar las páginas ya
+};
+
+/**
+ * @class MappedFile
+ * @brief Vista de solo lectura del contenido de un archivo (RAII, solo movible)
+ */
+class MappedFile
+{
+public:
+    MappedFile() : bytes(nullptr), length(0), mapped(false), opened(false) {}
+
+    explicit MappedFile(const std::string& path) : MappedFile()
+    {
+        open(path);
+    }
+
+    MappedFile(MappedFile&& other) noexcept
+        : bytes(other.bytes), length(other.length), mapped(other.mapped), opened(other.opened),
+          fallback(std::move(other.fallback))
+    {
+        if (!mapped && !fallback.empty())
+            bytes = fallback.data();
+        other.bytes = nullptr;
+        other.length = 0;
+        other.mapped = false;
+        other.opened = false;
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            bytes = other.bytes;
+            length = other.length;
+            mapped = other.mapped;
+            opened = other.opened;
+            fallback = std::move(other.fallback);
+            if (!mapped && !fallback.empty())
+                bytes = fallback.data();
+            other.bytes = nullptr;
+            other.length = 0;
+            other.mapped = false;
+            other.opened = false;
+        }
+        return *this;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() { close(); }
+
+    /**
+     * @brief Proyecta el archivo
+     * @return false si no existe o no se pudo leer
+     */
+    bool open(const std::string& path)
+    {
+        close();
+#ifdef MAPPED_FILE_POSIX
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        length = (size_t)info.st_size;
+        if (length == 0)
+        {
+            // mmap de longitud 0 falla; un archivo vacío es válido
+            ::close(fd);
+            opened = true;
+            return true;
+        }
+        void* address = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        // el mapeo sobrevive al descriptor
+        ::close(fd);
+        if (address == MAP_FAILED)
+        {
+            length = 0;
+            return false;
+        }
+        bytes = static_cast<const unsigned char*>(address);
+        mapped = true;
+        opened = true;
+        return true;
+#else
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file)
+            return false;
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        fallback.resize(size > 0 ? (size_t)size : 0);
+        size_t read = fallback.empty() ? 0 : fread(fallback.data(), 1, fallback.size(), file);
+        fclose(file);
+        if (read != fallback.size())
+        {
+            fallback.clear();
+            return false;
+        }
+        bytes = fallback.data();
+        length = fallback.size();
+        opened = true;
+        return true;
+#endif
+    }
+
+    /**
+     * @brief Indica al sistema cómo se va a leer la proyección
+     * @details Sin efecto si el archivo no está proyectado (lectura con fread).
+     */
+    void advise(MappedFileAccess access) const
+    {
+#ifdef MAPPED_FILE_POSIX
+        if (!mapped)
+            return;
+        int advice = MADV_NORMAL;
+        switch (access)
+        {
+            case MappedFileAccess::Sequential: advice = MADV_SEQUENTIAL; break;
+            case MappedFileAccess::Random: advice = MADV_RANDOM; break;
+            case MappedFileAccess::WillNeed: advice = MADV_WILLNEED; break;
+            default: break;
+        }
+        madvise(const_cast<unsigned char*>(bytes), length, advice);
+#else
+        (void)access;
+#endif
+    }
+
+    /// Libera la proyección
+    void close()
+    {
+#ifdef MAPPED_FILE_POSIX
+        if (mapped)
+            munmap(const_cast<unsigned char*>(bytes), length);
+#endif
+        bytes = nullptr;
+        length = 0;
+        mapped = false;
+        opened = false;
+        fallback.clear();
+    }
+
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+    bool isOpen() const { return opened; }
+
+private:
+    const unsigned char* bytes;
+    size_t length;
+    bool mapped;
+    bool opened;
+    std::vector<unsigned char> fallback;
+};
+
+#endif
@@ -0,0 +1,250 @@
+/**
+ * @file material.h
+ * @brief Materiales: programa + texturas + bloque uniforme, con tabla de enlace precalculada
+ * @details Al crear un material se valida contra la reflexión del shader y se
+ *          hornea una tabla plana (programa, unidad/destino/textura por slot,
+ *          rango del bloque MaterialData). Los samplers se asignan a su unidad una
+ *          sola vez. En el bucle de render MaterialBinder::apply() compara contra
+ *          el material anterior y solo toca el estado GL que cambió, así que el
+ *          costo por draw es constante y pequeño.
+ */
+#ifndef MATERIAL_H
+#define MATERIAL_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "shader_s.h"
+#include "shader_reflection.h"
+#include "texture_source.h"
+#include "uniform_buffer.h"
+
+/**
+ * @struct MaterialTextureSlot
+ * @brief Textura que un material asocia a un sampler del shader
+ * @details Una textura cuyo ID puede cambiar (p.ej. una que llega por streaming)
+ *          se pasa como TextureSource y su ID se resuelve en cada apply().
+ */
+struct MaterialTextureSlot
+{
+    std::string sampler;                          ///< Nombre del uniform sampler en GLSL (p.ej. "ourTexture")
+    unsigned int texture = 0;                     ///< ID de la textura GL
+    std::shared_ptr<const TextureSource> source;  ///< Textura con ID variable, en lugar de texture
+
+    MaterialTextureSlot(const std::string& sampler, unsigned int texture) : sampler(sampler), texture(texture) {}
+    MaterialTextureSlot(const std::string& sampler, std::shared_ptr<const TextureSource> source)
+        : sampler(sampler), source(std::move(source))
+    {
+    }
+};
+
+/**
+ * @struct MaterialTextureBinding
+ * @brief Entrada horneada de la tabla de enlace: qué textura va en qué unidad
+ */
+struct MaterialTextureBinding
+{
+    unsigned int unit;                           ///< Unidad de textura (GL_TEXTURE0 + unit)
+    GLenum target;                               ///< Destino deducido del tipo del sampler
+    unsigned int texture;                        ///< ID de la textura GL
+    std::shared_ptr<const TextureSource> source; ///< Si no es nulo, el ID sale de aquí al aplicar
+
+    /// ID a enlazar ahora
+    unsigned int textureId() const { return source ? source->textureId() : texture; }
+};
+
+/**
+ * @class Material
+ * @brief Material horneado e inmutable (salvo el contenido de su bloque uniforme)
+ */
+class Material
+{
+public:
+    /**
+     * @brief Valida y hornea un material
+     * @param shader Shader con el que se dibuja
+     * @param textures Texturas por nombre de sampler
+     * @param uniformBuffer UBO compartido donde reservar el bloque del material
+     * @param uniforms Contenido del bloque MaterialData (layout std140), o nullptr
+     * @param uniformSize Tamaño de uniforms en bytes
+     * @return El material, o nullptr si no coincide con la interfaz del shader
+     */
+    static std::unique_ptr<Material> create(Shader& shader, const std::vector<MaterialTextureSlot>& textures,
+                                            MaterialUniformBuffer& uniformBuffer,
+                                            const void* uniforms = nullptr, size_t uniformSize = 0)
+    {
+        std::unique_ptr<Material> material(new Material());
+        material->shader = &shader;
+        material->slots = textures;
+        material->uniformBuffer = &uniformBuffer;
+        if (!material->bake())
+            return nullptr;
+
+        if (uniforms && uniformSize > 0)
+        {
+            const ShaderUniformBlockInfo* block = shader.reflection()->findBlock("MaterialData");
+            if (block && (size_t)block->dataSize > uniformSize)
+            {
+                std::cout << "ERROR::MATERIAL::BLOQUE_INCOMPLETO: MaterialData requiere " << block->dataSize
+                          << " bytes y se dieron " << uniformSize << std::endl;
+                return nullptr;
+            }
+            material->block = uniformBuffer.allocate(uniforms, uniformSize);
+            material->hasBlock = true;
+        }
+        return material;
+    }
+
+    /// Actualiza el contenido del bloque MaterialData (p.ej. un tinte animado)
+    void setUniforms(const void* uniforms)
+    {
+        if (hasBlock)
+            uniformBuffer->write(block, uniforms);
+    }
+
+    unsigned int programId() const { return program; }
+    const std::vector<MaterialTextureBinding>& textureBindings() const { return bindings; }
+
+private:
+    friend class MaterialBinder;
+
+    Shader* shader = nullptr;
+    std::vector<MaterialTextureSlot> slots;
+    MaterialUniformBuffer* uniformBuffer = nullptr;
+
+    // tabla horneada
+    unsigned int program = 0;
+    std::vector<MaterialTextureBinding> bindings;
+    MaterialBlock block;
+    bool hasBlock = false;
+
+    Material() {}
+
+    /**
+     * @brief Resuelve samplers a unidades y los fija en el programa
+     * @details Se repite si la recarga en caliente cambia el programa del shader.
+     */
+    bool bake()
+    {
+        std::shared_ptr<const ShaderReflection> reflection = shader->reflection();
+        bindings.clear();
+        bool ok = true;
+        shader->use();
+        for (size_t i = 0; i < slots.size(); i++)
+        {
+            const ShaderSamplerInfo* sampler = reflection->findSampler(slots[i].sampler);
+            if (!sampler)
+            {
+                std::cout << "ERROR::MATERIAL::SAMPLER_INEXISTENTE: " << slots[i].sampler << std::endl;
+                ok = false;
+                continue;
+            }
+            MaterialTextureBinding binding;
+            binding.unit = (unsigned int)i;
+            binding.target = samplerTextureTarget(sampler->type);
+            binding.texture = slots[i].texture;
+            binding.source = slots[i].source;
+            // asignar la unidad una sola vez: el valor queda guardado en el programa
+            glUniform1i(sampler->location, (int)binding.unit);
+            bindings.push_back(binding);
+        }
+        for (const ShaderSamplerInfo& sampler : reflection->samplers())
+        {
+            bool bound = false;
+            for (const MaterialTextureSlot& slot : slots)
+                bound = bound || slot.sampler == sampler.name;
+            if (!bound)
+                std::cout << "ADVERTENCIA::MATERIAL::SAMPLER_SIN_TEXTURA: " << sampler.name << std::endl;
+        }
+        program = shader->ID;
+        return ok;
+    }
+};
+
+/**
+ * @class MaterialBinder
+ * @brief Aplica materiales recordando el estado GL que dejó el anterior
+ * @note Si otro código cambia programa, texturas o el bloque de material por su
+ *       cuenta, llamar a invalidate() antes del siguiente apply().
+ */
+class MaterialBinder
+{
+public:
+    static const unsigned int MAX_UNITS = 16;
+
+    MaterialBinder() { invalidate(); }
+
+    /**
+     * @brief Deja listo el estado para dibujar con el material
+     */
+    void apply(Material& material)
+    {
+        // la recarga en caliente puede haber cambiado el programa del shader
+        if (material.shader->ID != material.program)
+        {
+            material.bake();
+            currentProgram = material.program;
+            glUseProgram(currentProgram);
+        }
+        if (material.program != currentProgram)
+        {
+            glUseProgram(material.program);
+            currentProgram = material.program;
+        }
+        for (const MaterialTextureBinding& binding : material.bindings)
+        {
+            if (binding.unit >= MAX_UNITS)
+                continue;
+            unsigned int texture = binding.textureId();
+            if (boundTextures[binding.unit] == texture && boundTargets[binding.unit] == binding.target)
+                continue;
+            if (activeUnit != binding.unit)
+            {
+                glActiveTexture(GL_TEXTURE0 + binding.unit);
+                activeUnit = binding.unit;
+            }
+            glBindTexture(binding.target, texture);
+            boundTextures[binding.unit] = texture;
+            boundTargets[binding.unit] = binding.target;
+        }
+        if (material.hasBlock)
+        {
+            unsigned int buffer = material.uniformBuffer->id();
+            if (buffer != blockBuffer || material.block.offset != blockOffset)
+            {
+                material.uniformBuffer->bind(material.block);
+                blockBuffer = buffer;
+                blockOffset = material.block.offset;
+            }
+        }
+    }
+
+    /// Olvida el estado recordado; el siguiente apply() lo enlaza todo
+    void invalidate()
+    {
+        currentProgram = 0;
+        activeUnit = MAX_UNITS;
+        blockBuffer = 0;
+        blockOffset = 0;
+        for (unsigned int i = 0; i < MAX_UNITS; i++)
+        {
+            boundTextures[i] = 0;
+            boundTargets[i] = 0;
+        }
+    }
+
+private:
+    unsigned int currentProgram;
+    unsigned int activeUnit;
+    unsigned int boundTextures[MAX_UNITS];
+    GLenum boundTargets[MAX_UNITS];
+    unsigned int blockBuffer;
+    size_t blockOffset;
+};
+
+#endif
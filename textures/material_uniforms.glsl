@@ -0,0 +1,7 @@
+// Constantes por material.
+// Espejo de MaterialUniforms en uniform_buffer.h (layout std140, binding 1).
+layout (std140) uniform MaterialData
+{
+    vec4 uTint;
+    vec4 uUvScaleOffset; // xy escala, zw desplazamiento
+};
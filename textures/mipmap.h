@@ -0,0 +1,636 @@
+/**
+ * @file mipmap.h
+ * @brief Generación de mipmaps en CPU
+ * @details Reemplaza a glGenerateMipmap cuando se quiere una cadena de mipmaps
+ *          determinista (igual en todo driver) o calculada fuera del hilo de render,
+ *          p.ej. al cocinar texturas. No depende de GL.
+ *
+ *          Filtros: caja 2x2 (exacto en enteros) y Kaiser o Lanczos-3 separables
+ *          de 12 taps, calculados en float. Con sRGB se filtra en espacio lineal y
+ *          el alfa se deja lineal. Los núcleos tienen versión SSE2, AVX2 y NEON,
+ *          elegida al compilar (-msse2 es el mínimo en x86-64; -mavx2 habilita
+ *          AVX2), y una escalar que sirve de referencia. Las filas de cada nivel
+ *          se reparten en el JobSystem.
+ */
+#ifndef MIPMAP_H
+#define MIPMAP_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "job_system.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MIPMAP_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MIPMAP_SSE2 1
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MIPMAP_NEON 1
+#endif
+
+/**
+ * @struct MipLevel
+ * @brief Un nivel de la cadena, con filas contiguas de 8 bits por canal
+ */
+struct MipLevel
+{
+    int width;
+    int height;
+    std::vector<unsigned char> pixels;
+};
+
+/**
+ * @enum MipFilter
+ * @brief Filtro de reducción
+ */
+enum class MipFilter
+{
+    Box,    ///< Promedio 2x2, como glGenerateMipmap
+    Kaiser, ///< Sinc con ventana de Kaiser (alfa 4): nítido, con poco ringing
+    Lanczos ///< Lanczos-3: el más nítido, algo de ringing en bordes duros
+};
+
+/**
+ * @struct MipOptions
+ * @brief Cómo generar la cadena
+ */
+struct MipOptions
+{
+    MipFilter filter = MipFilter::Box;
+    bool srgb = false;    ///< Colores en sRGB: se filtran en lineal
+    bool simd = true;     ///< false fuerza los núcleos escalares (referencia)
+    bool parallel = true; ///< Repartir las filas en defaultJobSystem()
+};
+
+/**
+ * @brief Cantidad de niveles de una cadena completa (hasta 1x1)
+ */
+inline int mipLevelCount(int width, int height)
+{
+    int levels = 1;
+    while (width > 1 || height > 1)
+    {
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+        levels++;
+    }
+    return levels;
+}
+
+/**
+ * @brief Reduce un nivel a la mitad con un filtro de caja 2x2
+ * @details Con dimensiones impares la última columna/fila se repite (clamp).
+ *          Versión escalar: es la referencia de downsampleBoxRows.
+ */
+inline void downsampleBox(const unsigned char* source, int width, int height, int channels,
+                          unsigned char* destination, int destinationWidth, int destinationHeight)
+{
+    for (int y = 0; y < destinationHeight; y++)
+    {
+        const unsigned char* row0 = source + (size_t)std::min(2 * y, height - 1) * width * channels;
+        const unsigned char* row1 = source + (size_t)std::min(2 * y + 1, height - 1) * width * channels;
+        unsigned char* out = destination + (size_t)y * destinationWidth * channels;
+        for (int x = 0; x < destinationWidth; x++)
+        {
+            int x0 = std::min(2 * x, width - 1) * channels;
+            int x1 = std::min(2 * x + 1, width - 1) * channels;
+            for (int c = 0; c < channels; c++)
+            {
+                int sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+                out[x * channels + c] = (unsigned char)((sum + 2) >> 2);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Promedio de cada byte con su vecino a `channels` bytes, en dos filas
+ * @details result[i] = (row0[i] + row0[i+c] + row1[i] + row1[i+c] + 2) >> 2 para
+ *          i en [0, count). Lee hasta row[count + channels - 1].
+ */
+inline void averageBoxPairs(const unsigned char* row0, const unsigned char* row1, int channels,
+                            unsigned char* result, size_t count, bool simd)
+{
+    size_t i = 0;
+    if (simd)
+    {
+#if defined(MIPMAP_AVX2)
+        const __m256i twoWide = _mm256_set1_epi16(2);
+        for (; i + 32 <= count; i += 32)
+        {
+            __m256i a = _mm256_loadu_si256((const __m256i*)(row0 + i));
+            __m256i b = _mm256_loadu_si256((const __m256i*)(row0 + i + channels));
+            __m256i c = _mm256_loadu_si256((const __m256i*)(row1 + i));
+            __m256i d = _mm256_loadu_si256((const __m256i*)(row1 + i + channels));
+            __m256i low = _mm256_add_epi16(
+                _mm256_add_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(a)), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(b))),
+                _mm256_add_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(c)), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(d))));
+            __m256i high = _mm256_add_epi16(
+                _mm256_add_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(a, 1)), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(b, 1))),
+                _mm256_add_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(c, 1)), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(d, 1))));
+            low = _mm256_srli_epi16(_mm256_add_epi16(low, twoWide), 2);
+            high = _mm256_srli_epi16(_mm256_add_epi16(high, twoWide), 2);
+            // packus empaqueta por carriles de 128 bits; permute restaura el orden
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm256_storeu_si256((__m256i*)(result + i), packed);
+        }
+#endif
+#if defined(MIPMAP_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i two = _mm_set1_epi16(2);
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i*)(row0 + i));
+            __m128i b = _mm_loadu_si128((const __m128i*)(row0 + i + channels));
+            __m128i c = _mm_loadu_si128((const __m128i*)(row1 + i));
+            __m128i d = _mm_loadu_si128((const __m128i*)(row1 + i + channels));
+            __m128i low = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)),
+                                        _mm_add_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(d, zero)));
+            __m128i high = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)),
+                                         _mm_add_epi16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(d, zero)));
+            low = _mm_srli_epi16(_mm_add_epi16(low, two), 2);
+            high = _mm_srli_epi16(_mm_add_epi16(high, two), 2);
+            _mm_storeu_si128((__m128i*)(result + i), _mm_packus_epi16(low, high));
+        }
+#elif defined(MIPMAP_NEON)
+        for (; i + 16 <= count; i += 16)
+        {
+            uint8x16_t a = vld1q_u8(row0 + i);
+            uint8x16_t b = vld1q_u8(row0 + i + channels);
+            uint8x16_t c = vld1q_u8(row1 + i);
+            uint8x16_t d = vld1q_u8(row1 + i + channels);
+            uint16x8_t low = vaddq_u16(vaddl_u8(vget_low_u8(a), vget_low_u8(b)), vaddl_u8(vget_low_u8(c), vget_low_u8(d)));
+            uint16x8_t high = vaddq_u16(vaddl_u8(vget_high_u8(a), vget_high_u8(b)), vaddl_u8(vget_high_u8(c), vget_high_u8(d)));
+            // vrshrn redondea: (x + 2) >> 2
+            vst1q_u8(result + i, vcombine_u8(vrshrn_n_u16(low, 2), vrshrn_n_u16(high, 2)));
+        }
+#endif
+    }
+    for (; i < count; i++)
+        result[i] = (unsigned char)((row0[i] + row0[i + channels] + row1[i] + row1[i + channels] + 2) >> 2);
+}
+
+/**
+ * @brief Filtro de caja 2x2 sobre las filas [firstRow, lastRow) del nivel destino
+ * @details Mismo resultado que downsampleBox, bit a bit. Promedia cada byte con el
+ *          del píxel vecino en vectores y luego se queda con los píxeles pares.
+ */
+inline void downsampleBoxRows(const unsigned char* source, int width, int height, int channels,
+                              unsigned char* destination, int destinationWidth,
+                              int firstRow, int lastRow, bool simd)
+{
+    if (width < 2)
+    {
+        for (int y = firstRow; y < lastRow; y++)
+        {
+            const unsigned char* row0 = source + (size_t)std::min(2 * y, height - 1) * channels;
+            const unsigned char* row1 = source + (size_t)std::min(2 * y + 1, height - 1) * channels;
+            for (int c = 0; c < channels; c++)
+                destination[(size_t)y * channels + c] = (unsigned char)((2 * row0[c] + 2 * row1[c] + 2) >> 2);
+        }
+        return;
+    }
+    size_t stride = (size_t)width * channels;
+    size_t pairs = (size_t)(2 * destinationWidth - 1) * channels;
+    std::vector<unsigned char> averaged(pairs);
+    for (int y = firstRow; y < lastRow; y++)
+    {
+        const unsigned char* row0 = source + (size_t)std::min(2 * y, height - 1) * stride;
+        const unsigned char* row1 = source + (size_t)std::min(2 * y + 1, height - 1) * stride;
+        unsigned char* out = destination + (size_t)y * destinationWidth * channels;
+        averageBoxPairs(row0, row1, channels, averaged.data(), pairs, simd);
+        if (channels == 4)
+        {
+            for (int x = 0; x < destinationWidth; x++)
+                memcpy(out + 4 * x, averaged.data() + 8 * (size_t)x, 4);
+        }
+        else
+        {
+            for (int x = 0; x < destinationWidth; x++)
+            {
+                for (int c = 0; c < channels; c++)
+                    out[x * channels + c] = averaged[(size_t)2 * x * channels + c];
+            }
+        }
+    }
+}
+
+/**
+ * @struct MipKernel
+ * @brief Pesos del filtro separable de reducción 2:1
+ * @details El píxel destino x toma las muestras 2x + first + k, k en [0, weights).
+ *          En 2:1 la fase es siempre la misma, así que basta una tabla de pesos.
+ */
+struct MipKernel
+{
+    int first;
+    std::vector<float> weights;
+};
+
+/// Función de Bessel modificada de orden 0 (serie), para la ventana de Kaiser
+inline double besselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; k++)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+    return sum;
+}
+
+/**
+ * @brief Pesos normalizados del filtro
+ */
+inline MipKernel mipKernel(MipFilter filter)
+{
+    MipKernel kernel;
+    if (filter == MipFilter::Box)
+    {
+        kernel.first = 0;
+        kernel.weights = { 0.5f, 0.5f };
+        return kernel;
+    }
+    const double pi = 3.14159265358979323846;
+    const double radius = 3.0; // en píxeles destino
+    const double alpha = 4.0;
+    kernel.first = -5;
+    double total = 0.0;
+    std::vector<double> weights;
+    for (int k = 0; k < 12; k++)
+    {
+        // distancia del centro de la muestra al del píxel destino, en píxeles destino
+        double t = (kernel.first + k - 0.5) / 2.0;
+        double sinc = std::fabs(t) < 1e-9 ? 1.0 : std::sin(pi * t) / (pi * t);
+        double window;
+        if (filter == MipFilter::Lanczos)
+        {
+            double u = t / radius;
+            window = std::fabs(u) < 1e-9 ? 1.0 : std::sin(pi * u) / (pi * u);
+        }
+        else
+        {
+            double u = t / radius;
+            window = besselI0(alpha * std::sqrt(std::max(0.0, 1.0 - u * u))) / besselI0(alpha);
+        }
+        weights.push_back(sinc * window);
+        total += sinc * window;
+    }
+    for (double weight : weights)
+        kernel.weights.push_back((float)(weight / total));
+    return kernel;
+}
+
+/// Tabla sRGB (8 bits) -> lineal
+inline const float* srgbToLinearTable()
+{
+    static const std::vector<float> table = []() {
+        std::vector<float> values(256);
+        for (int i = 0; i < 256; i++)
+        {
+            double c = i / 255.0;
+            values[i] = (float)(c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+        }
+        return values;
+    }();
+    return table.data();
+}
+
+/// Resolución de la tabla lineal -> sRGB
+const int LINEAR_TO_SRGB_STEPS = 16384;
+
+/// Tabla lineal (cuantizado a 1/16383) -> sRGB de 8 bits
+inline const unsigned char* linearToSrgbTable()
+{
+    static const std::vector<unsigned char> table = []() {
+        std::vector<unsigned char> values(LINEAR_TO_SRGB_STEPS);
+        for (int i = 0; i < LINEAR_TO_SRGB_STEPS; i++)
+        {
+            double l = i / (double)(LINEAR_TO_SRGB_STEPS - 1);
+            double c = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+            values[i] = (unsigned char)std::min(255.0, std::floor(c * 255.0 + 0.5));
+        }
+        return values;
+    }();
+    return table.data();
+}
+
+/// true si el canal es alfa (siempre lineal): el último con 2 o 4 canales
+inline bool isAlphaChannel(int channel, int channels)
+{
+    return (channels == 2 || channels == 4) && channel == channels - 1;
+}
+
+/**
+ * @brief Convierte píxeles de 8 bits a float en [0, 1] (lineal si srgb)
+ */
+inline void decodeMipRow(const unsigned char* source, float* destination, size_t pixels, int channels, bool srgb)
+{
+    const float* table = srgbToLinearTable();
+    for (size_t p = 0; p < pixels; p++)
+    {
+        for (int c = 0; c < channels; c++)
+        {
+            unsigned char value = source[p * channels + c];
+            destination[p * channels + c] = (srgb && !isAlphaChannel(c, channels)) ? table[value] : value * (1.0f / 255.0f);
+        }
+    }
+}
+
+/**
+ * @brief Convierte float en [0, 1] a 8 bits con redondeo (y a sRGB si srgb)
+ */
+inline void encodeMipRow(const float* source, unsigned char* destination, size_t pixels, int channels, bool srgb, bool simd)
+{
+    size_t count = pixels * channels;
+    if (srgb)
+    {
+        const unsigned char* table = linearToSrgbTable();
+        for (size_t p = 0; p < pixels; p++)
+        {
+            for (int c = 0; c < channels; c++)
+            {
+                float value = std::min(1.0f, std::max(0.0f, source[p * channels + c]));
+                destination[p * channels + c] = isAlphaChannel(c, channels)
+                    ? (unsigned char)(value * 255.0f + 0.5f)
+                    : table[(int)(value * (LINEAR_TO_SRGB_STEPS - 1) + 0.5f)];
+            }
+        }
+        return;
+    }
+    size_t i = 0;
+    if (simd)
+    {
+#if defined(MIPMAP_SSE2)
+        const __m128 scale = _mm_set1_ps(255.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 zero = _mm_setzero_ps();
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i v[4];
+            for (int k = 0; k < 4; k++)
+            {
+                __m128 value = _mm_add_ps(_mm_mul_ps(_mm_max_ps(_mm_loadu_ps(source + i + 4 * k), zero), scale), half);
+                v[k] = _mm_cvttps_epi32(_mm_min_ps(value, _mm_set1_ps(255.0f)));
+            }
+            __m128i packed = _mm_packus_epi16(_mm_packs_epi32(v[0], v[1]), _mm_packs_epi32(v[2], v[3]));
+            _mm_storeu_si128((__m128i*)(destination + i), packed);
+        }
+#elif defined(MIPMAP_NEON)
+        const float32x4_t scale = vdupq_n_f32(255.0f);
+        const float32x4_t half = vdupq_n_f32(0.5f);
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        for (; i + 8 <= count; i += 8)
+        {
+            uint32x4_t a = vcvtq_u32_f32(vminq_f32(vaddq_f32(vmulq_f32(vmaxq_f32(vld1q_f32(source + i), zero), scale), half), scale));
+            uint32x4_t b = vcvtq_u32_f32(vminq_f32(vaddq_f32(vmulq_f32(vmaxq_f32(vld1q_f32(source + i + 4), zero), scale), half), scale));
+            vst1_u8(destination + i, vmovn_u16(vcombine_u16(vmovn_u32(a), vmovn_u32(b))));
+        }
+#endif
+    }
+    for (; i < count; i++)
+    {
+        float value = std::min(255.0f, std::max(0.0f, source[i]) * 255.0f + 0.5f);
+        destination[i] = (unsigned char)value;
+    }
+}
+
+/**
+ * @brief destination[i] += weight * source[i]
+ * @details Núcleo del paso vertical: contiguo, así que vectoriza con cualquier
+ *          cantidad de canales.
+ */
+inline void accumulateMipRow(float* destination, const float* source, float weight, size_t count, bool simd)
+{
+    size_t i = 0;
+    if (simd)
+    {
+#if defined(MIPMAP_AVX2)
+        const __m256 w8 = _mm256_set1_ps(weight);
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(destination + i, _mm256_add_ps(_mm256_loadu_ps(destination + i), _mm256_mul_ps(_mm256_loadu_ps(source + i), w8)));
+#endif
+#if defined(MIPMAP_SSE2)
+        const __m128 w4 = _mm_set1_ps(weight);
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(destination + i, _mm_add_ps(_mm_loadu_ps(destination + i), _mm_mul_ps(_mm_loadu_ps(source + i), w4)));
+#elif defined(MIPMAP_NEON)
+        for (; i + 4 <= count; i += 4)
+            vst1q_f32(destination + i, vmlaq_n_f32(vld1q_f32(destination + i), vld1q_f32(source + i), weight));
+#endif
+    }
+    for (; i < count; i++)
+        destination[i] += weight * source[i];
+}
+
+/**
+ * @brief Paso horizontal: reduce una fila a la mitad con el filtro dado
+ * @details Con 4 canales cada píxel es un vector de 4 floats; el resto de los
+ *          casos y los bordes (con clamp) van por la versión escalar.
+ */
+inline void filterMipRowHorizontal(const float* source, int width, int channels, float* destination,
+                                   int destinationWidth, const MipKernel& kernel, bool simd)
+{
+    int taps = (int)kernel.weights.size();
+    const float* weights = kernel.weights.data();
+    // píxeles destino cuyas muestras caen todas dentro de la fila
+    int interiorBegin = std::min(destinationWidth, std::max(0, (-kernel.first + 1) / 2));
+    int span = width - kernel.first - taps;
+    int interiorEnd = std::max(interiorBegin, std::min(destinationWidth, span < 0 ? 0 : span / 2 + 1));
+
+    int x = 0;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        int end = pass == 0 ? interiorBegin : destinationWidth;
+        for (; x < end; x++)
+        {
+            float* out = destination + (size_t)x * channels;
+            for (int c = 0; c < channels; c++)
+                out[c] = 0.0f;
+            for (int k = 0; k < taps; k++)
+            {
+                int sample = std::min(width - 1, std::max(0, 2 * x + kernel.first + k));
+                for (int c = 0; c < channels; c++)
+                    out[c] += weights[k] * source[(size_t)sample * channels + c];
+            }
+        }
+        if (pass == 1)
+            break;
+        if (simd && channels == 4)
+        {
+#if defined(MIPMAP_SSE2)
+            for (; x < interiorEnd; x++)
+            {
+                const float* in = source + (size_t)(2 * x + kernel.first) * 4;
+                __m128 sum = _mm_setzero_ps();
+                for (int k = 0; k < taps; k++)
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(in + 4 * k), _mm_set1_ps(weights[k])));
+                _mm_storeu_ps(destination + (size_t)x * 4, sum);
+            }
+#elif defined(MIPMAP_NEON)
+            for (; x < interiorEnd; x++)
+            {
+                const float* in = source + (size_t)(2 * x + kernel.first) * 4;
+                float32x4_t sum = vdupq_n_f32(0.0f);
+                for (int k = 0; k < taps; k++)
+                    sum = vmlaq_n_f32(sum, vld1q_f32(in + 4 * k), weights[k]);
+                vst1q_f32(destination + (size_t)x * 4, sum);
+            }
+#endif
+        }
+        for (; x < interiorEnd; x++)
+        {
+            const float* in = source + (size_t)(2 * x + kernel.first) * channels;
+            float* out = destination + (size_t)x * channels;
+            for (int c = 0; c < channels; c++)
+            {
+                float sum = 0.0f;
+                for (int k = 0; k < taps; k++)
+                    sum += weights[k] * in[(size_t)k * channels + c];
+                out[c] = sum;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Reparte [0, count) en el JobSystem o lo ejecuta en este hilo
+ */
+inline void mipParallelFor(const MipOptions& options, size_t count, size_t grain,
+                           const std::function<void(size_t, size_t)>& body)
+{
+    if (options.parallel)
+        defaultJobSystem().parallelFor(count, grain, body);
+    else
+        body(0, count);
+}
+
+/**
+ * @brief Genera la cadena completa de mipmaps a partir de un nivel 0 ya armado
+ * @details El nivel 0 se mueve a la cadena sin copiarse: conviene decodificar
+ *          la imagen directo en base.pixels (ver decodeImageAsset).
+ * @param base Nivel 0, con filas contiguas
+ * @param channels Canales por píxel
+ * @param options Filtro, espacio de color y paralelismo
+ * @param maxLevels Niveles a generar contando el 0; 0 = hasta 1x1
+ * @return Niveles del 0 al 1x1 (o al último de maxLevels)
+ */
+inline std::vector<MipLevel> generateMipChain(MipLevel base, int channels, const MipOptions& options = MipOptions(),
+                                              int maxLevels = 0)
+{
+    int width = base.width;
+    int height = base.height;
+    size_t levelCount = (size_t)mipLevelCount(width, height);
+    if (maxLevels > 0)
+        levelCount = std::min(levelCount, (size_t)maxLevels);
+    std::vector<MipLevel> chain;
+    chain.reserve(levelCount);
+    chain.push_back(std::move(base));
+    if (levelCount == 1)
+        return chain;
+    const unsigned char* pixels = chain[0].pixels.data();
+
+    // caja en lineal: exacto en enteros, cada nivel sale del anterior
+    if (options.filter == MipFilter::Box && !options.srgb)
+    {
+        while (chain.size() < levelCount)
+        {
+            const MipLevel& previous = chain.back();
+            MipLevel next;
+            next.width = std::max(1, previous.width / 2);
+            next.height = std::max(1, previous.height / 2);
+            next.pixels.resize((size_t)next.width * next.height * channels);
+            size_t grain = std::max<size_t>(1, (64 * 1024) / ((size_t)next.width * channels + 1));
+            mipParallelFor(options, (size_t)next.height, grain, [&](size_t begin, size_t end) {
+                downsampleBoxRows(previous.pixels.data(), previous.width, previous.height, channels,
+                                  next.pixels.data(), next.width, (int)begin, (int)end, options.simd);
+            });
+            chain.push_back(std::move(next));
+        }
+        return chain;
+    }
+
+    // el resto se filtra en float (lineal), y cada nivel sale del float del anterior
+    // para no acumular el error de cuantizar a 8 bits
+    MipKernel kernel = mipKernel(options.filter);
+    std::vector<float> current((size_t)width * height * channels);
+    mipParallelFor(options, (size_t)height, 16, [&](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; y++)
+            decodeMipRow(pixels + y * width * channels, current.data() + y * width * channels, (size_t)width, channels, options.srgb);
+    });
+
+    int currentWidth = width;
+    int currentHeight = height;
+    std::vector<float> horizontal;
+    std::vector<float> next;
+    while (chain.size() < levelCount)
+    {
+        int nextWidth = std::max(1, currentWidth / 2);
+        int nextHeight = std::max(1, currentHeight / 2);
+        size_t sourceStride = (size_t)currentWidth * channels;
+        size_t stride = (size_t)nextWidth * channels;
+        size_t grain = std::max<size_t>(1, (32 * 1024) / (sourceStride + 1));
+
+        horizontal.assign((size_t)currentHeight * stride, 0.0f);
+        mipParallelFor(options, (size_t)currentHeight, grain, [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; y++)
+                filterMipRowHorizontal(current.data() + y * sourceStride, currentWidth, channels,
+                                       horizontal.data() + y * stride, nextWidth, kernel, options.simd);
+        });
+
+        MipLevel level;
+        level.width = nextWidth;
+        level.height = nextHeight;
+        level.pixels.resize((size_t)nextHeight * stride);
+        next.assign((size_t)nextHeight * stride, 0.0f);
+        mipParallelFor(options, (size_t)nextHeight, grain, [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; y++)
+            {
+                float* out = next.data() + y * stride;
+                for (size_t k = 0; k < kernel.weights.size(); k++)
+                {
+                    int row = std::min(currentHeight - 1, std::max(0, 2 * (int)y + kernel.first + (int)k));
+                    accumulateMipRow(out, horizontal.data() + (size_t)row * stride, kernel.weights[k], stride, options.simd);
+                }
+                encodeMipRow(out, level.pixels.data() + y * stride, (size_t)nextWidth, channels, options.srgb, options.simd);
+            }
+        });
+        chain.push_back(std::move(level));
+        current.swap(next);
+        currentWidth = nextWidth;
+        currentHeight = nextHeight;
+    }
+    return chain;
+}
+
+/**
+ * @brief Genera la cadena completa de mipmaps
+ * @param pixels Nivel 0
+ * @param width Ancho del nivel 0
+ * @param height Alto del nivel 0
+ * @param channels Canales por píxel
+ * @param options Filtro, espacio de color y paralelismo
+ * @return Niveles del 0 (copia de la entrada) al 1x1
+ */
+inline std::vector<MipLevel> generateMipChain(const unsigned char* pixels, int width, int height, int channels,
+                                              const MipOptions& options = MipOptions())
+{
+    MipLevel base;
+    base.width = width;
+    base.height = height;
+    base.pixels.assign(pixels, pixels + (size_t)width * height * channels);
+    return generateMipChain(std::move(base), channels, options);
+}
+
+#endif
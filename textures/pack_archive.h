@@ -0,0 +1,243 @@
+/**
+ * @file pack_archive.h
+ * @brief Archivo empaquetado de assets (.lpak) y su lector
+ * @details Un .lpak agrupa muchos assets en un solo archivo que se proyecta en
+ *          memoria una vez: abrir un asset es buscar su hash en el índice, sin
+ *          open/stat por archivo y sin depender de rutas sueltas.
+ *
+ *          Disposición (little-endian):
+ *            PackHeader | datos de cada entrada (alineados) | índice | nombres
+ *          El índice está ordenado por hash del nombre normalizado, así que la
+ *          búsqueda es binaria sobre la proyección. Cada entrada puede ir
+ *          comprimida con LZ4 (bloque); las entradas sin comprimir se leen sin
+ *          copiarse y quedan alineadas para subirse directo (p.ej. un .ltex).
+ *          No depende de GL.
+ */
+#ifndef PACK_ARCHIVE_H
+#define PACK_ARCHIVE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "hash_util.h"
+#include "lz4_block.h"
+#include "mapped_file.h"
+
+/// Identificador al inicio de todo archivo .lpak
+const char PACK_MAGIC[4] = { 'L', 'P', 'A', 'K' };
+/// Versión del formato; se incrementa ante cambios incompatibles
+const uint32_t PACK_VERSION = 1;
+/// Alineación por defecto de los datos de cada entrada
+const uint32_t PACK_DEFAULT_ALIGNMENT = 16;
+
+/**
+ * @enum PackCompression
+ * @brief Compresión de una entrada
+ */
+enum PackCompression : uint32_t
+{
+    PACK_COMPRESSION_NONE = 0, ///< Datos tal cual
+    PACK_COMPRESSION_LZ4 = 1,  ///< Un bloque LZ4
+    PACK_COMPRESSION_ZSTD = 2  ///< Reservado; este lector no lo soporta
+};
+
+/**
+ * @struct PackHeader
+ * @brief Encabezado fijo de 40 bytes
+ */
+struct PackHeader
+{
+    char magic[4];        ///< "LPAK"
+    uint32_t version;     ///< PACK_VERSION
+    uint32_t entryCount;  ///< Entradas del índice
+    uint32_t alignment;   ///< Alineación de los datos de las entradas
+    uint64_t indexOffset; ///< Offset del índice (entryCount PackEntry)
+    uint64_t namesOffset; ///< Offset de la tabla de nombres
+    uint64_t namesSize;   ///< Tamaño de la tabla de nombres
+};
+static_assert(sizeof(PackHeader) == 40, "PackHeader debe medir 40 bytes");
+
+/**
+ * @struct PackEntry
+ * @brief Entrada del índice
+ */
+struct PackEntry
+{
+    uint64_t hash;         ///< fnv1a64 del nombre normalizado; el índice se ordena por este campo
+    uint64_t dataOffset;   ///< Offset de los datos desde el inicio del archivo
+    uint64_t storedSize;   ///< Bytes almacenados (comprimidos o no)
+    uint64_t originalSize; ///< Bytes una vez descomprimidos
+    uint32_t nameOffset;   ///< Offset del nombre dentro de la tabla de nombres
+    uint32_t nameLength;   ///< Longitud del nombre, sin terminador
+    uint32_t compression;  ///< PackCompression
+    uint32_t reserved;     ///< Cero
+};
+static_assert(sizeof(PackEntry) == 48, "PackEntry debe medir 48 bytes");
+
+/**
+ * @class PackArchive
+ * @brief Lector de un .lpak proyectado en memoria
+ * @details Se crea con PackArchive::open; es inmutable, así que puede consultarse
+ *          desde varios hilos a la vez.
+ */
+class PackArchive
+{
+public:
+    /**
+     * @brief Nombre con el que se guarda y busca un asset
+     * @details Separadores '/', sin "./" ni ".." resolubles: "./shaders/../wall.jpg"
+     *          y "wall.jpg" son el mismo asset.
+     */
+    static std::string normalizeName(const std::string& path)
+    {
+        std::string name = std::filesystem::path(path).lexically_normal().generic_string();
+        while (name.compare(0, 2, "./") == 0)
+            name.erase(0, 2);
+        return name;
+    }
+
+    /// Hash de un nombre ya normalizado
+    static uint64_t nameHash(const std::string& name)
+    {
+        return fnv1a64(name.data(), name.size());
+    }
+
+    /**
+     * @brief Proyecta y valida un archivo .lpak
+     * @param path Ruta del archivo
+     * @param error Motivo del rechazo, si falla
+     * @return El archivo abierto, o nullptr
+     */
+    static std::shared_ptr<const PackArchive> open(const std::string& path, std::string& error)
+    {
+        std::shared_ptr<PackArchive> archive(new PackArchive());
+        if (!archive->file.open(path))
+        {
+            error = "no se pudo abrir " + path;
+            return nullptr;
+        }
+        // el índice se consulta por búsqueda binaria: acceso disperso
+        archive->file.advise(MappedFileAccess::Random);
+        if (!archive->parse(error))
+            return nullptr;
+        return archive;
+    }
+
+    PackArchive(const PackArchive&) = delete;
+    PackArchive& operator=(const PackArchive&) = delete;
+
+    /**
+     * @brief Busca una entrada por nombre
+     * @return La entrada dentro de la proyección, o nullptr si no está
+     */
+    const PackEntry* find(const std::string& path) const
+    {
+        std::string name = normalizeName(path);
+        uint64_t hash = nameHash(name);
+        const PackEntry* end = entries + header.entryCount;
+        const PackEntry* entry = std::lower_bound(entries, end, hash,
+            [](const PackEntry& candidate, uint64_t value) { return candidate.hash < value; });
+        // varias entradas pueden compartir hash; se confirma por nombre
+        for (; entry != end && entry->hash == hash; entry++)
+        {
+            if (entry->nameLength == name.size() && memcmp(names + entry->nameOffset, name.data(), name.size()) == 0)
+                return entry;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Obtiene los datos de una entrada
+     * @details Sin compresión, data apunta a la proyección y buffer no se toca;
+     *          comprimida, se descomprime en buffer.
+     * @return false si la entrada está corrupta o su compresión no se soporta
+     */
+    bool read(const PackEntry& entry, const unsigned char*& data, size_t& size, std::vector<unsigned char>& buffer) const
+    {
+        const unsigned char* stored = file.data() + entry.dataOffset;
+        if (entry.compression == PACK_COMPRESSION_NONE)
+        {
+            data = stored;
+            size = (size_t)entry.storedSize;
+            return true;
+        }
+        if (entry.compression != PACK_COMPRESSION_LZ4)
+            return false;
+        buffer.resize((size_t)entry.originalSize);
+        if (!lz4DecompressBlock(stored, (size_t)entry.storedSize, buffer.data(), buffer.size()))
+            return false;
+        data = buffer.data();
+        size = buffer.size();
+        return true;
+    }
+
+    /// Nombre de una entrada
+    std::string name(const PackEntry& entry) const
+    {
+        return std::string(names + entry.nameOffset, entry.nameLength);
+    }
+
+    /// Cantidad de entradas
+    size_t entryCount() const { return header.entryCount; }
+
+    /// Entrada i-ésima, en orden de hash
+    const PackEntry& entry(size_t index) const { return entries[index]; }
+
+private:
+    MappedFile file;
+    PackHeader header;
+    const PackEntry* entries = nullptr;
+    const char* names = nullptr;
+
+    PackArchive() {}
+
+    bool parse(std::string& error)
+    {
+        size_t size = file.size();
+        if (size < sizeof(PackHeader))
+        {
+            error = "archivo demasiado pequeño";
+            return false;
+        }
+        memcpy(&header, file.data(), sizeof(PackHeader));
+        if (memcmp(header.magic, PACK_MAGIC, 4) != 0)
+        {
+            error = "no es un archivo LPAK";
+            return false;
+        }
+        if (header.version != PACK_VERSION)
+        {
+            error = "versión de LPAK no soportada";
+            return false;
+        }
+        uint64_t indexSize = (uint64_t)header.entryCount * sizeof(PackEntry);
+        if (header.indexOffset > size || indexSize > size - header.indexOffset || header.indexOffset % 8 != 0
+            || header.namesOffset > size || header.namesSize > size - header.namesOffset)
+        {
+            error = "índice fuera del archivo";
+            return false;
+        }
+        // la proyección está alineada a página y el índice a 8 bytes: se usa en sitio
+        entries = reinterpret_cast<const PackEntry*>(file.data() + header.indexOffset);
+        names = reinterpret_cast<const char*>(file.data() + header.namesOffset);
+        for (uint32_t i = 0; i < header.entryCount; i++)
+        {
+            const PackEntry& entry = entries[i];
+            if (entry.dataOffset > size || entry.storedSize > size - entry.dataOffset
+                || (uint64_t)entry.nameOffset + entry.nameLength > header.namesSize
+                || (i > 0 && entries[i - 1].hash > entry.hash))
+            {
+                error = "entrada inválida en el índice";
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+#endif
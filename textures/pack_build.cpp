@@ -0,0 +1,213 @@
+/**
+ * @file pack_build.cpp
+ * @brief Herramienta offline que empaqueta assets en un archivo .lpak
+ * @details Recorre los archivos y directorios indicados, guarda cada archivo con
+ *          su ruta relativa a --root (por defecto, el directorio actual) y escribe
+ *          el índice ordenado por hash. Con --lz4 cada entrada se comprime si así
+ *          ocupa al menos un 10% menos.
+ *
+ *          Compilar:  g++ -std=c++17 -O2 pack_build.cpp -o pack_build
+ *          Usar:      ./pack_build assets.lpak [--lz4] [--root DIR] wall.jpg ...
+ *          (los shaders de main.cpp se leen siempre del disco por la recarga en caliente)
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+#include "pack_archive.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+/**
+ * @struct PackInput
+ * @brief Archivo a empaquetar
+ */
+struct PackInput {
+    string name;     ///< Nombre normalizado dentro del pack
+    string path;     ///< Ruta en disco
+    uint64_t hash;
+};
+
+/**
+ * @brief Imprime la forma de uso
+ */
+void printUsage(const char* program) {
+    cout << "Uso: " << program << " <salida.lpak> [--lz4] [--root DIR] [--align N] <archivos o directorios...>" << endl;
+    cout << "  --lz4      comprime con LZ4 las entradas que lo aprovechan" << endl;
+    cout << "  --root     directorio contra el que se guardan los nombres" << endl;
+    cout << "  --align N  alineación de los datos de cada entrada (potencia de 2, por defecto 16)" << endl;
+}
+
+/**
+ * @brief Agrega un archivo o, si es un directorio, todos sus archivos
+ */
+bool collect(const fs::path& input, const fs::path& root, vector<PackInput>& inputs) {
+    error_code error;
+    if (fs::is_directory(input, error)) {
+        for (fs::recursive_directory_iterator it(input, error), end; it != end; it.increment(error)) {
+            if (it->is_regular_file(error) && !collect(it->path(), root, inputs)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (!fs::is_regular_file(input, error)) {
+        cout << "No existe: " << input.string() << endl;
+        return false;
+    }
+    fs::path relative = fs::absolute(input).lexically_normal().lexically_relative(root);
+    if (relative.empty() || *relative.begin() == "..") {
+        cout << input.string() << " está fuera de --root" << endl;
+        return false;
+    }
+    PackInput entry;
+    entry.name = PackArchive::normalizeName(relative.string());
+    entry.path = input.string();
+    entry.hash = PackArchive::nameHash(entry.name);
+    inputs.push_back(entry);
+    return true;
+}
+
+/// Escribe ceros hasta que el offset sea múltiplo de alignment
+bool pad(FILE* file, uint64_t& offset, uint64_t alignment) {
+    static const unsigned char zeros[4096] = { 0 };
+    uint64_t aligned = (offset + alignment - 1) / alignment * alignment;
+    while (offset < aligned) {
+        size_t chunk = (size_t)min<uint64_t>(aligned - offset, sizeof(zeros));
+        if (fwrite(zeros, 1, chunk, file) != chunk) {
+            return false;
+        }
+        offset += chunk;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    string output = argv[1];
+    bool compress = false;
+    uint32_t alignment = PACK_DEFAULT_ALIGNMENT;
+    fs::path root = fs::current_path();
+    vector<string> paths;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--lz4") == 0) {
+            compress = true;
+        } else if (strcmp(argv[i], "--root") == 0 && i + 1 < argc) {
+            root = fs::absolute(argv[++i]).lexically_normal();
+        } else if (strcmp(argv[i], "--align") == 0 && i + 1 < argc) {
+            alignment = (uint32_t)atoi(argv[++i]);
+            if (alignment < 8 || (alignment & (alignment - 1)) != 0) {
+                cout << "--align debe ser una potencia de 2 mayor o igual a 8" << endl;
+                return 1;
+            }
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    vector<PackInput> inputs;
+    for (const string& path : paths) {
+        if (!collect(path, root, inputs)) {
+            return 1;
+        }
+    }
+    // el índice se busca por hash; a igual hash, orden por nombre para que sea determinista
+    sort(inputs.begin(), inputs.end(), [](const PackInput& a, const PackInput& b) {
+        return a.hash != b.hash ? a.hash < b.hash : a.name < b.name;
+    });
+    for (size_t i = 1; i < inputs.size(); i++) {
+        if (inputs[i].name == inputs[i - 1].name) {
+            cout << "Archivo repetido: " << inputs[i].name << endl;
+            return 1;
+        }
+    }
+
+    FILE* file = fopen(output.c_str(), "wb");
+    if (!file) {
+        cout << "No se pudo escribir " << output << endl;
+        return 1;
+    }
+    PackHeader header;
+    memset(&header, 0, sizeof(header));
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    uint64_t offset = sizeof(header);
+
+    vector<PackEntry> entries(inputs.size());
+    string names;
+    uint64_t originalTotal = 0;
+    uint64_t storedTotal = 0;
+    vector<unsigned char> compressed;
+    for (size_t i = 0; ok && i < inputs.size(); i++) {
+        MappedFile source(inputs[i].path);
+        if (!source.isOpen()) {
+            cout << "No se pudo leer " << inputs[i].path << endl;
+            ok = false;
+            break;
+        }
+        source.advise(MappedFileAccess::Sequential);
+        const unsigned char* data = source.data();
+        size_t size = source.size();
+
+        PackEntry& entry = entries[i];
+        memset(&entry, 0, sizeof(entry));
+        entry.hash = inputs[i].hash;
+        entry.originalSize = size;
+        entry.compression = PACK_COMPRESSION_NONE;
+        if (compress && size > 0) {
+            compressed.resize(lz4CompressBound(size));
+            size_t compressedSize = lz4CompressBlock(data, size, compressed.data(), compressed.size());
+            if (compressedSize != 0 && compressedSize < size - size / 10) {
+                data = compressed.data();
+                size = compressedSize;
+                entry.compression = PACK_COMPRESSION_LZ4;
+            }
+        }
+        ok = pad(file, offset, alignment);
+        entry.dataOffset = offset;
+        entry.storedSize = size;
+        ok = ok && (size == 0 || fwrite(data, 1, size, file) == size);
+        offset += size;
+
+        entry.nameOffset = (uint32_t)names.size();
+        entry.nameLength = (uint32_t)inputs[i].name.size();
+        names += inputs[i].name;
+        originalTotal += entry.originalSize;
+        storedTotal += entry.storedSize;
+    }
+
+    ok = ok && pad(file, offset, 8);
+    header.indexOffset = offset;
+    ok = ok && (entries.empty() || fwrite(entries.data(), sizeof(PackEntry), entries.size(), file) == entries.size());
+    offset += entries.size() * sizeof(PackEntry);
+    header.namesOffset = offset;
+    header.namesSize = names.size();
+    ok = ok && (names.empty() || fwrite(names.data(), 1, names.size(), file) == names.size());
+
+    memcpy(header.magic, PACK_MAGIC, 4);
+    header.version = PACK_VERSION;
+    header.entryCount = (uint32_t)entries.size();
+    header.alignment = alignment;
+    ok = ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) {
+        cout << "No se pudo escribir " << output << endl;
+        remove(output.c_str());
+        return 1;
+    }
+    cout << output << ": " << entries.size() << " archivos, " << originalTotal << " -> " << storedTotal << " bytes" << endl;
+    return 0;
+}
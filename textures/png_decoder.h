@@ -0,0 +1,405 @@
+/**
+ * @file png_decoder.h
+ * @brief Decodificador PNG con desfiltrado SIMD
+ * @details Cubre los PNG de 8 bits no entrelazados en gris, gris+alfa, RGB y
+ *          RGBA, que son casi todas las texturas. Los IDAT se descomprimen con el
+ *          inflate de stb_image (stbi_zlib_decode_malloc_guesssize_headerflag) y
+ *          el desfiltrado por filas usa SSE2/AVX2: Up en bloques de 16/32 bytes y
+ *          Sub, Average y Paeth por píxel en registros para 3 y 4 canales. Los
+ *          PNG con paleta, tRNS, 16 bits, entrelazado o CgBI se declinan
+ *          (Unsupported) y los decodifica stb_image.
+ */
+#ifndef PNG_DECODER_H
+#define PNG_DECODER_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "image_decoder.h"
+#include "stb_image.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define PNG_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PNG_SSE2 1
+#endif
+
+/// Tipos de filtro por fila de PNG
+enum PngFilter
+{
+    PNG_FILTER_NONE = 0,
+    PNG_FILTER_SUB = 1,
+    PNG_FILTER_UP = 2,
+    PNG_FILTER_AVERAGE = 3,
+    PNG_FILTER_PAETH = 4
+};
+
+/// Predictor Paeth de referencia
+inline int pngPaeth(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = abs(p - a);
+    int pb = abs(p - b);
+    int pc = abs(p - c);
+    if (pa <= pb && pa <= pc)
+        return a;
+    return pb <= pc ? b : c;
+}
+
+#if defined(PNG_SSE2)
+/// Carga un píxel en los bytes bajos; con 3 bytes lee también el siguiente byte si lo hay
+inline __m128i pngLoadPixel(const uint8_t* p, size_t bytes)
+{
+    uint32_t bits = 0;
+    if (bytes == 4)
+        memcpy(&bits, p, 4);
+    else
+        memcpy(&bits, p, 3);
+    return _mm_cvtsi32_si128((int)bits);
+}
+
+/// Guarda un píxel; con 4 bytes para 3 canales pisa el primer byte del siguiente, que se reescribe después
+inline void pngStorePixel(uint8_t* p, __m128i pixel, size_t bytes)
+{
+    uint32_t bits = (uint32_t)_mm_cvtsi128_si32(pixel);
+    if (bytes == 4)
+        memcpy(p, &bits, 4);
+    else
+        memcpy(p, &bits, 3);
+}
+
+/**
+ * @brief Sub, Average y Paeth con SSE2: un píxel por iteración, sus canales en paralelo
+ * @details La dependencia es entre píxeles vecinos, así que no se puede procesar
+ *          más de un píxel a la vez; se gana con los canales y sin ramas por byte.
+ */
+template <int Bpp>
+inline bool pngUnfilterPixelsSse2(uint8_t* out, const uint8_t* raw, const uint8_t* prior, size_t rowBytes, int filter)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = zero;
+    if (filter == PNG_FILTER_SUB)
+    {
+        for (size_t i = 0; i < rowBytes; i += Bpp)
+        {
+            size_t bytes = i + 4 <= rowBytes ? 4 : Bpp;
+            a = _mm_add_epi8(a, pngLoadPixel(raw + i, bytes));
+            pngStorePixel(out + i, a, bytes);
+        }
+    }
+    else if (filter == PNG_FILTER_AVERAGE)
+    {
+        const __m128i one = _mm_set1_epi8(1);
+        for (size_t i = 0; i < rowBytes; i += Bpp)
+        {
+            size_t bytes = i + 4 <= rowBytes ? 4 : Bpp;
+            __m128i b = pngLoadPixel(prior + i, bytes);
+            // (a + b) >> 1 sin desbordar: el promedio redondea hacia arriba, se corrige el bit
+            __m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+            a = _mm_add_epi8(pngLoadPixel(raw + i, bytes), average);
+            pngStorePixel(out + i, a, bytes);
+        }
+    }
+    else
+    {
+        __m128i a16 = zero, c16 = zero;
+        for (size_t i = 0; i < rowBytes; i += Bpp)
+        {
+            size_t bytes = i + 4 <= rowBytes ? 4 : Bpp;
+            __m128i b16 = _mm_unpacklo_epi8(pngLoadPixel(prior + i, bytes), zero);
+            __m128i pa = _mm_sub_epi16(b16, c16);
+            __m128i pb = _mm_sub_epi16(a16, c16);
+            __m128i pc = _mm_add_epi16(pa, pb);
+            pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+            pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+            pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+            __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+            __m128i useA = _mm_cmpeq_epi16(pa, smallest);
+            __m128i useB = _mm_andnot_si128(useA, _mm_cmpeq_epi16(pb, smallest));
+            __m128i predictor = _mm_or_si128(_mm_and_si128(useA, a16), _mm_and_si128(useB, b16));
+            predictor = _mm_or_si128(predictor, _mm_andnot_si128(_mm_or_si128(useA, useB), c16));
+            __m128i pixel = _mm_add_epi8(pngLoadPixel(raw + i, bytes), _mm_packus_epi16(predictor, predictor));
+            pngStorePixel(out + i, pixel, bytes);
+            a16 = _mm_unpacklo_epi8(pixel, zero);
+            c16 = b16;
+        }
+    }
+    return true;
+}
+#endif
+
+/**
+ * @brief Deshace el filtro de una fila
+ * @param out Fila reconstruida (rowBytes bytes)
+ * @param raw Fila filtrada, sin el byte de filtro
+ * @param prior Fila anterior ya reconstruida (ceros en la primera)
+ * @param bpp Bytes por píxel
+ * @return false si el tipo de filtro no existe
+ */
+inline bool pngUnfilterRow(uint8_t* out, const uint8_t* raw, const uint8_t* prior, size_t rowBytes, int bpp,
+                           int filter, bool simd)
+{
+    size_t i = 0;
+    switch (filter)
+    {
+        case PNG_FILTER_NONE:
+            memcpy(out, raw, rowBytes);
+            return true;
+
+        case PNG_FILTER_UP:
+#if defined(PNG_AVX2)
+            if (simd)
+            {
+                for (; i + 32 <= rowBytes; i += 32)
+                {
+                    __m256i sum = _mm256_add_epi8(_mm256_loadu_si256((const __m256i*)(raw + i)),
+                                                  _mm256_loadu_si256((const __m256i*)(prior + i)));
+                    _mm256_storeu_si256((__m256i*)(out + i), sum);
+                }
+            }
+#endif
+#if defined(PNG_SSE2)
+            if (simd)
+            {
+                for (; i + 16 <= rowBytes; i += 16)
+                {
+                    __m128i sum = _mm_add_epi8(_mm_loadu_si128((const __m128i*)(raw + i)),
+                                               _mm_loadu_si128((const __m128i*)(prior + i)));
+                    _mm_storeu_si128((__m128i*)(out + i), sum);
+                }
+            }
+#endif
+            for (; i < rowBytes; i++)
+                out[i] = (uint8_t)(raw[i] + prior[i]);
+            return true;
+
+        case PNG_FILTER_SUB:
+        case PNG_FILTER_AVERAGE:
+        case PNG_FILTER_PAETH:
+            break;
+
+        default:
+            return false;
+    }
+
+#if defined(PNG_SSE2)
+    if (simd && rowBytes % bpp == 0)
+    {
+        if (bpp == 4)
+            return pngUnfilterPixelsSse2<4>(out, raw, prior, rowBytes, filter);
+        if (bpp == 3)
+            return pngUnfilterPixelsSse2<3>(out, raw, prior, rowBytes, filter);
+    }
+#endif
+    (void)simd;
+
+    for (; i < rowBytes; i++)
+    {
+        int a = i >= (size_t)bpp ? out[i - bpp] : 0;
+        int c = i >= (size_t)bpp ? prior[i - bpp] : 0;
+        int predictor;
+        if (filter == PNG_FILTER_SUB)
+            predictor = a;
+        else if (filter == PNG_FILTER_AVERAGE)
+            predictor = (a + prior[i]) >> 1;
+        else
+            predictor = pngPaeth(a, prior[i], c);
+        out[i] = (uint8_t)(raw[i] + predictor);
+    }
+    return true;
+}
+
+/**
+ * @class PngDecoder
+ * @brief Backend PNG (ver el encabezado del archivo)
+ */
+class PngDecoder : public ImageDecoder
+{
+public:
+    /// @param simd false fuerza el desfiltrado escalar (para comparar)
+    explicit PngDecoder(bool simd = true) : simd(simd) {}
+
+    const char* name() const override { return simd ? "png-simd" : "png-escalar"; }
+
+    ImageDecodeStatus decode(const unsigned char* data, size_t size, unsigned char** pixels,
+                             int* width, int* height, int* channels, int desiredChannels) const override
+    {
+        if (desiredChannels < 0 || desiredChannels > 4)
+            return ImageDecodeStatus::Unsupported;
+        PngHeader header;
+        std::vector<unsigned char> compressed;
+        ImageDecodeStatus status = parse(data, size, header, compressed);
+        if (status != ImageDecodeStatus::Decoded)
+            return status;
+
+        int outChannels = desiredChannels ? desiredChannels : header.channels;
+        unsigned char* output = allocateImagePixels((size_t)outChannels * header.width * header.height);
+        if (!output)
+            return ImageDecodeStatus::Failed;
+        status = inflateInto(header, compressed, output, outChannels, (size_t)outChannels * header.width);
+        if (status != ImageDecodeStatus::Decoded)
+        {
+            freeImagePixels(output);
+            return status;
+        }
+        *pixels = output;
+        *width = (int)header.width;
+        *height = (int)header.height;
+        *channels = header.channels;
+        return ImageDecodeStatus::Decoded;
+    }
+
+    ImageDecodeStatus decodeInto(const unsigned char* data, size_t size, const ImageDecodeTarget& target) const override
+    {
+        PngHeader header;
+        std::vector<unsigned char> compressed;
+        ImageDecodeStatus status = parse(data, size, header, compressed);
+        if (status != ImageDecodeStatus::Decoded)
+            return status;
+        if ((int)header.width != target.width || (int)header.height != target.height)
+            return ImageDecodeStatus::Failed;
+        return inflateInto(header, compressed, target.pixels, imagePixelFormatChannels(target.format), target.stride());
+    }
+
+private:
+    /// Lo que importa del IHDR
+    struct PngHeader
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        int channels = 0;
+    };
+
+    bool simd;
+
+    static uint32_t readBigEndian(const unsigned char* p)
+    {
+        return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+    }
+
+    static uint32_t chunkType(const char* name)
+    {
+        return readBigEndian((const unsigned char*)name);
+    }
+
+    /**
+     * @brief Recorre los chunks: lee el IHDR y junta los IDAT
+     */
+    static ImageDecodeStatus parse(const unsigned char* data, size_t size, PngHeader& header,
+                                   std::vector<unsigned char>& compressed)
+    {
+        static const unsigned char signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+        if (size < 8 || memcmp(data, signature, 8) != 0)
+            return ImageDecodeStatus::Unsupported;
+
+        const unsigned char* pos = data + 8;
+        const unsigned char* end = data + size;
+        bool seenHeader = false;
+        for (;;)
+        {
+            if (end - pos < 12)
+                return ImageDecodeStatus::Failed;
+            uint32_t length = readBigEndian(pos);
+            uint32_t type = readBigEndian(pos + 4);
+            const unsigned char* chunk = pos + 8;
+            if (length > (uint32_t)(end - chunk) - 4)
+                return ImageDecodeStatus::Failed;
+            pos = chunk + length + 4; // datos + CRC
+
+            if (type == chunkType("IHDR"))
+            {
+                if (length != 13)
+                    return ImageDecodeStatus::Failed;
+                header.width = readBigEndian(chunk);
+                header.height = readBigEndian(chunk + 4);
+                int depth = chunk[8];
+                int color = chunk[9];
+                if (header.width == 0 || header.height == 0 || header.width > (1u << 24) || header.height > (1u << 24)
+                    || chunk[10] || chunk[11])
+                    return ImageDecodeStatus::Failed;
+                if (depth != 8 || chunk[12] != 0)
+                    return ImageDecodeStatus::Unsupported;
+                switch (color)
+                {
+                    case 0: header.channels = 1; break;
+                    case 4: header.channels = 2; break;
+                    case 2: header.channels = 3; break;
+                    case 6: header.channels = 4; break;
+                    default: return ImageDecodeStatus::Unsupported; // paleta
+                }
+                seenHeader = true;
+            }
+            else if (type == chunkType("CgBI") || type == chunkType("tRNS") || type == chunkType("PLTE"))
+            {
+                return ImageDecodeStatus::Unsupported;
+            }
+            else if (type == chunkType("IDAT"))
+            {
+                if (!seenHeader)
+                    return ImageDecodeStatus::Failed;
+                compressed.insert(compressed.end(), chunk, chunk + length);
+            }
+            else if (type == chunkType("IEND"))
+            {
+                break;
+            }
+            else if (!(type & (1u << 29)) && seenHeader)
+            {
+                return ImageDecodeStatus::Unsupported; // chunk crítico desconocido
+            }
+        }
+        if (!seenHeader || compressed.empty() || compressed.size() > 0x7FFFFFFF)
+            return ImageDecodeStatus::Failed;
+        if (((size_t)header.width * header.channels + 1) * header.height > 0x7FFFFFFF)
+            return ImageDecodeStatus::Unsupported;
+        return ImageDecodeStatus::Decoded;
+    }
+
+    /**
+     * @brief Descomprime los IDAT y desfiltra fila por fila en el destino
+     * @details Con los mismos canales que el archivo se desfiltra en el destino
+     *          mismo (la fila anterior ya reconstruida está ahí); si no, en dos
+     *          filas de trabajo que se convierten al destino una por una.
+     */
+    ImageDecodeStatus inflateInto(const PngHeader& header, const std::vector<unsigned char>& compressed,
+                                  unsigned char* output, int outChannels, size_t outStride) const
+    {
+        size_t rowBytes = (size_t)header.width * header.channels;
+        size_t expected = (rowBytes + 1) * header.height;
+        int inflatedSize = 0;
+        char* inflated = stbi_zlib_decode_malloc_guesssize_headerflag((const char*)compressed.data(),
+                                                                      (int)compressed.size(), (int)expected,
+                                                                      &inflatedSize, 1);
+        if (!inflated)
+            return ImageDecodeStatus::Failed;
+        if ((size_t)inflatedSize < expected)
+        {
+            freeImagePixels(inflated);
+            return ImageDecodeStatus::Failed;
+        }
+
+        bool direct = outChannels == header.channels;
+        std::vector<uint8_t> scratch(direct ? rowBytes : rowBytes * 3, 0);
+        const uint8_t* prior = scratch.data(); // ceros para la primera fila
+        bool ok = true;
+        for (uint32_t y = 0; y < header.height && ok; y++)
+        {
+            const uint8_t* raw = (const uint8_t*)inflated + y * (rowBytes + 1);
+            uint8_t* target = output + y * outStride;
+            uint8_t* row = direct ? target : scratch.data() + rowBytes * (1 + (y & 1));
+            ok = pngUnfilterRow(row, raw + 1, prior, rowBytes, header.channels, raw[0], simd);
+            if (!direct)
+                convertImageChannels(row, header.channels, target, outChannels, header.width);
+            prior = row;
+        }
+        freeImagePixels(inflated);
+        return ok ? ImageDecodeStatus::Decoded : ImageDecodeStatus::Failed;
+    }
+};
+
+#endif
@@ -0,0 +1,442 @@
+/**
+ * @file render_graph.h
+ * @brief Grafo de render por frame: orden de pasadas, descarte y aliasing de targets
+ * @details Cada frame se declaran los recursos (texturas transitorias del
+ *          RenderTargetPool o el framebuffer por defecto) y las pasadas, cada una
+ *          con lo que lee y lo que escribe. compile():
+ *            - descarta las pasadas cuyas salidas nadie consume (recursivamente),
+ *              salvo las que escriben la pantalla o se marcan con sideEffect();
+ *            - calcula la vida de cada textura: se pide al pool justo antes de su
+ *              primera pasada y se devuelve tras la última, así que dos recursos de
+ *              igual tamaño y formato que no se solapan comparten la misma textura.
+ *          execute() corre las pasadas en el orden de declaración, que ya es
+ *          topológico porque una pasada solo puede leer lo que otra escribió antes,
+ *          y solo cambia de FBO cuando los attachments cambian. Después el grafo
+ *          queda vacío para el frame siguiente.
+ */
+#ifndef RENDER_GRAPH_H
+#define RENDER_GRAPH_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "render_target.h"
+
+typedef int RenderResource; ///< Índice de un recurso del grafo; -1 = ninguno
+
+/**
+ * @class RenderPassBuilder
+ * @brief Declaración de lo que lee y escribe una pasada
+ */
+class RenderPassBuilder
+{
+public:
+    /// La pasada muestrea el recurso
+    void read(RenderResource resource) { reads.push_back(resource); }
+
+    /// La pasada dibuja en el recurso (attachments de color en orden de llamada)
+    void write(RenderResource resource) { colors.push_back(resource); }
+
+    /// La pasada usa el recurso como profundidad (o profundidad + stencil)
+    void writeDepth(RenderResource resource) { depth = resource; }
+
+    /// La pasada tiene efectos fuera del grafo (lecturas a CPU, consultas...): nunca se descarta
+    void sideEffect() { keep = true; }
+
+private:
+    friend class RenderGraph;
+
+    std::vector<RenderResource> reads;
+    std::vector<RenderResource> colors;
+    RenderResource depth = -1;
+    bool keep = false;
+};
+
+class RenderGraph;
+
+/**
+ * @class RenderPassContext
+ * @brief Lo que ve una pasada al ejecutarse
+ */
+class RenderPassContext
+{
+public:
+    /// ID de la textura GL de un recurso (0 para la pantalla)
+    unsigned int texture(RenderResource resource) const;
+
+    /// Target del pool de un recurso transitorio (nullptr para la pantalla)
+    const RenderTarget* target(RenderResource resource) const;
+
+    /// FBO (cacheado) con el recurso como único attachment de color, para leerlo con glBlitFramebuffer
+    unsigned int readFramebuffer(RenderResource resource) const;
+
+    int width;  ///< Tamaño del framebuffer enlazado
+    int height;
+
+private:
+    friend class RenderGraph;
+
+    explicit RenderPassContext(const RenderGraph& graph) : width(0), height(0), graph(graph) {}
+
+    const RenderGraph& graph;
+};
+
+/**
+ * @struct RenderGraphStats
+ * @brief Resultado del último frame
+ */
+struct RenderGraphStats
+{
+    int passes = 0;          ///< Pasadas declaradas
+    int culled = 0;          ///< Pasadas descartadas
+    int transients = 0;      ///< Texturas transitorias vivas tras el descarte
+    int physical = 0;        ///< Texturas del pool que las respaldaron (menos = más aliasing)
+    size_t transientBytes = 0; ///< Memoria que ocuparían sin aliasing
+    size_t physicalBytes = 0;  ///< Memoria usada de verdad
+    int framebufferBinds = 0;
+};
+
+/**
+ * @class RenderGraph
+ * @brief Pasadas y recursos de un frame (ver el encabezado del archivo)
+ */
+class RenderGraph
+{
+public:
+    explicit RenderGraph(RenderTargetPool& pool) : pool(pool) { reset(); }
+
+    /// Textura transitoria: solo existe mientras alguna pasada viva la usa
+    RenderResource createTexture(const std::string& name, const RenderTargetDesc& desc)
+    {
+        Resource resource;
+        resource.name = name;
+        resource.desc = desc;
+        resources.push_back(std::move(resource));
+        return (RenderResource)resources.size() - 1;
+    }
+
+    /// El framebuffer por defecto; escribirlo hace que la pasada nunca se descarte
+    RenderResource backbuffer() const { return 0; }
+
+    /**
+     * @brief Declara una pasada
+     * @param setup Declara lecturas y escrituras con el builder (se llama en el acto)
+     * @param execute Dibuja; se llama en execute() con el FBO de sus escrituras ya enlazado
+     * @details Una pasada que escribe un recurso inexistente, o la pantalla junto
+     *          con una textura transitoria (el framebuffer por defecto no admite
+     *          otros attachments), se rechaza: compile() la descarta y devuelve false.
+     */
+    void addPass(const std::string& name, const std::function<void(RenderPassBuilder&)>& setup,
+                 const std::function<void(RenderPassContext&)>& execute)
+    {
+        Pass pass;
+        pass.name = name;
+        pass.run = execute;
+        setup(pass.io);
+        pass.broken = !validWrites(pass);
+        if (pass.broken)
+        {
+            passes.push_back(pass);
+            return;
+        }
+        // escribir algo ya escrito es cargarlo y seguir: depende de la pasada anterior
+        for (RenderResource resource : writes(pass))
+        {
+            if (valid(resource) && resources[resource].writers > 0)
+                pass.io.reads.push_back(resource);
+        }
+        for (RenderResource resource : writes(pass))
+        {
+            if (valid(resource))
+                resources[resource].writers++;
+        }
+        passes.push_back(pass);
+    }
+
+    /**
+     * @brief Descarta pasadas y calcula la vida de los recursos
+     * @return false si alguna pasada lee un recurso que nadie escribió antes o
+     *         addPass la rechazó (se descarta)
+     */
+    bool compile()
+    {
+        bool ok = true;
+        std::vector<int> written(resources.size(), 0);
+        for (Pass& pass : passes)
+        {
+            if (pass.broken)
+            {
+                ok = false;
+                continue;
+            }
+            for (RenderResource resource : pass.io.reads)
+            {
+                if (!valid(resource) || (resource != backbuffer() && !written[resource]))
+                {
+                    std::cout << "ERROR::RENDER_GRAPH::READ_BEFORE_WRITE " << pass.name << " "
+                              << (valid(resource) ? resources[resource].name : std::string("?")) << std::endl;
+                    pass.broken = true;
+                    ok = false;
+                }
+            }
+            if (!pass.broken)
+            {
+                for (RenderResource resource : writes(pass))
+                    written[resource] = 1;
+            }
+        }
+
+        // de la última a la primera: una pasada vive si escribe la pantalla, tiene
+        // efectos propios o escribe algo que lee una pasada viva posterior
+        std::vector<char> needed(resources.size(), 0);
+        needed[backbuffer()] = 1;
+        for (size_t i = passes.size(); i-- > 0;)
+        {
+            Pass& pass = passes[i];
+            pass.culled = true;
+            if (pass.broken)
+                continue;
+            for (RenderResource resource : writes(pass))
+            {
+                if (needed[resource])
+                    pass.culled = false;
+            }
+            if (pass.io.keep)
+                pass.culled = false;
+            if (pass.culled)
+                continue;
+            for (RenderResource resource : pass.io.reads)
+                needed[resource] = 1;
+        }
+
+        // vida de cada textura entre las pasadas que quedan
+        for (Resource& resource : resources)
+            resource.first = resource.last = -1;
+        for (size_t i = 0; i < passes.size(); i++)
+        {
+            if (passes[i].culled)
+                continue;
+            std::vector<RenderResource> used = writes(passes[i]);
+            used.insert(used.end(), passes[i].io.reads.begin(), passes[i].io.reads.end());
+            for (RenderResource resource : used)
+            {
+                if (resource == backbuffer())
+                    continue;
+                if (resources[resource].first < 0)
+                    resources[resource].first = (int)i;
+                resources[resource].last = (int)i;
+            }
+        }
+        compiled = true;
+        return ok;
+    }
+
+    /**
+     * @brief Ejecuta las pasadas vivas y vacía el grafo
+     */
+    void execute()
+    {
+        if (!compiled)
+            compile();
+        RenderGraphStats frame;
+        frame.passes = (int)passes.size();
+        std::set<unsigned int> physical;
+        std::vector<unsigned int> bound;
+        bool anyBound = false;
+        for (size_t i = 0; i < passes.size(); i++)
+        {
+            Pass& pass = passes[i];
+            if (pass.culled)
+            {
+                frame.culled++;
+                continue;
+            }
+            for (size_t r = 1; r < resources.size(); r++)
+            {
+                Resource& resource = resources[r];
+                if (resource.first != (int)i)
+                    continue;
+                resource.handle = pool.acquire(resource.desc);
+                frame.transients++;
+                frame.transientBytes += resource.handle->bytes;
+                if (physical.insert(resource.handle.id()).second)
+                    frame.physicalBytes += resource.handle->bytes;
+            }
+
+            RenderPassContext context(*this);
+            std::vector<unsigned int> attachments = attachmentIds(pass);
+            if (!attachments.empty())
+            {
+                if (!anyBound || attachments != bound)
+                {
+                    bindAttachments(pass);
+                    bound = attachments;
+                    anyBound = true;
+                    frame.framebufferBinds++;
+                }
+                const RenderTarget* sized = firstTarget(pass);
+                context.width = sized ? sized->width : pool.width();
+                context.height = sized ? sized->height : pool.height();
+            }
+            pass.run(context);
+
+            for (size_t r = 1; r < resources.size(); r++)
+            {
+                if (resources[r].last == (int)i)
+                    resources[r].handle.reset(); // libre para la próxima pasada: aliasing
+            }
+        }
+        frame.physical = (int)physical.size();
+        stats = frame;
+        reset();
+    }
+
+    /// Estadísticas del último execute()
+    const RenderGraphStats& lastFrame() const { return stats; }
+
+private:
+    friend class RenderPassContext;
+
+    /**
+     * @struct Resource
+     * @brief Recurso declarado; el 0 es la pantalla
+     */
+    struct Resource
+    {
+        std::string name;
+        RenderTargetDesc desc;
+        int writers = 0;
+        int first = -1; ///< Primera y última pasada viva que lo usa
+        int last = -1;
+        RenderTargetHandle handle;
+    };
+
+    /**
+     * @struct Pass
+     * @brief Pasada declarada
+     */
+    struct Pass
+    {
+        std::string name;
+        RenderPassBuilder io;
+        std::function<void(RenderPassContext&)> run;
+        bool culled = false;
+        bool broken = false;
+    };
+
+    RenderTargetPool& pool;
+    std::vector<Resource> resources;
+    std::vector<Pass> passes;
+    bool compiled = false;
+    RenderGraphStats stats;
+
+    void reset()
+    {
+        resources.clear();
+        passes.clear();
+        Resource screen;
+        screen.name = "backbuffer";
+        resources.push_back(std::move(screen));
+        compiled = false;
+    }
+
+    bool valid(RenderResource resource) const { return resource >= 0 && resource < (int)resources.size(); }
+
+    /// false (con el error en consola) si alguna escritura no existe o mezcla la pantalla con texturas
+    bool validWrites(const Pass& pass) const
+    {
+        bool screen = false, transient = false;
+        std::vector<RenderResource> written = pass.io.colors;
+        if (pass.io.depth != -1)
+            written.push_back(pass.io.depth);
+        for (RenderResource resource : written)
+        {
+            if (!valid(resource))
+            {
+                std::cout << "ERROR::RENDER_GRAPH::INVALID_WRITE " << pass.name << " " << resource << std::endl;
+                return false;
+            }
+            if (resource == backbuffer())
+                screen = true;
+            else
+                transient = true;
+        }
+        if (screen && transient)
+        {
+            std::cout << "ERROR::RENDER_GRAPH::BACKBUFFER_WITH_TRANSIENT " << pass.name << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    static std::vector<RenderResource> writes(const Pass& pass)
+    {
+        std::vector<RenderResource> result = pass.io.colors;
+        if (pass.io.depth >= 0)
+            result.push_back(pass.io.depth);
+        return result;
+    }
+
+    static bool writesResource(const Pass& pass, RenderResource resource)
+    {
+        std::vector<RenderResource> written = writes(pass);
+        return std::find(written.begin(), written.end(), resource) != written.end();
+    }
+
+    /// IDs de los attachments de la pasada; {0} si dibuja en la pantalla
+    std::vector<unsigned int> attachmentIds(const Pass& pass) const
+    {
+        std::vector<unsigned int> ids;
+        for (RenderResource resource : writes(pass))
+            ids.push_back(resources[resource].handle.id());
+        return ids;
+    }
+
+    const RenderTarget* firstTarget(const Pass& pass) const
+    {
+        for (RenderResource resource : writes(pass))
+        {
+            if (resource != backbuffer())
+                return resources[resource].handle.get();
+        }
+        return nullptr;
+    }
+
+    void bindAttachments(const Pass& pass)
+    {
+        if (writesResource(pass, backbuffer()))
+        {
+            pool.bindScreen();
+            return;
+        }
+        std::vector<const RenderTarget*> colors;
+        for (RenderResource resource : pass.io.colors)
+            colors.push_back(resources[resource].handle.get());
+        const RenderTarget* depth = pass.io.depth >= 0 ? resources[pass.io.depth].handle.get() : nullptr;
+        pool.bind(colors, depth);
+    }
+};
+
+inline unsigned int RenderPassContext::texture(RenderResource resource) const
+{
+    return graph.valid(resource) ? graph.resources[resource].handle.id() : 0;
+}
+
+inline const RenderTarget* RenderPassContext::target(RenderResource resource) const
+{
+    return graph.valid(resource) ? graph.resources[resource].handle.get() : nullptr;
+}
+
+inline unsigned int RenderPassContext::readFramebuffer(RenderResource resource) const
+{
+    const RenderTarget* source = target(resource);
+    return source ? graph.pool.framebuffer({ source }) : 0;
+}
+
+#endif
@@ -0,0 +1,472 @@
+/**
+ * @file render_target.h
+ * @brief Render a textura: attachments de color/profundidad y pool de targets transitorios
+ * @details RenderTargetPool entrega texturas para usar como attachments según un
+ *          RenderTargetDesc (formato y tamaño fijo o relativo al framebuffer por
+ *          defecto). Las que se devuelven quedan en el pool y la siguiente
+ *          petición con el mismo tamaño y formato las reutiliza, en el mismo frame
+ *          (otra pasada) o en los siguientes; las que pasan varios frames sin uso
+ *          se liberan en endFrame. Los FBO también se cachean por combinación de
+ *          attachments, así que un frame estable no crea ni destruye objetos GL.
+ *
+ *          resize (desde framebuffer_size_callback) solo invalida los targets
+ *          relativos cuyo tamaño resuelto cambia; los de tamaño fijo siguen intactos.
+ */
+#ifndef RENDER_TARGET_H
+#define RENDER_TARGET_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "gl_state.h"
+
+/**
+ * @enum RenderTargetFormat
+ * @brief Formatos de attachment renderizables en OpenGL 3.3 Core
+ */
+enum class RenderTargetFormat
+{
+    RGBA8,
+    SRGB8_ALPHA8,
+    RGBA16F,
+    R11F_G11F_B10F,
+    R8,
+    RG16F,
+    Depth24Stencil8,
+    Depth32F
+};
+
+/**
+ * @struct RenderTargetFormatInfo
+ * @brief Parámetros de glTexImage2D y tipo de attachment de un formato
+ */
+struct RenderTargetFormatInfo
+{
+    GLenum internalFormat;
+    GLenum format;
+    GLenum type;
+    GLenum attachment;     ///< GL_COLOR_ATTACHMENT0 para los de color
+    int bytesPerPixel;
+};
+
+inline RenderTargetFormatInfo renderTargetFormatInfo(RenderTargetFormat format)
+{
+    switch (format)
+    {
+        case RenderTargetFormat::SRGB8_ALPHA8:
+            return { GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE, GL_COLOR_ATTACHMENT0, 4 };
+        case RenderTargetFormat::RGBA16F:
+            return { GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, GL_COLOR_ATTACHMENT0, 8 };
+        case RenderTargetFormat::R11F_G11F_B10F:
+            return { GL_R11F_G11F_B10F, GL_RGB, GL_FLOAT, GL_COLOR_ATTACHMENT0, 4 };
+        case RenderTargetFormat::R8:
+            return { GL_R8, GL_RED, GL_UNSIGNED_BYTE, GL_COLOR_ATTACHMENT0, 1 };
+        case RenderTargetFormat::RG16F:
+            return { GL_RG16F, GL_RG, GL_HALF_FLOAT, GL_COLOR_ATTACHMENT0, 4 };
+        case RenderTargetFormat::Depth24Stencil8:
+            return { GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, GL_DEPTH_STENCIL_ATTACHMENT, 4 };
+        case RenderTargetFormat::Depth32F:
+            return { GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT, GL_DEPTH_ATTACHMENT, 4 };
+        default:
+            return { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, GL_COLOR_ATTACHMENT0, 4 };
+    }
+}
+
+/// true si el formato va en el attachment de profundidad
+inline bool isDepthRenderTargetFormat(RenderTargetFormat format)
+{
+    return format == RenderTargetFormat::Depth24Stencil8 || format == RenderTargetFormat::Depth32F;
+}
+
+/**
+ * @struct RenderTargetDesc
+ * @brief Qué target se pide: formato y tamaño
+ * @details Con scale > 0 el tamaño es el del framebuffer por defecto por scale
+ *          (redondeado, mínimo 1) y se invalida al redimensionar la ventana; con
+ *          scale == 0 se usan width y height tal cual.
+ */
+struct RenderTargetDesc
+{
+    RenderTargetFormat format = RenderTargetFormat::RGBA8;
+    int width = 0;
+    int height = 0;
+    float scale = 1.0f;
+
+    /// Target del tamaño de la pantalla por scale (1 = mismo tamaño, 0.5 = mitad...)
+    static RenderTargetDesc screen(RenderTargetFormat format, float scale = 1.0f)
+    {
+        RenderTargetDesc desc;
+        desc.format = format;
+        desc.scale = scale;
+        return desc;
+    }
+
+    /// Target de tamaño fijo, que resize no toca (shadow maps, LUTs...)
+    static RenderTargetDesc fixed(RenderTargetFormat format, int width, int height)
+    {
+        RenderTargetDesc desc;
+        desc.format = format;
+        desc.width = width;
+        desc.height = height;
+        desc.scale = 0.0f;
+        return desc;
+    }
+};
+
+/**
+ * @struct RenderTarget
+ * @brief Textura de un attachment y su estado en el pool
+ */
+struct RenderTarget
+{
+    unsigned int id = 0;
+    int width = 0;
+    int height = 0;
+    RenderTargetFormat format = RenderTargetFormat::RGBA8;
+    size_t bytes = 0;
+    float scale = 0.0f;       ///< Escala respecto de la pantalla; 0 = tamaño fijo (resize no lo afecta)
+    bool inUse = false;
+    bool stale = false;       ///< El tamaño ya no corresponde: se destruye al devolverlo
+    uint64_t lastUsedFrame = 0;
+};
+
+class RenderTargetPool;
+
+/**
+ * @class RenderTargetHandle
+ * @brief Préstamo de un target del pool; al destruirse lo devuelve
+ * @note El pool debe vivir más que todos sus handles. Un handle que se guarda
+ *       entre frames debe pedirse de nuevo si stale() (la ventana cambió de tamaño).
+ */
+class RenderTargetHandle
+{
+public:
+    RenderTargetHandle() : pool(nullptr), target(nullptr) {}
+    RenderTargetHandle(RenderTargetHandle&& other) noexcept : pool(other.pool), target(other.target)
+    {
+        other.pool = nullptr;
+        other.target = nullptr;
+    }
+    RenderTargetHandle& operator=(RenderTargetHandle&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            std::swap(pool, other.pool);
+            std::swap(target, other.target);
+        }
+        return *this;
+    }
+    RenderTargetHandle(const RenderTargetHandle&) = delete;
+    RenderTargetHandle& operator=(const RenderTargetHandle&) = delete;
+    ~RenderTargetHandle() { reset(); }
+
+    /// Devuelve el target al pool antes de que el handle se destruya
+    void reset();
+
+    const RenderTarget* get() const { return target; }
+    const RenderTarget* operator->() const { return target; }
+    unsigned int id() const { return target ? target->id : 0; }
+    bool stale() const { return target && target->stale; }
+
+    explicit operator bool() const { return target != nullptr; }
+
+private:
+    friend class RenderTargetPool;
+
+    RenderTargetPool* pool;
+    RenderTarget* target;
+
+    RenderTargetHandle(RenderTargetPool* pool, RenderTarget* target) : pool(pool), target(target) {}
+};
+
+/**
+ * @struct RenderTargetPoolStats
+ * @brief Contadores del pool
+ */
+struct RenderTargetPoolStats
+{
+    size_t created = 0;       ///< Texturas creadas
+    size_t reused = 0;        ///< Peticiones servidas con una textura del pool
+    size_t destroyed = 0;     ///< Texturas liberadas (por desuso o por resize)
+    size_t framebuffers = 0;  ///< FBO creados
+};
+
+/**
+ * @class RenderTargetPool
+ * @brief Targets transitorios reutilizables y caché de FBO
+ */
+class RenderTargetPool
+{
+public:
+    /**
+     * @param screenWidth Ancho del framebuffer por defecto
+     * @param screenHeight Alto del framebuffer por defecto
+     * @param maxIdleFrames Frames que un target libre espera antes de liberarse
+     */
+    RenderTargetPool(int screenWidth, int screenHeight, int maxIdleFrames = 3)
+        : screenWidth(std::max(1, screenWidth)), screenHeight(std::max(1, screenHeight)),
+          maxIdleFrames(maxIdleFrames), frame(0)
+    {
+    }
+
+    ~RenderTargetPool()
+    {
+        for (std::map<std::vector<unsigned int>, unsigned int>::value_type& entry : framebuffers)
+            glDeleteFramebuffers(1, &entry.second);
+        for (std::unique_ptr<RenderTarget>& target : targets)
+            glDeleteTextures(1, &target->id);
+    }
+
+    RenderTargetPool(const RenderTargetPool&) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+    /**
+     * @brief Presta un target; reutiliza uno libre del mismo tamaño y formato si hay
+     */
+    RenderTargetHandle acquire(const RenderTargetDesc& desc)
+    {
+        int width, height;
+        resolve(desc.scale, desc.width, desc.height, width, height);
+        float scale = std::max(0.0f, desc.scale);
+        for (std::unique_ptr<RenderTarget>& target : targets)
+        {
+            if (!target->inUse && !target->stale && target->format == desc.format && target->width == width
+                && target->height == height)
+            {
+                target->inUse = true;
+                target->scale = scale;
+                target->lastUsedFrame = frame;
+                stats.reused++;
+                return RenderTargetHandle(this, target.get());
+            }
+        }
+
+        std::unique_ptr<RenderTarget> target = std::make_unique<RenderTarget>();
+        RenderTargetFormatInfo info = renderTargetFormatInfo(desc.format);
+        target->width = width;
+        target->height = height;
+        target->format = desc.format;
+        target->bytes = (size_t)width * height * info.bytesPerPixel;
+        target->scale = scale;
+        target->inUse = true;
+        target->lastUsedFrame = frame;
+        ScopedTextureBinding restore;
+        glGenTextures(1, &target->id);
+        glBindTexture(GL_TEXTURE_2D, target->id);
+        glTexImage2D(GL_TEXTURE_2D, 0, info.internalFormat, width, height, 0, info.format, info.type, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        stats.created++;
+        targets.push_back(std::move(target));
+        return RenderTargetHandle(this, targets.back().get());
+    }
+
+    /**
+     * @brief FBO con esos attachments, creado la primera vez y cacheado
+     * @param colors Targets de color, en GL_COLOR_ATTACHMENT0..n
+     * @param depth Target de profundidad (o profundidad + stencil), opcional
+     * @return ID del FBO, 0 si la combinación no es completa
+     */
+    unsigned int framebuffer(const std::vector<const RenderTarget*>& colors, const RenderTarget* depth = nullptr)
+    {
+        std::vector<unsigned int> key;
+        for (const RenderTarget* color : colors)
+            key.push_back(color->id);
+        key.push_back(depth ? depth->id : 0);
+        std::map<std::vector<unsigned int>, unsigned int>::iterator cached = framebuffers.find(key);
+        if (cached != framebuffers.end())
+            return cached->second;
+
+        // se puede pedir en medio de una pasada (readFramebuffer): no perder su destino
+        ScopedFramebufferBinding restore;
+        unsigned int fbo;
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        std::vector<GLenum> drawBuffers;
+        for (const RenderTarget* color : colors)
+        {
+            GLenum attachment = GL_COLOR_ATTACHMENT0 + (GLenum)drawBuffers.size();
+            glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, color->id, 0);
+            drawBuffers.push_back(attachment);
+        }
+        if (depth)
+            glFramebufferTexture2D(GL_FRAMEBUFFER, renderTargetFormatInfo(depth->format).attachment, GL_TEXTURE_2D,
+                                   depth->id, 0);
+        if (drawBuffers.empty())
+            glDrawBuffer(GL_NONE);
+        else
+            glDrawBuffers((GLsizei)drawBuffers.size(), drawBuffers.data());
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            std::cout << "ERROR::FRAMEBUFFER::NOT_COMPLETE 0x" << std::hex << status << std::dec << std::endl;
+            glDeleteFramebuffers(1, &fbo);
+            return 0;
+        }
+        stats.framebuffers++;
+        framebuffers[key] = fbo;
+        return fbo;
+    }
+
+    /**
+     * @brief Enlaza el FBO de esos attachments y ajusta el viewport a su tamaño
+     * @return false si la combinación no es completa (queda enlazado el framebuffer por defecto)
+     */
+    bool bind(const std::vector<const RenderTarget*>& colors, const RenderTarget* depth = nullptr)
+    {
+        unsigned int fbo = framebuffer(colors, depth);
+        if (!fbo)
+        {
+            bindScreen();
+            return false;
+        }
+        const RenderTarget* sized = colors.empty() ? depth : colors.front();
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, sized->width, sized->height);
+        return true;
+    }
+
+    /// Enlaza el framebuffer por defecto con el viewport de la pantalla
+    void bindScreen()
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, screenWidth, screenHeight);
+    }
+
+    /**
+     * @brief Nuevo tamaño del framebuffer por defecto
+     * @details Libera los targets relativos libres cuyo tamaño cambia y marca como
+     *          stale los prestados, que se liberan al devolverse. Los de tamaño
+     *          fijo (y los relativos que resuelven al mismo tamaño) no se tocan.
+     */
+    void resize(int width, int height)
+    {
+        // ventana minimizada (0x0): se conservan los targets hasta que vuelva
+        if (width <= 0 || height <= 0 || (width == screenWidth && height == screenHeight))
+            return;
+        screenWidth = width;
+        screenHeight = height;
+        for (std::unique_ptr<RenderTarget>& target : targets)
+        {
+            int resolvedWidth, resolvedHeight;
+            resolve(target->scale, target->width, target->height, resolvedWidth, resolvedHeight);
+            if (resolvedWidth != target->width || resolvedHeight != target->height)
+                target->stale = true;
+        }
+        destroyWhere([](const RenderTarget& target) { return target.stale && !target.inUse; });
+    }
+
+    /**
+     * @brief Cierra el frame: libera los targets libres sin uso desde hace maxIdleFrames
+     */
+    void endFrame()
+    {
+        frame++;
+        uint64_t current = frame;
+        int idle = maxIdleFrames;
+        destroyWhere([current, idle](const RenderTarget& target) {
+            return !target.inUse && current - target.lastUsedFrame > (uint64_t)idle;
+        });
+    }
+
+    /// Bytes de VRAM de todos los targets (prestados y libres)
+    size_t residentBytes() const
+    {
+        size_t bytes = 0;
+        for (const std::unique_ptr<RenderTarget>& target : targets)
+            bytes += target->bytes;
+        return bytes;
+    }
+
+    size_t targetCount() const { return targets.size(); }
+    int width() const { return screenWidth; }
+    int height() const { return screenHeight; }
+    const RenderTargetPoolStats& statistics() const { return stats; }
+
+private:
+    friend class RenderTargetHandle;
+
+    std::vector<std::unique_ptr<RenderTarget>> targets;
+    std::map<std::vector<unsigned int>, unsigned int> framebuffers; ///< IDs de textura (colores + profundidad) -> FBO
+    int screenWidth;
+    int screenHeight;
+    int maxIdleFrames;
+    uint64_t frame;
+    RenderTargetPoolStats stats;
+
+    /// Tamaño en píxeles: scale > 0 es relativo a la pantalla, si no fixedWidth x fixedHeight
+    void resolve(float scale, int fixedWidth, int fixedHeight, int& width, int& height) const
+    {
+        if (scale > 0.0f)
+        {
+            width = std::max(1, (int)std::lround(screenWidth * scale));
+            height = std::max(1, (int)std::lround(screenHeight * scale));
+        }
+        else
+        {
+            width = std::max(1, fixedWidth);
+            height = std::max(1, fixedHeight);
+        }
+    }
+
+    void release(RenderTarget* target)
+    {
+        target->inUse = false;
+        target->lastUsedFrame = frame;
+        if (target->stale)
+            destroyWhere([target](const RenderTarget& candidate) { return &candidate == target; });
+    }
+
+    template <typename Predicate>
+    void destroyWhere(Predicate predicate)
+    {
+        for (size_t i = 0; i < targets.size();)
+        {
+            if (!predicate(*targets[i]))
+            {
+                i++;
+                continue;
+            }
+            unsigned int id = targets[i]->id;
+            // los FBO que usaban la textura dejan de ser válidos
+            for (std::map<std::vector<unsigned int>, unsigned int>::iterator it = framebuffers.begin();
+                 it != framebuffers.end();)
+            {
+                if (std::find(it->first.begin(), it->first.end(), id) != it->first.end())
+                {
+                    glDeleteFramebuffers(1, &it->second);
+                    it = framebuffers.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+            glDeleteTextures(1, &id);
+            stats.destroyed++;
+            targets[i] = std::move(targets.back());
+            targets.pop_back();
+        }
+    }
+};
+
+inline void RenderTargetHandle::reset()
+{
+    if (pool && target)
+        pool->release(target);
+    pool = nullptr;
+    target = nullptr;
+}
+
+#endif
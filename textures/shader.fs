@@ -1,6 +1,8 @@
 #version 330 core
 out vec4 FragColor;
 
+#include "material_uniforms.glsl"
+
 in vec3 ourColor;
 in vec2 TextCoord;
 
@@ -8,5 +10,5 @@ in vec2 TextCoord;
 uniform sampler2D ourTexture;
 
 void main() {
-    FragColor = texture(ourTexture, TextCoord);
-}
\ No newline at end of file
+    FragColor = texture(ourTexture, TextCoord) * uTint;
+}
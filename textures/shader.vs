@@ -1,5 +1,8 @@
 #version 330 core
 
+#include "frame_uniforms.glsl"
+#include "material_uniforms.glsl"
+
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aColor;
 layout (location = 2) in vec2 aTextCoord;
@@ -9,7 +12,7 @@ out vec2 TextCoord;
 
 void main()
 {
-    gl_Position = vec4(aPos, 1.0);
+    gl_Position = uProjection * uView * vec4(aPos, 1.0);
     ourColor = aColor;
-    TextCoord = aTextCoord;
-}
\ No newline at end of file
+    TextCoord = aTextCoord * uUvScaleOffset.xy + uUvScaleOffset.zw;
+}
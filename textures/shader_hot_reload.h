@@ -0,0 +1,367 @@
+/**
+ * @file shader_hot_reload.h
+ * @brief Recarga en caliente de shaders al modificarse sus archivos
+ * @details Un hilo en segundo plano vigila los archivos con inotify (en Linux; en
+ *          otros sistemas consulta la fecha de modificación periódicamente), lee y
+ *          preprocesa el código nuevo (incluidos sus #include) y lo encola. En el límite de frame, applyPending() emite la
+ *          compilación asíncrona y, cuando el driver termina, intercambia el ID del
+ *          programa. Si la compilación falla se conserva el programa anterior.
+ *
+ *          Se vigila el disco, así que el preprocesador debe leer de disco aunque
+ *          haya packs montados (ShaderPreprocessor::setReadFromDisk, que además lee
+ *          con ifstream en vez de proyectar archivos que el editor puede truncar);
+ *          si no, watch() avisa de las fuentes que saldrían del pack.
+ */
+#ifndef SHADER_HOT_RELOAD_H
+#define SHADER_HOT_RELOAD_H
+
+#include <glad/glad.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "shader_s.h"
+#include "shader_preprocessor.h"
+
+/**
+ * @class ShaderHotReloader
+ * @brief Servicio de recarga de shaders vigilados
+ * @note watch()/unwatch()/applyPending() deben llamarse desde el hilo con el contexto GL
+ */
+class ShaderHotReloader
+{
+public:
+    explicit ShaderHotReloader(const ShaderPreprocessor& preprocessor = defaultShaderPreprocessor())
+        : preprocessor(preprocessor), running(true)
+    {
+#ifdef __linux__
+        if (pipe(wakePipe) != 0)
+            wakePipe[0] = wakePipe[1] = -1;
+#endif
+        watcher = std::thread(&ShaderHotReloader::watchLoop, this);
+    }
+
+    ~ShaderHotReloader()
+    {
+        running = false;
+#ifdef __linux__
+        // despertar al hilo bloqueado en poll()
+        if (wakePipe[1] >= 0)
+        {
+            char byte = 0;
+            ssize_t ignored = write(wakePipe[1], &byte, 1);
+            (void)ignored;
+        }
+#endif
+        if (watcher.joinable())
+            watcher.join();
+#ifdef __linux__
+        if (wakePipe[0] >= 0)
+        {
+            close(wakePipe[0]);
+            close(wakePipe[1]);
+        }
+#endif
+    }
+
+    ShaderHotReloader(const ShaderHotReloader&) = delete;
+    ShaderHotReloader& operator=(const ShaderHotReloader&) = delete;
+
+    /**
+     * @brief Empieza a vigilar los archivos fuente de un shader
+     * @param shader Shader cuyo programa se reemplazará al recargar
+     * @param vertexPath Ruta del vertex shader
+     * @param fragmentPath Ruta del fragment shader
+     * @param defines Macros con las que se construyó el shader
+     * @details También se vigilan los archivos que incluyen (#include).
+     */
+    void watch(Shader& shader, const std::string& vertexPath, const std::string& fragmentPath,
+               const std::vector<ShaderDefine>& defines = {})
+    {
+        std::unique_ptr<Entry> entry(new Entry());
+        entry->shader = &shader;
+        entry->vertexPath = absolutePath(vertexPath);
+        entry->fragmentPath = absolutePath(fragmentPath);
+        entry->defines = defines;
+        // preprocesar una vez solo para conocer los includes
+        PreprocessedShader vertex = preprocessor.processFile(entry->vertexPath, defines);
+        PreprocessedShader fragment = preprocessor.processFile(entry->fragmentPath, defines);
+        entry->dependencies = snapshotTimes(vertex.dependencies, fragment.dependencies);
+        if (!preprocessor.readsFromDisk())
+        {
+            for (const DependencyTimes::value_type& dependency : entry->dependencies)
+            {
+                if (findPackedAsset(dependency.first))
+                    std::cout << "WARNING::SHADER_HOT_RELOAD::SOURCE_IN_PACK (las ediciones no se verán) "
+                              << dependency.first << std::endl;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        entry->id = nextId++;
+        entries.push_back(std::move(entry));
+        watchListChanged = true;
+    }
+
+    /**
+     * @brief Deja de vigilar un shader (p.ej. antes de destruirlo)
+     */
+    void unwatch(Shader& shader)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            if (entries[i]->shader == &shader)
+            {
+                entries.erase(entries.begin() + i);
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief Procesa recargas pendientes; llamar una vez por frame, antes de dibujar
+     * @details Emite las compilaciones de los archivos modificados y aplica las que
+     *          ya terminaron. El intercambio ocurre siempre aquí, nunca a mitad de frame.
+     */
+    void applyPending()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (std::unique_ptr<Entry>& entry : entries)
+        {
+            if (entry->sourceReady)
+            {
+                // descartar una compilación anterior aún en curso: la nueva la sustituye
+                entry->build = ShaderBuilder::compile(entry->vertexCode, entry->fragmentCode);
+                entry->sourceReady = false;
+                entry->vertexCode.clear();
+                entry->fragmentCode.clear();
+            }
+            if (entry->build.valid() && entry->build.isReady())
+            {
+                entry->build.get();
+                if (entry->build.succeeded())
+                {
+                    entry->shader->replaceProgram(entry->build.detach());
+                    std::cout << "Shader recargado: " << entry->fragmentPath << std::endl;
+                }
+                else
+                {
+                    // conservar el programa actual; el error ya se reportó en get()
+                    glDeleteProgram(entry->build.detach());
+                    std::cout << "Recarga fallida, se mantiene el programa anterior: " << entry->fragmentPath << std::endl;
+                }
+            }
+        }
+    }
+
+private:
+    typedef std::map<std::string, std::filesystem::file_time_type> DependencyTimes;
+
+    struct Entry
+    {
+        unsigned int id = 0;
+        Shader* shader = nullptr;
+        std::string vertexPath;
+        std::string fragmentPath;
+        std::vector<ShaderDefine> defines;
+        // archivos leídos al preprocesar (fuentes e includes) y su fecha de modificación
+        DependencyTimes dependencies;
+        // código leído por el hilo vigilante, pendiente de compilar
+        bool sourceReady = false;
+        std::string vertexCode;
+        std::string fragmentCode;
+        // compilación en curso
+        ShaderFuture build;
+    };
+
+    const ShaderPreprocessor& preprocessor;
+    std::vector<std::unique_ptr<Entry>> entries;
+    unsigned int nextId = 1;
+    std::mutex mutex;
+    std::atomic<bool> running;
+    bool watchListChanged = false;
+    std::thread watcher;
+#ifdef __linux__
+    int wakePipe[2] = { -1, -1 };
+#endif
+
+    static std::string absolutePath(const std::string& path)
+    {
+        std::error_code error;
+        std::filesystem::path absolute = std::filesystem::absolute(path, error);
+        return error ? path : absolute.lexically_normal().string();
+    }
+
+    static std::filesystem::file_time_type modificationTime(const std::string& path)
+    {
+        std::error_code error;
+        std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+        return error ? std::filesystem::file_time_type::min() : time;
+    }
+
+    static DependencyTimes snapshotTimes(const std::vector<std::string>& vertexFiles,
+                                         const std::vector<std::string>& fragmentFiles)
+    {
+        DependencyTimes times;
+        for (const std::string& file : vertexFiles)
+            times[file] = modificationTime(file);
+        for (const std::string& file : fragmentFiles)
+            times[file] = modificationTime(file);
+        return times;
+    }
+
+    /**
+     * @brief Revisa las fechas de modificación y preprocesa lo que cambió
+     * @details Se ejecuta en el hilo vigilante: la E/S nunca ocurre en el de render.
+     */
+    void rescan()
+    {
+        struct Snapshot
+        {
+            unsigned int id;
+            std::string vertexPath;
+            std::string fragmentPath;
+            std::vector<ShaderDefine> defines;
+            DependencyTimes dependencies;
+        };
+        std::vector<Snapshot> snapshots;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (std::unique_ptr<Entry>& entry : entries)
+                snapshots.push_back(Snapshot{ entry->id, entry->vertexPath, entry->fragmentPath,
+                                              entry->defines, entry->dependencies });
+        }
+        for (const Snapshot& snapshot : snapshots)
+        {
+            bool changed = false;
+            for (const DependencyTimes::value_type& dependency : snapshot.dependencies)
+                changed = changed || modificationTime(dependency.first) != dependency.second;
+            if (!changed)
+                continue;
+
+            PreprocessedShader vertex = preprocessor.processFile(snapshot.vertexPath, snapshot.defines);
+            PreprocessedShader fragment = preprocessor.processFile(snapshot.fragmentPath, snapshot.defines);
+            DependencyTimes dependencies = snapshotTimes(vertex.dependencies, fragment.dependencies);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            for (std::unique_ptr<Entry>& entry : entries)
+            {
+                if (entry->id != snapshot.id)
+                    continue;
+                entry->dependencies = dependencies;
+                watchListChanged = true;
+                // un editor puede dejar el archivo vacío o a medio escribir al guardar;
+                // el siguiente evento volverá a intentarlo
+                if (!vertex.ok || !fragment.ok || vertex.empty() || fragment.empty())
+                    continue;
+                // se copia a un solo string: no conviene retener los trozos del
+                // preprocesador hasta que se compile
+                entry->vertexCode = vertex.code();
+                entry->fragmentCode = fragment.code();
+                entry->sourceReady = true;
+            }
+        }
+    }
+
+#ifdef __linux__
+    /**
+     * @brief Bucle del hilo vigilante con inotify
+     * @details Se vigilan los directorios y no los archivos: muchos editores guardan
+     *          escribiendo un temporal y renombrándolo, lo que invalida el watch de archivo.
+     */
+    void watchLoop()
+    {
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0 || wakePipe[0] < 0)
+        {
+            std::cout << "ERROR::HOT_RELOAD::INOTIFY_NO_DISPONIBLE" << std::endl;
+            if (fd >= 0)
+                close(fd);
+            pollLoop();
+            return;
+        }
+        std::vector<std::string> watchedDirs;
+        char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+        while (running)
+        {
+            updateDirectoryWatches(fd, watchedDirs);
+
+            struct pollfd fds[2] = { { fd, POLLIN, 0 }, { wakePipe[0], POLLIN, 0 } };
+            int ready = poll(fds, 2, 250);
+            if (ready <= 0 || !running)
+                continue;
+
+            bool anyEvent = false;
+            ssize_t length;
+            while ((length = read(fd, buffer, sizeof(buffer))) > 0)
+                anyEvent = true;
+            if (anyEvent)
+            {
+                // agrupar ráfagas de eventos de un mismo guardado
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                while (read(fd, buffer, sizeof(buffer)) > 0) {}
+                rescan();
+            }
+        }
+        close(fd);
+    }
+
+    void updateDirectoryWatches(int fd, std::vector<std::string>& watchedDirs)
+    {
+        std::vector<std::string> dirs;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!watchListChanged)
+                return;
+            watchListChanged = false;
+            for (std::unique_ptr<Entry>& entry : entries)
+            {
+                for (const DependencyTimes::value_type& dependency : entry->dependencies)
+                    dirs.push_back(absolutePath(std::filesystem::path(dependency.first).parent_path().string()));
+            }
+        }
+        for (const std::string& dir : dirs)
+        {
+            bool known = false;
+            for (const std::string& watched : watchedDirs)
+                known = known || watched == dir;
+            if (known)
+                continue;
+            if (inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) >= 0)
+                watchedDirs.push_back(dir);
+        }
+    }
+#else
+    void watchLoop()
+    {
+        pollLoop();
+    }
+#endif
+
+    /// Alternativa portable: revisar las fechas de modificación cada 500 ms
+    void pollLoop()
+    {
+        while (running)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            rescan();
+        }
+    }
+};
+
+#endif
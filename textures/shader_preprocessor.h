@@ -0,0 +1,593 @@
+/**
+ * @file shader_preprocessor.h
+ * @brief Preprocesador de shaders con #include, #define inyectados y permutaciones
+ * @details GLSL no tiene #include, así que se resuelve aquí antes de compilar.
+ *          Las permutaciones (p.ej. con/sin textura, color por vértice/uniforme)
+ *          se generan desde una sola fuente inyectando #define después de #version,
+ *          se deduplican por hash del código resultante y se compilan de forma
+ *          perezosa o se precalientan con prewarm().
+ */
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "asset_io.h"
+#include "hash_util.h"
+#include "shader_async.h"
+
+/**
+ * @struct ShaderDefine
+ * @brief Macro que se inyecta en el código del shader (#define name value)
+ */
+struct ShaderDefine
+{
+    std::string name;  ///< Nombre de la macro
+    std::string value; ///< Valor (puede estar vacío)
+};
+
+/**
+ * @struct PreprocessedShader
+ * @brief Resultado de preprocesar un shader
+ * @details El código no se concatena: es una lista de trozos que apuntan a los
+ *          archivos proyectados (o al texto generado para #define y #line), lista
+ *          para glShaderSource con longitudes. storage mantiene vivos esos buffers
+ *          mientras exista el resultado.
+ */
+struct PreprocessedShader
+{
+    std::vector<AssetSpan> sources;                   ///< Trozos del código, en orden
+    std::vector<std::shared_ptr<const void>> storage; ///< Buffers a los que apuntan los trozos
+    std::vector<std::string> dependencies;            ///< Archivos leídos (fuente + includes), para recarga
+    bool ok = true;                                   ///< false si algún #include no se pudo resolver
+
+    /// true si no hay código
+    bool empty() const
+    {
+        for (const AssetSpan& span : sources)
+        {
+            if (span.size != 0)
+                return false;
+        }
+        return true;
+    }
+
+    /// Código completo en un solo string (copia; para guardar o depurar)
+    std::string code() const
+    {
+        std::string joined;
+        for (const AssetSpan& span : sources)
+            joined.append(span.data, span.size);
+        return joined;
+    }
+
+    /// FNV-1a del código completo, sin concatenarlo
+    uint64_t hash(uint64_t seed = 14695981039346656037ull) const
+    {
+        for (const AssetSpan& span : sources)
+            seed = fnv1a64(span.data, span.size, seed);
+        return seed;
+    }
+};
+
+/**
+ * @class ShaderPreprocessor
+ * @brief Resuelve #include e inyecta #define en código GLSL
+ * @details Los includes se buscan, en orden: junto al archivo que incluye, en los
+ *          directorios registrados y entre los archivos virtuales (código en memoria).
+ *          Cada archivo se incluye una sola vez por shader, lo que también corta ciclos.
+ *          Los archivos se proyectan en memoria y las líneas sin directivas se emiten
+ *          como vistas a la proyección, sin copiarlas.
+ */
+class ShaderPreprocessor
+{
+public:
+    /// Agrega un directorio donde buscar los #include
+    void addIncludeDirectory(const std::string& directory)
+    {
+        includeDirectories.push_back(directory);
+    }
+
+    /**
+     * @brief Leer las fuentes siempre del disco, sin consultar los packs montados
+     * @details Necesario con ShaderHotReloader: vigila los archivos en disco y, si
+     *          el código saliera del pack, cada recarga compilaría la copia vieja.
+     *          Estas fuentes se leen con ifstream y no se proyectan: un editor
+     *          puede truncarlas mientras tanto, y leer una página proyectada más
+     *          allá del nuevo final del archivo termina el proceso con SIGBUS.
+     */
+    void setReadFromDisk(bool enabled)
+    {
+        readFromDisk = enabled;
+    }
+
+    bool readsFromDisk() const { return readFromDisk; }
+
+    /// Registra código en memoria que puede incluirse o usarse como fuente por nombre
+    void addVirtualFile(const std::string& name, const std::string& code)
+    {
+        virtualFiles[name] = std::make_shared<const std::string>(code);
+    }
+
+    /**
+     * @brief Preprocesa un archivo (o archivo virtual) de shader
+     * @param path Ruta o nombre virtual
+     * @param defines Macros a inyectar tras la línea #version
+     */
+    PreprocessedShader processFile(const std::string& path, const std::vector<ShaderDefine>& defines = {}) const
+    {
+        SourceBuffer source;
+        if (!load(path, "", source))
+        {
+            std::cout << "ERROR::SHADER::ARCHIVO_NO_LEIDO_CORRECTAMENTE: " << path << std::endl;
+            PreprocessedShader result;
+            result.ok = false;
+            return result;
+        }
+        return processBuffer(source, defines);
+    }
+
+    /**
+     * @brief Preprocesa código ya cargado
+     * @param source Código GLSL (se copia una vez para que el resultado sea dueño)
+     * @param sourceName Nombre para resolver includes relativos y mensajes de error
+     * @param defines Macros a inyectar tras la línea #version
+     */
+    PreprocessedShader process(const std::string& source, const std::string& sourceName,
+                               const std::vector<ShaderDefine>& defines = {}) const
+    {
+        std::shared_ptr<const std::string> code = std::make_shared<const std::string>(source);
+        SourceBuffer buffer;
+        buffer.name = sourceName;
+        buffer.owner = code;
+        buffer.data = code->data();
+        buffer.size = code->size();
+        return processBuffer(buffer, defines);
+    }
+
+private:
+    /**
+     * @struct SourceBuffer
+     * @brief Código de un archivo cargado y quien lo mantiene vivo
+     */
+    struct SourceBuffer
+    {
+        std::string name;                  ///< Nombre resuelto
+        std::shared_ptr<const void> owner; ///< Proyección o string leído del disco o del archivo virtual
+        const char* data = nullptr;
+        size_t size = 0;
+    };
+
+    /**
+     * @class Emitter
+     * @brief Acumula los trozos de salida
+     * @details Los trozos contiguos del mismo archivo se fusionan; el texto generado
+     *          se guarda en un único string cuyos punteros se fijan al terminar.
+     */
+    class Emitter
+    {
+    public:
+        Emitter() : generated(std::make_shared<std::string>()), endsWithNewline(true) {}
+
+        /// Emite una vista al código original
+        void span(const char* data, size_t size)
+        {
+            if (size == 0)
+                return;
+            if (!pieces.empty() && !pieces.back().isGenerated
+                && pieces.back().data + pieces.back().size == data)
+                pieces.back().size += size;
+            else
+                pieces.push_back(Piece{ data, 0, size, false });
+            endsWithNewline = data[size - 1] == '\n';
+        }
+
+        /// Emite texto generado; siempre empieza en una línea nueva
+        void text(const std::string& line)
+        {
+            std::string value = endsWithNewline ? line : "\n" + line;
+            if (!pieces.empty() && pieces.back().isGenerated)
+                pieces.back().size += value.size();
+            else
+                pieces.push_back(Piece{ nullptr, generated->size(), value.size(), true });
+            generated->append(value);
+            endsWithNewline = !value.empty() && value.back() == '\n';
+        }
+
+        void finish(PreprocessedShader& result)
+        {
+            result.sources.reserve(pieces.size());
+            for (const Piece& piece : pieces)
+            {
+                AssetSpan span;
+                span.data = piece.isGenerated ? generated->data() + piece.offset : piece.data;
+                span.size = piece.size;
+                result.sources.push_back(span);
+            }
+            result.storage.push_back(generated);
+        }
+
+    private:
+        struct Piece
+        {
+            const char* data;
+            size_t offset; ///< Posición en generated si isGenerated
+            size_t size;
+            bool isGenerated;
+        };
+
+        std::shared_ptr<std::string> generated;
+        std::vector<Piece> pieces;
+        bool endsWithNewline;
+    };
+
+    std::vector<std::string> includeDirectories;
+    std::map<std::string, std::shared_ptr<const std::string>> virtualFiles;
+    bool readFromDisk = false;
+
+    /// Siguiente línea de [cursor, end), incluido su '\n'; avanza cursor
+    static bool nextLine(const char*& cursor, const char* end, const char*& line, size_t& length)
+    {
+        if (cursor >= end)
+            return false;
+        const char* newline = static_cast<const char*>(memchr(cursor, '\n', (size_t)(end - cursor)));
+        const char* lineEnd = newline ? newline + 1 : end;
+        line = cursor;
+        length = (size_t)(lineEnd - cursor);
+        cursor = lineEnd;
+        return true;
+    }
+
+    /// true si la línea es la directiva indicada ("#  include ...")
+    static bool isDirective(const char* line, size_t length, const char* name)
+    {
+        size_t pos = 0;
+        while (pos < length && (line[pos] == ' ' || line[pos] == '\t'))
+            pos++;
+        if (pos == length || line[pos] != '#')
+            return false;
+        pos++;
+        while (pos < length && (line[pos] == ' ' || line[pos] == '\t'))
+            pos++;
+        size_t nameLength = strlen(name);
+        return length - pos >= nameLength && memcmp(line + pos, name, nameLength) == 0;
+    }
+
+    static std::string defineLines(const std::vector<ShaderDefine>& defines)
+    {
+        std::string out;
+        for (const ShaderDefine& define : defines)
+            out += "#define " + define.name + (define.value.empty() ? "" : " ") + define.value + "\n";
+        return out;
+    }
+
+    static std::string lineDirective(int line, int sourceIndex)
+    {
+        return "#line " + std::to_string(line) + " " + std::to_string(sourceIndex) + "\n";
+    }
+
+    PreprocessedShader processBuffer(const SourceBuffer& source, const std::vector<ShaderDefine>& defines) const
+    {
+        PreprocessedShader result;
+        std::set<std::string> included;
+        included.insert(source.name);
+        result.dependencies.push_back(source.name);
+        result.storage.push_back(source.owner);
+
+        const char* end = source.data + source.size;
+        const char* line;
+        size_t length;
+
+        // los #define van justo después de #version (que puede ir tras comentarios);
+        // si no hay #version, al principio
+        bool hasVersion = false;
+        for (const char* cursor = source.data; !hasVersion && nextLine(cursor, end, line, length);)
+            hasVersion = isDirective(line, length, "version");
+
+        Emitter out;
+        if (!hasVersion)
+            out.text(defineLines(defines) + lineDirective(1, 0));
+        int lineNumber = 0;
+        bool versionSeen = false;
+        for (const char* cursor = source.data; nextLine(cursor, end, line, length);)
+        {
+            lineNumber++;
+            if (!versionSeen && isDirective(line, length, "version"))
+            {
+                versionSeen = true;
+                out.span(line, length);
+                out.text(defineLines(defines) + lineDirective(lineNumber + 1, 0));
+                continue;
+            }
+            if (isDirective(line, length, "include"))
+            {
+                expandInclude(std::string(line, length), source.name, included, result, out, 1);
+                out.text(lineDirective(lineNumber + 1, 0));
+                continue;
+            }
+            out.span(line, length);
+        }
+        out.finish(result);
+        return result;
+    }
+
+    /**
+     * @brief Busca un archivo por nombre y lo proyecta en memoria
+     * @param name Nombre tal como aparece en el #include
+     * @param includer Archivo que lo incluye ("" si es la fuente principal)
+     * @param source Código encontrado y su nombre canónico
+     */
+    bool load(const std::string& name, const std::string& includer, SourceBuffer& source) const
+    {
+        std::vector<std::string> candidates;
+        if (!includer.empty())
+            candidates.push_back((std::filesystem::path(includer).parent_path() / name).lexically_normal().string());
+        else
+            candidates.push_back(std::filesystem::path(name).lexically_normal().string());
+        for (const std::string& directory : includeDirectories)
+            candidates.push_back((std::filesystem::path(directory) / name).lexically_normal().string());
+
+        for (const std::string& candidate : candidates)
+        {
+            if (readFromDisk)
+            {
+                std::shared_ptr<const std::string> code = readDiskFile(candidate);
+                if (!code)
+                    continue;
+                source.name = candidate;
+                source.data = code->data();
+                source.size = code->size();
+                source.owner = code;
+                return true;
+            }
+            AssetFile file = openAsset(candidate, MappedFileAccess::Sequential);
+            if (file)
+            {
+                source.name = candidate;
+                source.data = reinterpret_cast<const char*>(file->data());
+                source.size = file->size();
+                source.owner = file;
+                return true;
+            }
+        }
+        std::map<std::string, std::shared_ptr<const std::string>>::const_iterator found = virtualFiles.find(name);
+        if (found != virtualFiles.end())
+        {
+            source.name = name;
+            source.data = found->second->data();
+            source.size = found->second->size();
+            source.owner = found->second;
+            return true;
+        }
+        return false;
+    }
+
+    /// Copia completa de un archivo del disco, o nullptr si no se puede abrir
+    static std::shared_ptr<const std::string> readDiskFile(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return nullptr;
+        std::shared_ptr<std::string> code = std::make_shared<std::string>(
+            std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (file.bad())
+            return nullptr;
+        return code;
+    }
+
+    void expandInclude(const std::string& line, const std::string& includer, std::set<std::string>& included,
+                       PreprocessedShader& result, Emitter& out, int depth) const
+    {
+        size_t open = line.find_first_of("\"<");
+        size_t close = open == std::string::npos ? open : line.find_first_of("\">", open + 1);
+        if (close == std::string::npos)
+        {
+            std::cout << "ERROR::SHADER::INCLUDE_MAL_FORMADO en " << includer << ": " << line << std::endl;
+            result.ok = false;
+            return;
+        }
+        std::string name = line.substr(open + 1, close - open - 1);
+        SourceBuffer source;
+        if (!load(name, includer, source))
+        {
+            std::cout << "ERROR::SHADER::INCLUDE_NO_ENCONTRADO: " << name << " (desde " << includer << ")" << std::endl;
+            result.ok = false;
+            return;
+        }
+        if (!included.insert(source.name).second)
+            return;
+        if (depth > 32)
+        {
+            std::cout << "ERROR::SHADER::INCLUDE_DEMASIADO_PROFUNDO: " << source.name << std::endl;
+            result.ok = false;
+            return;
+        }
+        result.dependencies.push_back(source.name);
+        result.storage.push_back(source.owner);
+
+        int sourceIndex = static_cast<int>(result.dependencies.size()) - 1;
+        out.text(lineDirective(1, sourceIndex));
+        const char* end = source.data + source.size;
+        const char* includedLine;
+        size_t length;
+        int lineNumber = 0;
+        for (const char* cursor = source.data; nextLine(cursor, end, includedLine, length);)
+        {
+            lineNumber++;
+            if (isDirective(includedLine, length, "version"))
+            {
+                // un include no puede redefinir la versión; se deja como línea vacía
+                out.text("\n");
+                continue;
+            }
+            if (isDirective(includedLine, length, "include"))
+            {
+                expandInclude(std::string(includedLine, length), source.name, included, result, out, depth + 1);
+                out.text(lineDirective(lineNumber + 1, sourceIndex));
+                continue;
+            }
+            out.span(includedLine, length);
+        }
+    }
+};
+
+/**
+ * @brief Preprocesa y emite la compilación de un par de archivos de shader
+ * @details Las líneas sin directivas van de la proyección de cada archivo a
+ *          glShaderSource sin copiarse.
+ * @return Future del programa (ver ShaderBuilder::compile)
+ */
+inline ShaderFuture compileShaderFiles(const ShaderPreprocessor& preprocessor, const char* vertexPath,
+                                       const char* fragmentPath, const std::vector<ShaderDefine>& defines = {})
+{
+    PreprocessedShader vertex = preprocessor.processFile(vertexPath, defines);
+    PreprocessedShader fragment = preprocessor.processFile(fragmentPath, defines);
+    return ShaderBuilder::compile(vertex.sources, fragment.sources);
+}
+
+/**
+ * @brief Preprocesador compartido por Shader y la recarga en caliente
+ */
+inline ShaderPreprocessor& defaultShaderPreprocessor()
+{
+    static ShaderPreprocessor preprocessor;
+    return preprocessor;
+}
+
+/**
+ * @class ShaderPermutationCache
+ * @brief Permutaciones con nombre de un mismo par de fuentes
+ * @details Dos permutaciones cuyo código preprocesado coincide comparten el mismo
+ *          programa. Nada se compila hasta que se pide program() o prewarm().
+ */
+class ShaderPermutationCache
+{
+public:
+    explicit ShaderPermutationCache(const ShaderPreprocessor& preprocessor) : preprocessor(preprocessor) {}
+
+    ~ShaderPermutationCache()
+    {
+        for (std::unique_ptr<CompiledProgram>& compiled : programs)
+        {
+            if (compiled->build.valid())
+                glDeleteProgram(compiled->build.detach());
+        }
+    }
+
+    ShaderPermutationCache(const ShaderPermutationCache&) = delete;
+    ShaderPermutationCache& operator=(const ShaderPermutationCache&) = delete;
+
+    /**
+     * @brief Declara una permutación (no preprocesa ni compila todavía)
+     * @param name Nombre con el que se pedirá el programa
+     * @param vertexSource Archivo o nombre virtual del vertex shader
+     * @param fragmentSource Archivo o nombre virtual del fragment shader
+     * @param defines Macros que distinguen esta permutación
+     */
+    void define(const std::string& name, const std::string& vertexSource, const std::string& fragmentSource,
+                const std::vector<ShaderDefine>& defines = {})
+    {
+        Permutation permutation;
+        permutation.vertexSource = vertexSource;
+        permutation.fragmentSource = fragmentSource;
+        permutation.defines = defines;
+        permutations[name] = permutation;
+    }
+
+    /**
+     * @brief ID del programa de una permutación; la compila si hace falta
+     * @details Bloquea si el programa aún no terminó de compilar. Devuelve 0 si la
+     *          permutación no existe.
+     */
+    unsigned int program(const std::string& name)
+    {
+        CompiledProgram* compiled = resolve(name);
+        return compiled ? compiled->build.get() : 0;
+    }
+
+    /// true si la permutación ya está compilada (no bloquea)
+    bool isReady(const std::string& name)
+    {
+        std::unordered_map<std::string, Permutation>::iterator found = permutations.find(name);
+        return found != permutations.end() && found->second.compiled && found->second.compiled->build.isReady();
+    }
+
+    /**
+     * @brief Emite la compilación de todas las permutaciones declaradas sin esperar
+     * @details Usar al arrancar (o en una pantalla de carga) para que el primer uso
+     *          de cada variante no espere al compilador.
+     */
+    void prewarm()
+    {
+        for (std::unordered_map<std::string, Permutation>::value_type& entry : permutations)
+            resolve(entry.first);
+    }
+
+    /// Cantidad de programas distintos compilados (tras deduplicar)
+    size_t uniqueProgramCount() const { return programs.size(); }
+
+private:
+    struct CompiledProgram
+    {
+        uint64_t hash;
+        ShaderFuture build;
+    };
+
+    struct Permutation
+    {
+        std::string vertexSource;
+        std::string fragmentSource;
+        std::vector<ShaderDefine> defines;
+        CompiledProgram* compiled = nullptr;
+    };
+
+    const ShaderPreprocessor& preprocessor;
+    std::unordered_map<std::string, Permutation> permutations;
+    std::unordered_map<uint64_t, CompiledProgram*> programsByHash;
+    std::vector<std::unique_ptr<CompiledProgram>> programs;
+
+    CompiledProgram* resolve(const std::string& name)
+    {
+        std::unordered_map<std::string, Permutation>::iterator found = permutations.find(name);
+        if (found == permutations.end())
+        {
+            std::cout << "ERROR::SHADER::PERMUTACION_DESCONOCIDA: " << name << std::endl;
+            return nullptr;
+        }
+        Permutation& permutation = found->second;
+        if (permutation.compiled)
+            return permutation.compiled;
+
+        PreprocessedShader vertex = preprocessor.processFile(permutation.vertexSource, permutation.defines);
+        PreprocessedShader fragment = preprocessor.processFile(permutation.fragmentSource, permutation.defines);
+        // el separador evita que "ab"+"c" y "a"+"bc" colisionen
+        uint64_t hash = vertex.hash();
+        hash = fragment.hash(fnv1a64("\0", 1, hash));
+
+        std::unordered_map<uint64_t, CompiledProgram*>::iterator existing = programsByHash.find(hash);
+        if (existing != programsByHash.end())
+        {
+            permutation.compiled = existing->second;
+            return permutation.compiled;
+        }
+        std::unique_ptr<CompiledProgram> compiled(new CompiledProgram());
+        compiled->hash = hash;
+        compiled->build = ShaderBuilder::compile(vertex.sources, fragment.sources);
+        permutation.compiled = compiled.get();
+        programsByHash[hash] = compiled.get();
+        programs.push_back(std::move(compiled));
+        return permutation.compiled;
+    }
+};
+
+#endif
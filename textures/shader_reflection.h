@@ -0,0 +1,325 @@
+/**
+ * @file shader_reflection.h
+ * @brief Reflexión de programas de shaders enlazados
+ * @details Tras el enlazado se enumeran una sola vez los atributos, uniforms,
+ *          bloques uniformes y samplers activos (tipo, tamaño, location, offset)
+ *          en un descriptor compacto e inmutable. Quien dibuja (materiales, colas
+ *          de render) valida y precalcula sus tablas de enlace con él en tiempo de
+ *          carga, en lugar de buscar nombres con glGetUniformLocation cada frame.
+ */
+#ifndef SHADER_REFLECTION_H
+#define SHADER_REFLECTION_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @struct ShaderAttributeInfo
+ * @brief Atributo de vértice activo
+ */
+struct ShaderAttributeInfo
+{
+    std::string name; ///< Nombre en GLSL
+    GLenum type;      ///< GL_FLOAT_VEC3, GL_FLOAT_VEC2, ...
+    int size;         ///< Elementos si es un arreglo, 1 si no
+    int location;     ///< layout (location = N)
+};
+
+/**
+ * @struct ShaderUniformInfo
+ * @brief Uniform activo, suelto o miembro de un bloque
+ */
+struct ShaderUniformInfo
+{
+    std::string name;  ///< Nombre sin el sufijo "[0]" de los arreglos
+    GLenum type;       ///< GL_FLOAT_VEC4, GL_FLOAT_MAT4, GL_SAMPLER_2D, ...
+    int size;          ///< Elementos si es un arreglo, 1 si no
+    int location;      ///< Location (-1 si es miembro de un bloque)
+    int blockIndex;    ///< Índice del bloque (-1 si es un uniform suelto)
+    int offset;        ///< Offset en bytes dentro del bloque (-1 si es suelto)
+    int arrayStride;   ///< Distancia entre elementos de un arreglo dentro del bloque
+    int matrixStride;  ///< Distancia entre columnas de una matriz dentro del bloque
+};
+
+/**
+ * @struct ShaderUniformBlockInfo
+ * @brief Bloque uniforme activo
+ */
+struct ShaderUniformBlockInfo
+{
+    std::string name;         ///< Nombre del bloque (FrameData, MaterialData, ...)
+    unsigned int index;       ///< Índice del bloque en el programa
+    int binding;              ///< Punto de enlace asignado
+    int dataSize;             ///< Tamaño mínimo del buffer en bytes
+    std::vector<int> members; ///< Índices en uniforms() de sus miembros
+};
+
+/**
+ * @struct ShaderSamplerInfo
+ * @brief Sampler activo y la unidad de textura de la que lee
+ */
+struct ShaderSamplerInfo
+{
+    std::string name; ///< Nombre del uniform sampler
+    GLenum type;      ///< GL_SAMPLER_2D, GL_SAMPLER_2D_ARRAY, ...
+    int location;     ///< Location del uniform
+    int unit;         ///< Unidad de textura asignada (valor actual del uniform)
+};
+
+/**
+ * @brief true si el tipo GLSL es un sampler
+ */
+inline bool isSamplerType(GLenum type)
+{
+    switch (type)
+    {
+        case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_1D_SHADOW: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_1D_ARRAY:
+        case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_1D_ARRAY_SHADOW: case GL_SAMPLER_2D_ARRAY_SHADOW:
+        case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_SAMPLER_CUBE_SHADOW:
+        case GL_SAMPLER_BUFFER: case GL_SAMPLER_2D_RECT: case GL_SAMPLER_2D_RECT_SHADOW:
+        case GL_INT_SAMPLER_1D: case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_3D: case GL_INT_SAMPLER_CUBE:
+        case GL_INT_SAMPLER_1D_ARRAY: case GL_INT_SAMPLER_2D_ARRAY: case GL_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_INT_SAMPLER_BUFFER: case GL_INT_SAMPLER_2D_RECT:
+        case GL_UNSIGNED_INT_SAMPLER_1D: case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_3D:
+        case GL_UNSIGNED_INT_SAMPLER_CUBE: case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+        case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Destino de textura (GL_TEXTURE_2D, ...) que lee un tipo de sampler
+ * @return El destino, o 0 si el tipo no es un sampler conocido
+ */
+inline GLenum samplerTextureTarget(GLenum type)
+{
+    switch (type)
+    {
+        case GL_SAMPLER_1D: case GL_SAMPLER_1D_SHADOW: case GL_INT_SAMPLER_1D: case GL_UNSIGNED_INT_SAMPLER_1D:
+            return GL_TEXTURE_1D;
+        case GL_SAMPLER_2D: case GL_SAMPLER_2D_SHADOW: case GL_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_2D:
+            return GL_TEXTURE_2D;
+        case GL_SAMPLER_3D: case GL_INT_SAMPLER_3D: case GL_UNSIGNED_INT_SAMPLER_3D:
+            return GL_TEXTURE_3D;
+        case GL_SAMPLER_CUBE: case GL_SAMPLER_CUBE_SHADOW: case GL_INT_SAMPLER_CUBE: case GL_UNSIGNED_INT_SAMPLER_CUBE:
+            return GL_TEXTURE_CUBE_MAP;
+        case GL_SAMPLER_1D_ARRAY: case GL_SAMPLER_1D_ARRAY_SHADOW: case GL_INT_SAMPLER_1D_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+            return GL_TEXTURE_1D_ARRAY;
+        case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_2D_ARRAY_SHADOW: case GL_INT_SAMPLER_2D_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+            return GL_TEXTURE_2D_ARRAY;
+        case GL_SAMPLER_2D_MULTISAMPLE: case GL_INT_SAMPLER_2D_MULTISAMPLE: case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+            return GL_TEXTURE_2D_MULTISAMPLE;
+        case GL_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+            return GL_TEXTURE_2D_MULTISAMPLE_ARRAY;
+        case GL_SAMPLER_BUFFER: case GL_INT_SAMPLER_BUFFER: case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+            return GL_TEXTURE_BUFFER;
+        case GL_SAMPLER_2D_RECT: case GL_SAMPLER_2D_RECT_SHADOW: case GL_INT_SAMPLER_2D_RECT:
+        case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+            return GL_TEXTURE_RECTANGLE;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @class ShaderReflection
+ * @brief Descriptor inmutable de la interfaz de un programa enlazado
+ * @details Se construye con reflect() y se comparte como puntero a const. Las
+ *          listas están ordenadas por nombre para buscar con búsqueda binaria.
+ */
+class ShaderReflection
+{
+public:
+    /**
+     * @brief Enumera la interfaz activa de un programa ya enlazado
+     * @param program ID del programa (debe haber terminado de enlazar)
+     */
+    static std::shared_ptr<const ShaderReflection> reflect(unsigned int program)
+    {
+        std::shared_ptr<ShaderReflection> reflection(new ShaderReflection());
+        reflection->program = program;
+        reflection->readAttributes();
+        reflection->readUniforms();
+        reflection->readBlocks();
+        return reflection;
+    }
+
+    unsigned int programId() const { return program; }
+    const std::vector<ShaderAttributeInfo>& attributes() const { return attributeList; }
+    const std::vector<ShaderUniformInfo>& uniforms() const { return uniformList; }
+    const std::vector<ShaderUniformBlockInfo>& uniformBlocks() const { return blockList; }
+    const std::vector<ShaderSamplerInfo>& samplers() const { return samplerList; }
+
+    /// Atributo por nombre, o nullptr si no está activo
+    const ShaderAttributeInfo* findAttribute(const std::string& name) const { return find(attributeList, name); }
+    /// Uniform por nombre (suelto o miembro de bloque), o nullptr si no está activo
+    const ShaderUniformInfo* findUniform(const std::string& name) const { return find(uniformList, name); }
+    /// Bloque uniforme por nombre, o nullptr si no está activo
+    const ShaderUniformBlockInfo* findBlock(const std::string& name) const { return find(blockList, name); }
+    /// Sampler por nombre, o nullptr si no está activo
+    const ShaderSamplerInfo* findSampler(const std::string& name) const { return find(samplerList, name); }
+
+    /**
+     * @brief Imprime la interfaz del programa (depuración)
+     */
+    void print(std::ostream& out) const
+    {
+        out << "Programa " << program << "\n";
+        for (const ShaderAttributeInfo& attribute : attributeList)
+            out << "  in      " << attribute.name << " location=" << attribute.location << " type=0x" << std::hex << attribute.type << std::dec << "\n";
+        for (const ShaderUniformInfo& uniform : uniformList)
+        {
+            if (uniform.blockIndex < 0)
+                out << "  uniform " << uniform.name << " location=" << uniform.location << " type=0x" << std::hex << uniform.type << std::dec << "\n";
+        }
+        for (const ShaderUniformBlockInfo& block : blockList)
+        {
+            out << "  block   " << block.name << " binding=" << block.binding << " size=" << block.dataSize << "\n";
+            for (int member : block.members)
+                out << "          " << uniformList[member].name << " offset=" << uniformList[member].offset << "\n";
+        }
+        for (const ShaderSamplerInfo& sampler : samplerList)
+            out << "  sampler " << sampler.name << " unit=" << sampler.unit << "\n";
+    }
+
+private:
+    unsigned int program = 0;
+    std::vector<ShaderAttributeInfo> attributeList;
+    std::vector<ShaderUniformInfo> uniformList;
+    std::vector<ShaderUniformBlockInfo> blockList;
+    std::vector<ShaderSamplerInfo> samplerList;
+
+    ShaderReflection() {}
+
+    template <typename T>
+    static const T* find(const std::vector<T>& list, const std::string& name)
+    {
+        typename std::vector<T>::const_iterator found = std::lower_bound(list.begin(), list.end(), name,
+            [](const T& item, const std::string& key) { return item.name < key; });
+        return (found != list.end() && found->name == name) ? &*found : nullptr;
+    }
+
+    template <typename T>
+    static void sortByName(std::vector<T>& list)
+    {
+        std::sort(list.begin(), list.end(), [](const T& a, const T& b) { return a.name < b.name; });
+    }
+
+    /// Quita el sufijo "[0]" que GL agrega a los arreglos
+    static std::string baseName(const char* name)
+    {
+        std::string result(name);
+        size_t bracket = result.find("[0]");
+        if (bracket != std::string::npos && bracket + 3 == result.size())
+            result.erase(bracket);
+        return result;
+    }
+
+    void readAttributes()
+    {
+        int count = 0;
+        int maxLength = 0;
+        glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+        glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+        std::vector<char> name(maxLength > 0 ? maxLength : 1);
+        for (int i = 0; i < count; i++)
+        {
+            ShaderAttributeInfo attribute;
+            glGetActiveAttrib(program, i, (GLsizei)name.size(), NULL, &attribute.size, &attribute.type, name.data());
+            attribute.name = baseName(name.data());
+            attribute.location = glGetAttribLocation(program, name.data());
+            // los atributos internos (gl_VertexID, ...) no tienen location
+            if (attribute.location >= 0)
+                attributeList.push_back(attribute);
+        }
+        sortByName(attributeList);
+    }
+
+    void readUniforms()
+    {
+        int count = 0;
+        int maxLength = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        if (count <= 0)
+            return;
+
+        // consultar todos los parámetros de bloque de una vez
+        std::vector<GLuint> indices(count);
+        for (int i = 0; i < count; i++)
+            indices[i] = i;
+        std::vector<int> blockIndices(count), offsets(count), arrayStrides(count), matrixStrides(count);
+        glGetActiveUniformsiv(program, count, indices.data(), GL_UNIFORM_BLOCK_INDEX, blockIndices.data());
+        glGetActiveUniformsiv(program, count, indices.data(), GL_UNIFORM_OFFSET, offsets.data());
+        glGetActiveUniformsiv(program, count, indices.data(), GL_UNIFORM_ARRAY_STRIDE, arrayStrides.data());
+        glGetActiveUniformsiv(program, count, indices.data(), GL_UNIFORM_MATRIX_STRIDE, matrixStrides.data());
+
+        std::vector<char> name(maxLength > 0 ? maxLength : 1);
+        for (int i = 0; i < count; i++)
+        {
+            ShaderUniformInfo uniform;
+            glGetActiveUniform(program, i, (GLsizei)name.size(), NULL, &uniform.size, &uniform.type, name.data());
+            uniform.name = baseName(name.data());
+            uniform.blockIndex = blockIndices[i];
+            uniform.location = uniform.blockIndex < 0 ? glGetUniformLocation(program, name.data()) : -1;
+            uniform.offset = offsets[i];
+            uniform.arrayStride = arrayStrides[i];
+            uniform.matrixStride = matrixStrides[i];
+            uniformList.push_back(uniform);
+
+            if (isSamplerType(uniform.type) && uniform.location >= 0)
+            {
+                ShaderSamplerInfo sampler;
+                sampler.name = uniform.name;
+                sampler.type = uniform.type;
+                sampler.location = uniform.location;
+                sampler.unit = 0;
+                glGetUniformiv(program, uniform.location, &sampler.unit);
+                samplerList.push_back(sampler);
+            }
+        }
+        sortByName(uniformList);
+        sortByName(samplerList);
+    }
+
+    void readBlocks()
+    {
+        int count = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+        for (int i = 0; i < count; i++)
+        {
+            ShaderUniformBlockInfo block;
+            int nameLength = 0;
+            glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_NAME_LENGTH, &nameLength);
+            std::vector<char> name(nameLength > 0 ? nameLength : 1);
+            glGetActiveUniformBlockName(program, i, (GLsizei)name.size(), NULL, name.data());
+            block.name = name.data();
+            block.index = i;
+            glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_BINDING, &block.binding);
+            glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &block.dataSize);
+            // miembros por posición en uniformList (ya ordenada)
+            for (size_t u = 0; u < uniformList.size(); u++)
+            {
+                if (uniformList[u].blockIndex == i)
+                    block.members.push_back((int)u);
+            }
+            blockList.push_back(block);
+        }
+        sortByName(blockList);
+    }
+};
+
+#endif
@@ -3,12 +3,17 @@
 
 #include <glad/glad.h>
 
-#include <cmath>
+#include <memory>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
+#include "shader_async.h"
+#include "shader_preprocessor.h"
+#include "uniform_buffer.h"
+#include "shader_reflection.h"
+
 class Shader
 {
 public:
@@ -16,74 +21,56 @@ public:
     // constructor que genera el shader al vuelo
     // ----------------------------------------------------------------
     Shader(const char* vertexPath, const char* fragmentPath)
+        : Shader(compileShaderFiles(defaultShaderPreprocessor(), vertexPath, fragmentPath))
+    {
+        // versión síncrona: resolver de inmediato para reportar errores aquí
+        resolve();
+    }
+    // constructor diferido: toma un programa que puede seguir compilándose.
+    // Solo el primer use() bloquea hasta que el driver termine.
+    // ----------------------------------------------------------------
+    explicit Shader(ShaderFuture&& build)
+        : ID(build.id()), pending(std::move(build)), resolved(false)
+    {
+    }
+    // true si el programa ya terminó de compilar (no bloquea)
+    // ----------------------------------------------------------------
+    bool isReady() const
     {
-        // 1. Obtener el código fuente de los shaders desde los archivos
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        // configurar ifstream para que lance excepciones:
-        vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        try 
-        {
-            // abrir archivos
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // leer contenido del buffer a los streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // cerrar archivos
-            vShaderFile.close();
-            fShaderFile.close();
-            // convertir stream a string
-            vertexCode   = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        }
-        catch (std::ifstream::failure& e)
-        {
-            std::cout << "ERROR::SHADER::ARCHIVO_NO_LEIDO_CORRECTAMENTE: " << e.what() << std::endl;
-        }
-        const char* vShaderCode = vertexCode.c_str();
-        const char * fShaderCode = fragmentCode.c_str();
-        // 2. Compilar shaders
-        unsigned int vertex, fragment;
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-        // fragment shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
-        // programa de shaders
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-        // eliminar los shaders, ya están vinculados al programa y no son necesarios
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+        return pending.isReady();
+    }
+    // reemplazar el programa por otro ya enlazado (recarga en caliente).
+    // Debe llamarse entre frames; el programa anterior se elimina.
+    // ----------------------------------------------------------------
+    void replaceProgram(unsigned int program)
+    {
+        resolve();
+        if (ID != program)
+            glDeleteProgram(ID);
+        ID = program;
+        bindCommonUniformBlocks(ID);
+        reflected.reset();
+    }
+    // interfaz del programa (atributos, uniforms, bloques, samplers).
+    // Se calcula una vez tras el enlazado; consultar en carga, no por frame.
+    // ----------------------------------------------------------------
+    std::shared_ptr<const ShaderReflection> reflection()
+    {
+        resolve();
+        if (!reflected)
+            reflected = ShaderReflection::reflect(ID);
+        return reflected;
     }
     // activar el shader
+    // Las constantes que cambian por frame (tiempo, resolución) llegan por el
+    // bloque FrameData (uniform_buffer.h), escrito una vez por frame para todos
+    // los programas; aquí solo se activa el programa.
     // ----------------------------------------------------------------
     void use() 
     { 
-        float timeValue = glfwGetTime();
-        
-        // Generar valores de color que varían con el tiempo
-        float redValue   = (sin(timeValue * 1.5f) * 0.5f) + 0.5f;  // Rango 0-1
-        float greenValue = (sin(timeValue * 2.0f) * 0.5f) + 0.5f;  // Frecuencia diferente
-        float blueValue  = (sin(timeValue * 1.0f) * 0.5f) + 0.5f; // Frecuencia base
-        
-        // Obtener la ubicación del uniform y asignar el color
-        int vertexColorLocation = glGetUniformLocation(ID, "uColor");
+        // el primer uso bloquea hasta que el programa esté enlazado
+        resolve();
         glUseProgram(ID);
-        glUniform4f(vertexColorLocation, redValue, greenValue, blueValue, 1.0f);
     }
     // funciones de utilidad para uniforms
     // ----------------------------------------------------------------
@@ -103,30 +90,19 @@ public:
     }
 
 private:
-    // función de utilidad para verificar errores de compilación/enlazado
+    ShaderFuture pending;
+    bool resolved;
+    std::shared_ptr<const ShaderReflection> reflected;
+
+    // esperar al enlazado (solo la primera vez) y enlazar los bloques comunes
     // ----------------------------------------------------------------
-    void checkCompileErrors(unsigned int shader, std::string type)
+    void resolve()
     {
-        int success;
-        char infoLog[1024];
-        if (type != "PROGRAM")
-        {
-            glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-            if (!success)
-            {
-                glGetShaderInfoLog(shader, 1024, NULL, infoLog);
-                std::cout << "ERROR::SHADER::ERROR_DE_COMPILACION de tipo: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
-            }
-        }
-        else
-        {
-            glGetProgramiv(shader, GL_LINK_STATUS, &success);
-            if (!success)
-            {
-                glGetProgramInfoLog(shader, 1024, NULL, infoLog);
-                std::cout << "ERROR::SHADER::ERROR_DE_ENLACE de tipo: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
-            }
-        }
+        if (resolved)
+            return;
+        pending.get();
+        bindCommonUniformBlocks(ID);
+        resolved = true;
     }
 };
 #endif
\ No newline at end of file
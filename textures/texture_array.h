@@ -0,0 +1,241 @@
+/**
+ * @file texture_array.h
+ * @brief Arreglo de texturas 2D (GL_TEXTURE_2D_ARRAY) con un pool de capas
+ * @details Alternativa al atlas para imágenes del mismo tamaño: cada imagen ocupa
+ *          una capa completa, sin márgenes ni remapeo de coordenadas, y se puede
+ *          repetir con GL_REPEAT. El vértice (o la instancia) lleva el índice de
+ *          capa y el fragment shader muestrea con
+ *
+ *              uniform sampler2DArray uTextures;
+ *              in float Layer;
+ *              FragColor = texture(uTextures, vec3(TextCoord, Layer));
+ *
+ *          así que figuras con texturas distintas salen en un solo draw call.
+ */
+#ifndef TEXTURE_ARRAY_H
+#define TEXTURE_ARRAY_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "stb_image.h"
+#include "asset_io.h"
+#include "gl_state.h"
+#include "mipmap.h"
+#include "texture_upload.h"
+
+/**
+ * @class TextureArray
+ * @brief Capas de width x height con mipmaps, asignadas desde una lista libre
+ */
+class TextureArray
+{
+public:
+    /**
+     * @param width Ancho de todas las capas
+     * @param height Alto de todas las capas
+     * @param layers Capas del pool (se limita a GL_MAX_ARRAY_TEXTURE_LAYERS)
+     * @param channels Canales por píxel de las imágenes (1-4)
+     * @param mipOptions Filtro de los mipmaps y formato sRGB
+     */
+    TextureArray(int width, int height, int layers, int channels = 4, const MipOptions& mipOptions = MipOptions())
+        : width(width), height(height), channels(channels), mipOptions(mipOptions)
+    {
+        GLint maxLayers = 0;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+        if (maxLayers > 0 && layers > maxLayers)
+        {
+            std::cout << "ERROR::TEXTURE_ARRAY::TOO_MANY_LAYERS\n" << layers << " > " << maxLayers << std::endl;
+            layers = maxLayers;
+        }
+        levels = mipLevelCount(width, height);
+
+        GLenum internalFormat = internalFormatForChannels(channels);
+        if (mipOptions.srgb && channels == 3)
+            internalFormat = GL_SRGB8;
+        else if (mipOptions.srgb && channels == 4)
+            internalFormat = GL_SRGB8_ALPHA8;
+
+        ScopedTextureBinding restore(GL_TEXTURE_2D_ARRAY);
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        for (int level = 0, w = width, h = height; level < levels; level++, w = std::max(1, w / 2), h = std::max(1, h / 2))
+        {
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, level, internalFormat, w, h, layers, 0,
+                         pixelFormatForChannels(channels), GL_UNSIGNED_BYTE, nullptr);
+        }
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+        setGreyscaleSwizzle(GL_TEXTURE_2D_ARRAY, channels);
+
+        // las capas bajas se entregan primero
+        for (int layer = layers - 1; layer >= 0; layer--)
+            freeLayers.push_back(layer);
+        capacity = layers;
+    }
+
+    ~TextureArray()
+    {
+        if (texture)
+            glDeleteTextures(1, &texture);
+    }
+
+    TextureArray(const TextureArray&) = delete;
+    TextureArray& operator=(const TextureArray&) = delete;
+
+    /**
+     * @brief Sube una imagen a una capa libre, con su cadena de mipmaps
+     * @param pixels Imagen de width x height con los canales del arreglo
+     * @return Índice de la capa, o -1 si el tamaño no coincide o no hay capas libres
+     */
+    int upload(const unsigned char* pixels, int imageWidth, int imageHeight)
+    {
+        int layer = allocateLayer(imageWidth, imageHeight);
+        if (layer >= 0)
+            replace(layer, pixels);
+        return layer;
+    }
+
+    /**
+     * @brief Decodifica una imagen (de disco o de un pack montado) y la sube a una capa libre
+     * @return Índice de la capa, o -1 si falló
+     * @details Se decodifica directo en un búfer de staging que el arreglo
+     *          reutiliza entre subidas y que pasa sin copiarse a ser el nivel 0
+     *          de la cadena de mipmaps: sin reserva ni copia por imagen.
+     */
+    int uploadFile(const std::string& path)
+    {
+        AssetFile file = openAsset(path, MappedFileAccess::Sequential);
+        int imageWidth, imageHeight, imageChannels;
+        if (!imageAssetInfo(file, &imageWidth, &imageHeight, &imageChannels))
+        {
+            std::cout << "Failed to load texture: " << path << std::endl;
+            return -1;
+        }
+        int layer = allocateLayer(imageWidth, imageHeight);
+        if (layer < 0)
+            return -1;
+
+        MipLevel base;
+        base.width = width;
+        base.height = height;
+        base.pixels.swap(staging);
+        ImageDecodeTarget target;
+        target.format = imagePixelFormatForChannels(channels);
+        target.width = width;
+        target.height = height;
+        base.pixels.resize(target.rowBytes() * height);
+        target.pixels = base.pixels.data();
+        if (!decodeImageAsset(file, target))
+        {
+            std::cout << "Failed to load texture: " << path << std::endl;
+            staging.swap(base.pixels);
+            release(layer);
+            return -1;
+        }
+        std::vector<MipLevel> chain = generateMipChain(std::move(base), channels, mipOptions);
+        uploadChain(layer, chain);
+        // el nivel 0 vuelve a ser el staging de la próxima subida
+        staging = std::move(chain[0].pixels);
+        return layer;
+    }
+
+    /**
+     * @brief Reemplaza el contenido de una capa ya asignada
+     */
+    void replace(int layer, const unsigned char* pixels)
+    {
+        uploadChain(layer, generateMipChain(pixels, width, height, channels, mipOptions));
+    }
+
+    /**
+     * @brief Devuelve una capa al pool; su contenido queda hasta que se reutilice
+     */
+    void release(int layer)
+    {
+        if (layer >= 0 && layer < capacity && std::find(freeLayers.begin(), freeLayers.end(), layer) == freeLayers.end())
+            freeLayers.push_back(layer);
+    }
+
+    /// Enlaza el arreglo en la unidad de textura indicada
+    void bind(unsigned int unit = 0) const
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    }
+
+    unsigned int id() const { return texture; }
+    int layerCount() const { return capacity; }
+    int freeLayerCount() const { return (int)freeLayers.size(); }
+
+    /// Bytes de VRAM del arreglo completo, con mipmaps
+    size_t memoryBytes() const { return textureMemoryBytes(width, height, channels, true) * capacity; }
+
+private:
+    unsigned int texture = 0;
+    int width;
+    int height;
+    int channels;
+    int levels;
+    int capacity;
+    MipOptions mipOptions;
+    std::vector<int> freeLayers;
+    std::vector<unsigned char> staging; ///< Píxeles decodificados por uploadFile
+
+    /// Toma una capa libre; -1 (con el error en consola) si el tamaño no coincide o no quedan
+    int allocateLayer(int imageWidth, int imageHeight)
+    {
+        if (imageWidth != width || imageHeight != height)
+        {
+            std::cout << "ERROR::TEXTURE_ARRAY::SIZE_MISMATCH\n" << imageWidth << "x" << imageHeight
+                      << " (se esperaba " << width << "x" << height << ")" << std::endl;
+            return -1;
+        }
+        if (freeLayers.empty())
+        {
+            std::cout << "ERROR::TEXTURE_ARRAY::FULL\n" << capacity << " capas en uso" << std::endl;
+            return -1;
+        }
+        int layer = freeLayers.back();
+        freeLayers.pop_back();
+        return layer;
+    }
+
+    void uploadChain(int layer, const std::vector<MipLevel>& chain)
+    {
+        ScopedTextureBinding restore(GL_TEXTURE_2D_ARRAY);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (int level = 0; level < levels; level++)
+        {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, chain[level].width, chain[level].height, 1,
+                            pixelFormatForChannels(channels), GL_UNSIGNED_BYTE, chain[level].pixels.data());
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+};
+
+/**
+ * @brief Declara el índice de capa como atributo de vértice
+ * @param location Ubicación del atributo (float Layer en el shader)
+ * @param stride Bytes por vértice
+ * @param offset Offset del índice dentro del vértice, en bytes
+ * @param perInstance true si el índice va en un buffer por instancia
+ * @details El índice se guarda como float: sampler2DArray recibe la capa en
+ *          la tercera coordenada y así no hace falta glVertexAttribIPointer.
+ */
+inline void setLayerAttribute(unsigned int location, GLsizei stride, size_t offset, bool perInstance = false)
+{
+    glVertexAttribPointer(location, 1, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+    glEnableVertexAttribArray(location);
+    glVertexAttribDivisor(location, perInstance ? 1 : 0);
+}
+
+#endif
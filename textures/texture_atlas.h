@@ -0,0 +1,476 @@
+/**
+ * @file texture_atlas.h
+ * @brief Atlas de texturas: muchas imágenes pequeñas en pocas páginas grandes
+ * @details Cada imagen se ubica en una página con un empaquetador skyline y se
+ *          rodea de un margen que repite sus bordes, para que ni el filtrado
+ *          bilineal ni los mipmaps mezclen imágenes vecinas. Los rectángulos se
+ *          alinean a múltiplos del margen y la cadena de mipmaps se corta en
+ *          log2(margen), así que un texel de cualquier nivel solo cubre píxeles
+ *          de una misma imagen. Las imágenes se pueden agregar en tiempo de
+ *          ejecución: insert escribe en la copia de CPU y flush sube solo los
+ *          rectángulos nuevos, con sus mipmaps generados a partir de ese
+ *          rectángulo (la alineación garantiza que el resultado es el mismo que
+ *          el de la página entera con el filtro de caja). Con remapUVs las coordenadas de los vértices pasan al
+ *          rectángulo del atlas y todas las figuras de una página se dibujan con
+ *          un único bind.
+ * @note Las coordenadas fuera de [0, 1] no se repiten dentro del rectángulo:
+ *       las páginas usan GL_CLAMP_TO_EDGE, así que las imágenes que se repiten
+ *       sobre la figura deben quedar fuera del atlas.
+ */
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "stb_image.h"
+#include "asset_io.h"
+#include "gl_state.h"
+#include "mipmap.h"
+
+/**
+ * @class SkylinePacker
+ * @brief Empaquetador skyline bottom-left para rectángulos en una página
+ * @details Guarda el contorno superior de lo ya ubicado como una lista de
+ *          segmentos horizontales; cada rectángulo va donde su borde superior
+ *          quede más bajo, desempatando por el segmento más angosto.
+ */
+class SkylinePacker
+{
+public:
+    SkylinePacker(int width = 0, int height = 0) { reset(width, height); }
+
+    void reset(int pageWidth, int pageHeight)
+    {
+        width = pageWidth;
+        height = pageHeight;
+        usedArea = 0;
+        skyline.clear();
+        skyline.push_back({ 0, 0, pageWidth });
+    }
+
+    /**
+     * @brief Ubica un rectángulo de w x h
+     * @return false si no entra en la página
+     */
+    bool insert(int w, int h, int& x, int& y)
+    {
+        int bestIndex = -1;
+        int bestTop = height + 1;
+        int bestWidth = width + 1;
+        for (size_t i = 0; i < skyline.size(); i++)
+        {
+            int fitY;
+            if (!fits(i, w, h, fitY))
+                continue;
+            if (fitY + h < bestTop || (fitY + h == bestTop && skyline[i].width < bestWidth))
+            {
+                bestIndex = (int)i;
+                bestTop = fitY + h;
+                bestWidth = skyline[i].width;
+                y = fitY;
+            }
+        }
+        if (bestIndex < 0)
+            return false;
+
+        x = skyline[bestIndex].x;
+        skyline.insert(skyline.begin() + bestIndex, { x, y + h, w });
+        // recortar los segmentos que quedaron debajo del nuevo
+        for (size_t i = bestIndex + 1; i < skyline.size();)
+        {
+            int end = skyline[i - 1].x + skyline[i - 1].width;
+            if (skyline[i].x >= end)
+                break;
+            int shrink = end - skyline[i].x;
+            skyline[i].x += shrink;
+            skyline[i].width -= shrink;
+            if (skyline[i].width > 0)
+                break;
+            skyline.erase(skyline.begin() + i);
+        }
+        // unir segmentos contiguos a la misma altura
+        for (size_t i = 0; i + 1 < skyline.size();)
+        {
+            if (skyline[i].y == skyline[i + 1].y)
+            {
+                skyline[i].width += skyline[i + 1].width;
+                skyline.erase(skyline.begin() + i + 1);
+            }
+            else
+            {
+                i++;
+            }
+        }
+        usedArea += (size_t)w * h;
+        return true;
+    }
+
+    /// Fracción del área de la página ocupada por rectángulos
+    float occupancy() const { return width > 0 && height > 0 ? (float)usedArea / ((float)width * height) : 0.0f; }
+
+private:
+    struct Segment
+    {
+        int x;
+        int y;
+        int width;
+    };
+
+    std::vector<Segment> skyline;
+    int width;
+    int height;
+    size_t usedArea;
+
+    /// Altura a la que entra un rectángulo que empieza en el segmento index
+    bool fits(size_t index, int w, int h, int& y) const
+    {
+        int x = skyline[index].x;
+        if (x + w > width)
+            return false;
+        y = 0;
+        int remaining = w;
+        for (size_t i = index; remaining > 0; i++)
+        {
+            if (i == skyline.size())
+                return false;
+            y = std::max(y, skyline[i].y);
+            if (y + h > height)
+                return false;
+            remaining -= skyline[i].width;
+        }
+        return true;
+    }
+};
+
+/**
+ * @struct AtlasRegion
+ * @brief Ubicación de una imagen dentro del atlas
+ */
+struct AtlasRegion
+{
+    int page;           ///< Página del atlas (ver TextureAtlas::texture)
+    int x, y;           ///< Esquina de la imagen en píxeles, sin el margen
+    int width, height;
+    float u0, v0;       ///< Coordenadas de textura de la esquina (0, 0) de la imagen
+    float u1, v1;       ///< Coordenadas de textura de la esquina (1, 1) de la imagen
+
+    /// Pasa una coordenada de la imagen original a la página del atlas
+    void remap(float& u, float& v) const
+    {
+        u = u0 + u * (u1 - u0);
+        v = v0 + v * (v1 - v0);
+    }
+};
+
+/**
+ * @brief Reescribe las coordenadas de textura de un arreglo de vértices intercalados
+ * @param vertices Vértices en floats
+ * @param vertexCount Cantidad de vértices
+ * @param stride Floats por vértice
+ * @param uvOffset Posición de (u, v) dentro del vértice, en floats
+ * @param region Región del atlas de la imagen que usan estos vértices
+ */
+inline void remapUVs(float* vertices, size_t vertexCount, size_t stride, size_t uvOffset, const AtlasRegion& region)
+{
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        float* uv = vertices + i * stride + uvOffset;
+        region.remap(uv[0], uv[1]);
+    }
+}
+
+/**
+ * @class TextureAtlas
+ * @brief Páginas RGBA8 con imágenes empaquetadas e inserción incremental
+ */
+class TextureAtlas
+{
+public:
+    /**
+     * @param pageSize Lado de cada página en píxeles
+     * @param padding Margen alrededor de cada imagen; se redondea a potencia de 2
+     *                y fija cuántos mipmaps tiene cada página (log2(padding) + 1)
+     * @param mipOptions Filtro de los mipmaps (srgb también elige el formato interno);
+     *                   kaiser y lanczos leen más allá de la caja y piden más margen
+     */
+    explicit TextureAtlas(int pageSize = 2048, int padding = 4, const MipOptions& mipOptions = MipOptions())
+        : pageSize(pageSize), padding(1), mipLevels(1), mipOptions(mipOptions)
+    {
+        while (this->padding < padding)
+            this->padding *= 2;
+        for (int p = this->padding; p > 1; p /= 2)
+            mipLevels++;
+    }
+
+    ~TextureAtlas()
+    {
+        for (Page& page : pages)
+        {
+            if (page.texture)
+                glDeleteTextures(1, &page.texture);
+        }
+    }
+
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    /**
+     * @brief Agrega una imagen RGBA8 al atlas
+     * @param name Clave para find; si ya existe devuelve la región existente
+     * @param pixels w * h píxeles RGBA, filas de arriba hacia abajo como stb_image
+     * @return Región de la imagen, o nullptr si no entra en una página vacía
+     * @details La página se sube a la GPU en el siguiente flush.
+     */
+    const AtlasRegion* insert(const std::string& name, const unsigned char* pixels, int width, int height)
+    {
+        auto existing = regions.find(name);
+        if (existing != regions.end())
+            return &existing->second;
+        const AtlasRegion* region = allocate(name, width, height);
+        if (!region)
+            return nullptr;
+        copyImageRows(pixels, (size_t)width * 4, regionPixels(*region), (size_t)pageSize * 4, (size_t)width * 4, height);
+        extrude(*region);
+        return region;
+    }
+
+    /**
+     * @brief Decodifica una imagen (de disco o de un pack montado) y la agrega
+     * @return Región de la imagen, o nullptr si no se pudo cargar o no entra
+     * @details Se lee solo la cabecera para reservar el lugar y la imagen se
+     *          decodifica directo en la copia en CPU de la página, sin búfer
+     *          intermedio. Si la decodificación falla a mitad el lugar queda sin usar.
+     */
+    const AtlasRegion* insertFile(const std::string& path)
+    {
+        auto existing = regions.find(path);
+        if (existing != regions.end())
+            return &existing->second;
+
+        AssetFile file = openAsset(path, MappedFileAccess::Sequential);
+        int width, height, channels;
+        if (!imageAssetInfo(file, &width, &height, &channels))
+        {
+            std::cout << "Failed to load texture: " << path << std::endl;
+            return nullptr;
+        }
+        const AtlasRegion* region = allocate(path, width, height);
+        if (!region)
+            return nullptr;
+
+        ImageDecodeTarget target;
+        target.format = ImagePixelFormat::RGBA8;
+        target.pixels = regionPixels(*region);
+        target.rowStride = (size_t)pageSize * 4;
+        target.width = width;
+        target.height = height;
+        if (!decodeImageAsset(file, target))
+        {
+            std::cout << "Failed to load texture: " << path << std::endl;
+            regions.erase(path);
+            return nullptr;
+        }
+        extrude(*region);
+        return region;
+    }
+
+    /// Región de una imagen ya agregada, o nullptr
+    const AtlasRegion* find(const std::string& name) const
+    {
+        auto it = regions.find(name);
+        return it == regions.end() ? nullptr : &it->second;
+    }
+
+    /**
+     * @brief Sube a la GPU los rectángulos con imágenes nuevas y sus mipmaps
+     * @details Cada rectángulo es el lugar reservado para una imagen, margen
+     *          incluido; sus mipLevels niveles se generan solo a partir de él y se
+     *          suben con glTexSubImage2D en su posición. El resto de la página no
+     *          se toca. Conviene llamarlo una vez tras una tanda de inserciones,
+     *          antes de dibujar.
+     * @return Bytes subidos (todos los niveles)
+     */
+    size_t flush()
+    {
+        ScopedTextureBinding restore;
+        size_t uploaded = 0;
+        for (Page& page : pages)
+        {
+            if (page.dirty.empty())
+                continue;
+            glBindTexture(GL_TEXTURE_2D, page.texture);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            for (const Slot& slot : page.dirty)
+            {
+                MipLevel base;
+                base.width = slot.width;
+                base.height = slot.height;
+                base.pixels.resize((size_t)slot.width * slot.height * 4);
+                copyImageRows(page.pixels.data() + ((size_t)slot.y * pageSize + slot.x) * 4, (size_t)pageSize * 4,
+                              base.pixels.data(), (size_t)slot.width * 4, (size_t)slot.width * 4, slot.height);
+                // los lados son múltiplos de padding = 2^(mipLevels - 1): cada nivel divide exacto
+                std::vector<MipLevel> chain = generateMipChain(std::move(base), 4, mipOptions, mipLevels);
+                for (int level = 0; level < (int)chain.size(); level++)
+                {
+                    glTexSubImage2D(GL_TEXTURE_2D, level, slot.x >> level, slot.y >> level, chain[level].width,
+                                    chain[level].height, GL_RGBA, GL_UNSIGNED_BYTE, chain[level].pixels.data());
+                    uploaded += chain[level].pixels.size();
+                }
+            }
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            page.dirty.clear();
+        }
+        return uploaded;
+    }
+
+    /// ID de la textura GL de una página
+    unsigned int texture(int page) const { return pages[page].texture; }
+
+    /// Enlaza la página de una región en la unidad de textura indicada
+    void bind(int page, unsigned int unit = 0) const
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, pages[page].texture);
+    }
+
+    int pageCount() const { return (int)pages.size(); }
+    int imageCount() const { return (int)regions.size(); }
+    float occupancy(int page) const { return pages[page].packer.occupancy(); }
+
+private:
+    /**
+     * @struct Slot
+     * @brief Lugar reservado para una imagen, margen incluido, alineado a padding
+     */
+    struct Slot
+    {
+        int x, y;
+        int width, height;
+    };
+
+    /**
+     * @struct Page
+     * @brief Textura GL de una página, su copia en CPU y su empaquetador
+     */
+    struct Page
+    {
+        unsigned int texture = 0;
+        std::vector<unsigned char> pixels;
+        SkylinePacker packer;
+        std::vector<Slot> dirty; ///< Lugares escritos desde el último flush
+    };
+
+    std::vector<Page> pages;
+    std::unordered_map<std::string, AtlasRegion> regions;
+    int pageSize;
+    int padding;
+    int mipLevels;
+    MipOptions mipOptions;
+
+    int alignUp(int value) const { return (value + padding - 1) / padding * padding; }
+
+    void addPage()
+    {
+        pages.emplace_back();
+        Page& page = pages.back();
+        page.pixels.assign((size_t)pageSize * pageSize * 4, 0);
+        page.packer.reset(pageSize, pageSize);
+
+        GLenum internalFormat = mipOptions.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+        ScopedTextureBinding restore;
+        glGenTextures(1, &page.texture);
+        glBindTexture(GL_TEXTURE_2D, page.texture);
+        for (int level = 0, size = pageSize; level < mipLevels; level++, size = std::max(1, size / 2))
+            glTexImage2D(GL_TEXTURE_2D, level, internalFormat, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipLevels - 1);
+        // fuera de los lugares reservados la textura queda sin inicializar: nunca se
+        // muestrea, porque ningún texel de ningún nivel cruza el borde de un lugar
+    }
+
+    /**
+     * @brief Reserva el lugar de una imagen y registra su región
+     * @return Región, o nullptr si la imagen no entra en una página vacía
+     */
+    const AtlasRegion* allocate(const std::string& name, int width, int height)
+    {
+        int slotWidth = alignUp(width + 2 * padding);
+        int slotHeight = alignUp(height + 2 * padding);
+        if (width <= 0 || height <= 0 || slotWidth > pageSize || slotHeight > pageSize)
+        {
+            std::cout << "ERROR::ATLAS::IMAGE_TOO_LARGE\n" << name << " (" << width << "x" << height << ")" << std::endl;
+            return nullptr;
+        }
+
+        int slotX = 0, slotY = 0;
+        size_t pageIndex = 0;
+        while (pageIndex < pages.size() && !pages[pageIndex].packer.insert(slotWidth, slotHeight, slotX, slotY))
+            pageIndex++;
+        if (pageIndex == pages.size())
+        {
+            addPage();
+            pages.back().packer.insert(slotWidth, slotHeight, slotX, slotY);
+        }
+        pages[pageIndex].dirty.push_back({ slotX, slotY, slotWidth, slotHeight });
+
+        AtlasRegion region;
+        region.page = (int)pageIndex;
+        region.x = slotX + padding;
+        region.y = slotY + padding;
+        region.width = width;
+        region.height = height;
+        // stb_image deja la fila 0 arriba y se sube tal cual: v = 0 es la fila 0
+        region.u0 = (float)region.x / pageSize;
+        region.v0 = (float)region.y / pageSize;
+        region.u1 = (float)(region.x + width) / pageSize;
+        region.v1 = (float)(region.y + height) / pageSize;
+        return &regions.emplace(name, region).first->second;
+    }
+
+    /// Primer píxel de una región en la copia en CPU de su página
+    unsigned char* regionPixels(const AtlasRegion& region)
+    {
+        return pages[region.page].pixels.data() + ((size_t)region.y * pageSize + region.x) * 4;
+    }
+
+    /**
+     * @brief Repite los bordes de una región ya copiada en el relleno que la rodea
+     * @details Primero hacia los lados en cada fila y después las filas extremas
+     *          (ya extendidas) hacia arriba y abajo, esquinas incluidas.
+     */
+    void extrude(const AtlasRegion& region)
+    {
+        size_t pitch = (size_t)pageSize * 4;
+        unsigned char* first = regionPixels(region);
+        for (int row = 0; row < region.height; row++)
+        {
+            unsigned char* target = first + row * pitch;
+            for (int i = 1; i <= padding; i++)
+            {
+                memcpy(target - i * 4, target, 4);
+                memcpy(target + (size_t)(region.width + i - 1) * 4, target + (size_t)(region.width - 1) * 4, 4);
+            }
+        }
+        size_t paddedBytes = (size_t)(region.width + 2 * padding) * 4;
+        unsigned char* top = first - padding * 4;
+        unsigned char* bottom = top + (region.height - 1) * pitch;
+        for (int i = 1; i <= padding; i++)
+        {
+            memcpy(top - i * pitch, top, paddedBytes);
+            memcpy(bottom + i * pitch, bottom, paddedBytes);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,841 @@
+/**
+ * @file texture_cache.h
+ * @brief Caché de texturas con conteo de referencias, deduplicación y carga progresiva
+ * @details Una textura se identifica por su ruta canónica y, tras decodificarla,
+ *          por el hash de su contenido: pedir la misma imagen por dos rutas (o dos
+ *          copias del mismo archivo) termina usando la misma textura GL. Los handles
+ *          cuentan referencias; las texturas sin referencias quedan residentes en
+ *          una lista LRU y solo se expulsan cuando la memoria residente supera el
+ *          presupuesto de VRAM configurado.
+ *
+ *          La carga es progresiva: load() devuelve de inmediato una textura GL
+ *          válida con un patrón de reemplazo; una tarea del JobSystem prepara la
+ *          cadena de mipmaps (o proyecta el .ltex, que ya la trae) y update(), en
+ *          el hilo de render, sube los niveles del más chico al más grande con un
+ *          límite de bytes por frame. GL_TEXTURE_BASE_LEVEL apunta siempre al nivel
+ *          más fino ya subido, así que se dibuja con lo que haya sin muestrear
+ *          niveles vacíos. El orden lo decide el tamaño en pantalla
+ *          (setScreenSize): lo que más se ve se decodifica y se afina antes, y los
+ *          niveles más finos que la pantalla no se suben hasta que hagan falta.
+ *          Si la imagen no se puede cargar la textura conserva el patrón de
+ *          reemplazo, nunca datos sin inicializar.
+ */
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "asset_io.h"
+#include "bc_encoder.h"
+#include "gl_state.h"
+#include "hash_util.h"
+#include "job_system.h"
+#include "mipmap.h"
+#include "texture_container.h"
+#include "texture_source.h"
+#include "texture_upload.h"
+
+/**
+ * @enum TextureState
+ * @brief Etapa de carga de una textura de la caché
+ */
+enum class TextureState
+{
+    Queued,    ///< Esperando a ser decodificada; se dibuja el patrón de reemplazo
+    Streaming, ///< Decodificada; faltan niveles por subir
+    Resident,  ///< Todos los niveles necesarios están en la GPU
+    Failed     ///< No se pudo cargar; se queda con el patrón de reemplazo
+};
+
+class TextureCache;
+
+/**
+ * @class TextureHandle
+ * @brief Referencia contada a una textura de la caché
+ * @details El nombre GL es estable mientras los niveles van llegando. Si al
+ *          decodificarla resulta igual a otra ya residente, pasa a usar la textura
+ *          GL de esa: id() cambia una única vez, del patrón de reemplazo a la
+ *          textura compartida. Por eso conviene consultarlo al dibujar (los
+ *          materiales lo hacen a través de TextureSource).
+ * @note La caché debe vivir más que todos sus handles.
+ */
+class TextureHandle : public TextureSource
+{
+public:
+    TextureHandle() : cache(nullptr), entry(nullptr) {}
+    TextureHandle(const TextureHandle& other);
+    TextureHandle(TextureHandle&& other) noexcept : cache(other.cache), entry(other.entry)
+    {
+        other.cache = nullptr;
+        other.entry = nullptr;
+    }
+    TextureHandle& operator=(TextureHandle other) noexcept
+    {
+        std::swap(cache, other.cache);
+        std::swap(entry, other.entry);
+        return *this;
+    }
+    ~TextureHandle();
+
+    /// ID de la textura GL (0 si el handle está vacío); válido desde load(), aunque aún no haya niveles
+    unsigned int id() const;
+    unsigned int textureId() const override { return id(); }
+    int width() const;
+    int height() const;
+    int channels() const;
+    TextureState state() const;
+
+    /// Nivel más fino subido (levelCount() si todavía no hay ninguno)
+    int residentLevel() const;
+    int levelCount() const;
+
+    explicit operator bool() const { return entry != nullptr; }
+
+private:
+    friend class TextureCache;
+    struct Entry;
+
+    TextureCache* cache;
+    Entry* entry;
+
+    TextureHandle(TextureCache* cache, Entry* entry);
+};
+
+/**
+ * @struct TextureHandle::Entry
+ * @brief Textura de la caché, sus niveles pendientes y sus claves
+ */
+struct TextureHandle::Entry
+{
+    /**
+     * @struct Level
+     * @brief Nivel listo para subir; apunta a storage o al .ltex proyectado
+     */
+    struct Level
+    {
+        int width;
+        int height;
+        const unsigned char* data;
+        size_t size;
+    };
+
+    std::string path; ///< Ruta canónica
+    unsigned int id = 0;
+    std::atomic<TextureState> state{ TextureState::Queued };
+    std::atomic<float> screenSize{ 0.0f }; ///< Lado mayor en píxeles de pantalla; 0 = desconocido
+    // escritos por la tarea de decodificación antes de publicar la textura como lista
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    GLenum internalFormat = 0;
+    bool compressed = false;
+    std::vector<Level> levels;
+    std::vector<std::vector<unsigned char>> storage;
+    AssetFile cooked;
+    // solo en el hilo de render
+    bool allocated = false;
+    int finestLevel = 0;
+    std::shared_ptr<Entry> alias; ///< Textura con el mismo contenido que se usa en su lugar
+    // protegidos por el mutex de la caché
+    int references = 0;
+    size_t bytes = 0;    ///< Memoria de GPU contada en residentBytes()
+    uint64_t contentHash = 0;
+    bool hashed = false; ///< contentHash es válido y está registrado
+    bool evicted = false;
+    bool inLru = false;
+    std::list<Entry*>::iterator lruPosition; ///< Posición en la LRU si no tiene referencias
+
+    const Entry& resolved() const { return alias ? *alias : *this; }
+};
+
+/**
+ * @struct TextureCacheStats
+ * @brief Contadores de uso de la caché
+ */
+struct TextureCacheStats
+{
+    size_t pathHits = 0;    ///< Peticiones resueltas por ruta, sin leer el archivo
+    size_t contentHits = 0; ///< Archivos decodificados cuyo contenido ya estaba residente
+    size_t uploads = 0;     ///< Texturas que pasaron a tener sus niveles en la GPU
+    size_t evictions = 0;   ///< Texturas expulsadas por presupuesto
+    size_t failures = 0;    ///< Archivos que no se pudieron cargar
+};
+
+/**
+ * @class TextureCache
+ * @brief Gestor de texturas con deduplicación, refcount, expulsión LRU y subida progresiva
+ * @details Cada load() de una ruta nueva encola una tarea en el JobSystem; al
+ *          correr, la tarea toma la textura pendiente más grande en pantalla. Si el
+ *          pool no tiene hilos trabajadores, update() ejecuta una tarea por frame
+ *          en el hilo de render.
+ * @note Borra sus texturas GL al destruirse y antes espera a sus tareas en curso.
+ */
+class TextureCache
+{
+public:
+    typedef TextureHandle::Entry Entry;
+
+    /**
+     * @param uploadBudget Bytes que update() sube como máximo por llamada
+     *                     (siempre sube al menos un nivel para no estancarse)
+     * @param budgetBytes Presupuesto de memoria de texturas en bytes
+     * @param jobs Pool donde se decodifica
+     */
+    explicit TextureCache(size_t uploadBudget = 4u * 1024u * 1024u, size_t budgetBytes = 256u * 1024u * 1024u,
+                          JobSystem& jobs = defaultJobSystem())
+        : jobs(jobs), uploadBudget(uploadBudget), budget(budgetBytes), resident(0), running(true)
+    {
+    }
+
+    ~TextureCache()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        // las tareas que aún no empezaron salen sin decodificar
+        if (jobs.workerCount() == 0)
+        {
+            while (jobs.runPending())
+            {
+            }
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            tasksDone.wait(lock, [this]() { return outstandingTasks == 0; });
+        }
+        for (auto& entry : entries)
+        {
+            if (entry.second->id)
+                glDeleteTextures(1, &entry.second->id);
+        }
+    }
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    /**
+     * @brief Obtiene la textura de una imagen o un .ltex; la misma ruta devuelve la misma textura
+     * @details Retorna sin esperar a la decodificación. Llamar desde el hilo de
+     *          render: crea el patrón de reemplazo y puede expulsar texturas.
+     * @param path Ruta de la imagen
+     * @return Handle con referencia; al soltar la última copia la textura pasa a la LRU
+     */
+    TextureHandle load(const std::string& path)
+    {
+        std::string key = canonicalPath(path);
+        std::lock_guard<std::mutex> lock(mutex);
+        auto existing = entries.find(key);
+        if (existing != entries.end())
+        {
+            stats.pathHits++;
+            return TextureHandle(this, existing->second.get());
+        }
+
+        std::shared_ptr<Entry> entry = std::make_shared<Entry>();
+        entry->path = key;
+        entry->id = newPlaceholderTexture();
+        entry->bytes = PLACEHOLDER_BYTES;
+        resident += entry->bytes;
+        entries[key] = entry;
+        queued.push_back({ entry, compression, mipOptions });
+        outstandingTasks++;
+        jobs.submit([this]() { decodeNext(); });
+        TextureHandle handle(this, entry.get());
+        // la nueva textura ya está referenciada, así que no puede ser la expulsada
+        enforceBudget();
+        return handle;
+    }
+
+    /**
+     * @brief Tamaño aproximado con que se dibuja la textura, en píxeles
+     * @details Llamar cada frame (o al cambiar): ordena la decodificación y la
+     *          subida y limita el nivel más fino que se sube.
+     */
+    void setScreenSize(const TextureHandle& texture, float pixelsWide, float pixelsHigh)
+    {
+        if (texture.entry)
+            texture.entry->screenSize = std::max(pixelsWide, pixelsHigh);
+    }
+
+    /**
+     * @brief Sube los niveles pendientes, los de mayor tamaño en pantalla primero
+     * @details Llamar una vez por frame desde el hilo de render. Las texturas sin
+     *          referencias se expulsan aquí (o en load()), nunca al soltar un handle.
+     */
+    void update()
+    {
+        if (jobs.workerCount() == 0)
+            jobs.runPending();
+        std::vector<std::shared_ptr<Entry>> candidates;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            applyAliases();
+            enforceBudget();
+            candidates = streaming;
+        }
+        if (candidates.empty())
+            return;
+        std::sort(candidates.begin(), candidates.end(), [](const std::shared_ptr<Entry>& a, const std::shared_ptr<Entry>& b) {
+            return a->screenSize.load() > b->screenSize.load();
+        });
+
+        // la textura enlazada en la unidad activa sigue siendo la de antes al volver
+        ScopedTextureBinding restore;
+        size_t uploaded = 0;
+        bool changed = false;
+        for (const std::shared_ptr<Entry>& entry : candidates)
+        {
+            if (uploaded >= uploadBudget)
+                break;
+            if (!entry->allocated)
+            {
+                allocate(*entry);
+                accountAllocation(*entry);
+            }
+            int target = targetLevel(*entry);
+            if (entry->finestLevel <= target)
+                continue;
+            glBindTexture(GL_TEXTURE_2D, entry->id);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            while (entry->finestLevel > target && uploaded < uploadBudget)
+            {
+                int level = entry->finestLevel - 1;
+                uploadLevel(*entry, level);
+                uploaded += entry->levels[level].size;
+                entry->finestLevel = level;
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+            }
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            if (entry->finestLevel == 0)
+            {
+                // ya no hace falta la copia en CPU
+                entry->state = TextureState::Resident;
+                entry->levels.clear();
+                entry->storage.clear();
+                entry->cooked.reset();
+                changed = true;
+            }
+        }
+        if (changed)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            streaming.erase(std::remove_if(streaming.begin(), streaming.end(), [](const std::shared_ptr<Entry>& entry) {
+                return entry->state == TextureState::Resident;
+            }), streaming.end());
+            enforceBudget();
+        }
+    }
+
+    /// Bytes de VRAM reservados por las texturas (todos sus niveles, subidos o no)
+    size_t residentBytes()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return resident;
+    }
+
+    /// Cantidad de texturas conocidas (residentes, en cola o con niveles por subir)
+    size_t residentCount()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+
+    /// Presupuesto de VRAM actual
+    size_t budgetBytes() const { return budget; }
+
+    /**
+     * @brief Cambia el presupuesto y expulsa lo necesario para cumplirlo
+     */
+    void setBudget(size_t budgetBytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        budget = budgetBytes;
+        enforceBudget();
+    }
+
+    /// Expulsa todas las texturas sin referencias (también las que aún no terminaron de llegar)
+    void purgeUnused()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (!lru.empty())
+            evict(lru.back());
+    }
+
+    TextureCacheStats statistics()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+    /// Filtro y espacio de color de los mipmaps de las imágenes que se carguen después
+    void setMipOptions(const MipOptions& options) { mipOptions = options; }
+
+    /**
+     * @brief Compresión por bloques de las imágenes que se carguen después
+     * @details Si el contexto no soporta el formato, se suben sin comprimir.
+     */
+    void setCompression(TextureCompression preferred) { compression = preferred; }
+
+    /// true si no hay nada por decodificar ni por subir
+    bool idle()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queued.empty() && busyDecoders == 0 && streaming.empty();
+    }
+
+private:
+    friend class TextureHandle;
+
+    /**
+     * @struct DecodeJob
+     * @brief Textura pendiente y las opciones vigentes cuando se pidió
+     */
+    struct DecodeJob
+    {
+        std::shared_ptr<Entry> entry;
+        TextureCompression compression;
+        MipOptions mipOptions;
+    };
+
+    /**
+     * @struct PendingAlias
+     * @brief Duplicado detectado al decodificar; update() lo redirige en el hilo de render
+     */
+    struct PendingAlias
+    {
+        std::shared_ptr<Entry> duplicate;
+        std::shared_ptr<Entry> original;
+    };
+
+    /// El tablero de 2x2 RGBA8 de newPlaceholderTexture()
+    static const size_t PLACEHOLDER_BYTES = 16;
+
+    JobSystem& jobs;
+    std::unordered_map<std::string, std::shared_ptr<Entry>> entries; ///< Por ruta canónica
+    std::unordered_map<uint64_t, Entry*> byHash;
+    std::list<Entry*> lru; ///< Texturas sin referencias; la más reciente al frente
+    std::vector<DecodeJob> queued;
+    std::vector<std::shared_ptr<Entry>> streaming; ///< Decodificadas con niveles por subir
+    std::vector<PendingAlias> aliases;
+    std::mutex mutex;
+    std::condition_variable tasksDone;
+    int outstandingTasks = 0; ///< Tareas encoladas en jobs que aún no terminaron
+    int busyDecoders = 0;
+    size_t uploadBudget;
+    size_t budget;
+    size_t resident;
+    bool running;
+    TextureCacheStats stats;
+    MipOptions mipOptions;
+    TextureCompression compression = TextureCompression::None;
+
+    static std::string canonicalPath(const std::string& path)
+    {
+        // un asset empaquetado no está en disco: basta la ruta absoluta, sin stat
+        if (findPackedAsset(path))
+            return std::filesystem::absolute(path).lexically_normal().string();
+        std::error_code error;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+        return error ? path : canonical.string();
+    }
+
+    /// Toma una referencia desde un handle (sin el mutex tomado)
+    void retain(Entry* entry)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        addReference(entry);
+    }
+
+    /**
+     * @brief Suelta la referencia de un handle (sin el mutex tomado)
+     * @details No borra nada de GL: la textura solo pasa a la LRU y se expulsa en
+     *          el próximo update() o load(), así un handle se puede soltar en cualquier hilo.
+     */
+    void release(Entry* entry)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        releaseReference(entry);
+    }
+
+    void addReference(Entry* entry)
+    {
+        if (entry->references++ == 0 && entry->inLru)
+        {
+            lru.erase(entry->lruPosition);
+            entry->inLru = false;
+        }
+    }
+
+    void releaseReference(Entry* entry)
+    {
+        if (--entry->references == 0)
+        {
+            lru.push_front(entry);
+            entry->lruPosition = lru.begin();
+            entry->inLru = true;
+        }
+    }
+
+    /// Expulsa desde el extremo menos reciente de la LRU hasta cumplir el presupuesto
+    void enforceBudget()
+    {
+        while (resident > budget && !lru.empty())
+            evict(lru.back());
+    }
+
+    /**
+     * @brief Borra la textura y la saca de todas las listas (mutex tomado, hilo de render)
+     * @details Si una tarea la está decodificando, evicted hace que descarte el resultado.
+     */
+    void evict(Entry* entry)
+    {
+        lru.erase(entry->lruPosition);
+        entry->inLru = false;
+        entry->evicted = true;
+        if (entry->hashed)
+        {
+            auto byHashHit = byHash.find(entry->contentHash);
+            if (byHashHit != byHash.end() && byHashHit->second == entry)
+                byHash.erase(byHashHit);
+        }
+        resident -= entry->bytes;
+        entry->bytes = 0;
+        if (entry->id)
+            glDeleteTextures(1, &entry->id);
+        entry->id = 0;
+        stats.evictions++;
+
+        queued.erase(std::remove_if(queued.begin(), queued.end(), [entry](const DecodeJob& job) {
+            return job.entry.get() == entry;
+        }), queued.end());
+        streaming.erase(std::remove_if(streaming.begin(), streaming.end(), [entry](const std::shared_ptr<Entry>& other) {
+            return other.get() == entry;
+        }), streaming.end());
+        std::shared_ptr<Entry> original = entry->alias;
+        for (size_t i = 0; i < aliases.size(); i++)
+        {
+            if (aliases[i].duplicate.get() == entry)
+            {
+                original = aliases[i].original;
+                aliases.erase(aliases.begin() + i);
+                break;
+            }
+        }
+        // el duplicado retenía una referencia a la textura cuyo contenido compartía
+        if (original)
+            releaseReference(original.get());
+        // borrarla del mapa puede destruir el objeto: va al final
+        entries.erase(entry->path);
+    }
+
+    /**
+     * @brief Redirige los duplicados detectados a la textura original (mutex tomado)
+     */
+    void applyAliases()
+    {
+        for (PendingAlias& pending : aliases)
+        {
+            Entry& duplicate = *pending.duplicate;
+            duplicate.alias = pending.original;
+            glDeleteTextures(1, &duplicate.id);
+            duplicate.id = 0;
+            resident -= duplicate.bytes;
+            duplicate.bytes = 0;
+        }
+        aliases.clear();
+    }
+
+    /// Reserva de memoria de la textura tras allocate(): todos sus niveles
+    void accountAllocation(Entry& entry)
+    {
+        size_t bytes = 0;
+        for (const Entry::Level& level : entry.levels)
+            bytes += level.size;
+        std::lock_guard<std::mutex> lock(mutex);
+        resident += bytes;
+        resident -= entry.bytes;
+        entry.bytes = bytes;
+        stats.uploads++;
+    }
+
+    /// Hash del nivel 0 ya listo para subir, con las dimensiones y el formato como semilla
+    static uint64_t contentHash(const Entry& entry)
+    {
+        const Entry::Level& level = entry.levels[0];
+        unsigned int header[5] = { (unsigned int)entry.width, (unsigned int)entry.height,
+                                   (unsigned int)entry.channels, (unsigned int)entry.internalFormat,
+                                   (unsigned int)entry.levels.size() };
+        return hashContent64(level.data, level.size, fnv1a64(header, sizeof(header)));
+    }
+
+    /// Textura nueva con un tablero magenta y negro de 2x2: se nota a simple vista que falta
+    static unsigned int newPlaceholderTexture()
+    {
+        static const unsigned char checker[16] = { 255, 0, 255, 255, 0, 0, 0, 255, 0, 0, 0, 255, 255, 0, 255, 255 };
+        ScopedTextureBinding restore;
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, checker);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        return texture;
+    }
+
+    /**
+     * @brief Nivel más fino que vale la pena subir según el tamaño en pantalla
+     */
+    static int targetLevel(const Entry& entry)
+    {
+        float screen = entry.screenSize.load();
+        if (screen <= 0.0f)
+            return 0;
+        float ratio = (float)std::max(entry.width, entry.height) / screen;
+        int level = ratio > 1.0f ? (int)std::floor(std::log2(ratio)) : 0;
+        return std::min(level, (int)entry.levels.size() - 1);
+    }
+
+    /**
+     * @brief Redefine la textura con el tamaño real y todos sus niveles vacíos
+     * @details Solo se llama justo antes de subir el nivel más chico, en el mismo
+     *          update(): BASE_LEVEL queda en ese nivel y ningún nivel vacío se muestrea.
+     */
+    static void allocate(Entry& entry)
+    {
+        int count = (int)entry.levels.size();
+        glBindTexture(GL_TEXTURE_2D, entry.id);
+        GLenum format = pixelFormatForChannels(entry.channels);
+        for (int level = 0; level < count; level++)
+        {
+            const Entry::Level& mip = entry.levels[level];
+            if (entry.compressed)
+                glCompressedTexImage2D(GL_TEXTURE_2D, level, entry.internalFormat, mip.width, mip.height, 0, (GLsizei)mip.size, nullptr);
+            else
+                glTexImage2D(GL_TEXTURE_2D, level, entry.internalFormat, mip.width, mip.height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, count > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, count - 1);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, count - 1);
+        if (!entry.compressed)
+            setGreyscaleSwizzle(GL_TEXTURE_2D, entry.channels);
+        entry.finestLevel = count;
+        entry.allocated = true;
+    }
+
+    static void uploadLevel(Entry& entry, int level)
+    {
+        const Entry::Level& mip = entry.levels[level];
+        if (entry.compressed)
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, mip.width, mip.height, entry.internalFormat, (GLsizei)mip.size, mip.data);
+        else
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, mip.width, mip.height, pixelFormatForChannels(entry.channels), GL_UNSIGNED_BYTE, mip.data);
+    }
+
+    /**
+     * @brief Tarea del JobSystem: decodifica la textura en cola más grande en pantalla
+     */
+    void decodeNext()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (running && !queued.empty())
+        {
+            size_t best = 0;
+            for (size_t i = 1; i < queued.size(); i++)
+            {
+                if (queued[i].entry->screenSize.load() > queued[best].entry->screenSize.load())
+                    best = i;
+            }
+            DecodeJob job = queued[best];
+            queued.erase(queued.begin() + best);
+            busyDecoders++;
+            lock.unlock();
+
+            Entry& entry = *job.entry;
+            bool ok = std::filesystem::path(entry.path).extension() == ".ltex"
+                ? prepareCooked(entry)
+                : prepareImage(entry, job.compression, job.mipOptions);
+            uint64_t hash = ok ? contentHash(entry) : 0;
+
+            lock.lock();
+            busyDecoders--;
+            publish(job, ok, hash);
+        }
+        if (--outstandingTasks == 0)
+            tasksDone.notify_all();
+    }
+
+    /**
+     * @brief Deja la textura decodificada lista para update() (mutex tomado)
+     */
+    void publish(const DecodeJob& job, bool ok, uint64_t hash)
+    {
+        Entry& entry = *job.entry;
+        if (entry.evicted)
+            return;
+        if (!ok)
+        {
+            entry.state = TextureState::Failed;
+            stats.failures++;
+            return;
+        }
+        auto byHashHit = byHash.find(hash);
+        if (byHashHit != byHash.end())
+        {
+            // mismo contenido que otra textura: se comparte la suya y se libera la copia
+            stats.contentHits++;
+            Entry* original = byHashHit->second;
+            addReference(original);
+            aliases.push_back({ job.entry, entries[original->path] });
+            entry.levels.clear();
+            entry.storage.clear();
+            entry.cooked.reset();
+            return;
+        }
+        entry.contentHash = hash;
+        entry.hashed = true;
+        byHash[hash] = &entry;
+        entry.state = TextureState::Streaming;
+        streaming.push_back(job.entry);
+    }
+
+    /**
+     * @brief Decodifica, genera los mipmaps y, si corresponde, los comprime
+     * @details La imagen se decodifica directo en el nivel 0 de la cadena, que
+     *          pasa sin copias a storage. PNG y los JPEG grandes que se reparten
+     *          entre hilos no usan búfer intermedio; el resto de los JPEG pasa por
+     *          stb_image y la copia de filas.
+     */
+    static bool prepareImage(Entry& entry, TextureCompression compression, const MipOptions& options)
+    {
+        AssetFile file = openAsset(entry.path, MappedFileAccess::Sequential);
+        int width, height, channels;
+        if (!imageAssetInfo(file, &width, &height, &channels))
+        {
+            std::cout << "Failed to load texture: " << entry.path << std::endl;
+            return false;
+        }
+        // gris + alfa se expande a RGBA; el gris solo queda en R8 (ver allocate)
+        ImagePixelFormat pixelFormat = imagePixelFormatFor(channels, options.srgb);
+        channels = imagePixelFormatChannels(pixelFormat);
+        MipLevel base;
+        base.width = width;
+        base.height = height;
+        base.pixels.resize((size_t)width * height * channels);
+        ImageDecodeTarget target;
+        target.format = pixelFormat;
+        target.pixels = base.pixels.data();
+        target.width = width;
+        target.height = height;
+        if (!decodeImageAsset(file, target))
+        {
+            std::cout << "Failed to load texture: " << entry.path << std::endl;
+            return false;
+        }
+        file.reset();
+        // las banderas de extensiones de glad solo se leen: es seguro fuera del hilo GL
+        BlockFormat format = BlockFormat::BC1;
+        entry.compressed = chooseBlockFormat(compression, channels, options.srgb, format);
+        std::vector<MipLevel> chain = generateMipChain(std::move(base), channels, options);
+
+        entry.width = width;
+        entry.height = height;
+        entry.channels = channels;
+        entry.storage.resize(chain.size());
+        for (size_t level = 0; level < chain.size(); level++)
+        {
+            if (entry.compressed)
+                entry.storage[level] = compressImage(chain[level].pixels.data(), chain[level].width, chain[level].height, channels, format);
+            else
+                entry.storage[level] = std::move(chain[level].pixels);
+            entry.levels.push_back({ chain[level].width, chain[level].height, entry.storage[level].data(), entry.storage[level].size() });
+        }
+        if (entry.compressed)
+        {
+            entry.internalFormat = internalFormatForBlocks(format, options.srgb);
+        }
+        else
+        {
+            entry.internalFormat = internalFormatForPixelFormat(pixelFormat);
+        }
+        return true;
+    }
+
+    /// Proyecta un .ltex (en disco o en un pack): los niveles se suben directo desde el archivo
+    static bool prepareCooked(Entry& entry)
+    {
+        AssetFile file = openAsset(entry.path);
+        CookedTextureView cooked;
+        std::string error;
+        if (!file || !parseCookedTexture(file->data(), file->size(), cooked, error))
+        {
+            std::cout << "Failed to load texture: " << entry.path << " " << error << std::endl;
+            return false;
+        }
+        BlockFormat format;
+        entry.compressed = blockFormatForCooked(cooked.header.format, format);
+        if (entry.compressed && !blockFormatSupported(format, (cooked.header.flags & COOKED_FLAG_SRGB) != 0))
+        {
+            std::cout << "Failed to load texture: " << entry.path << " formato comprimido no soportado" << std::endl;
+            return false;
+        }
+        entry.width = (int)cooked.header.width;
+        entry.height = (int)cooked.header.height;
+        entry.channels = (int)cookedChannels(cooked.header.format);
+        entry.internalFormat = internalFormatForCooked(cooked.header);
+        for (const CookedLevelView& view : cooked.levels)
+        {
+            size_t size = (size_t)cookedLevelSize(cooked.header.format, view.width, view.height);
+            entry.levels.push_back({ (int)view.width, (int)view.height, view.data, size });
+        }
+        entry.cooked = file;
+        return !entry.levels.empty();
+    }
+};
+
+inline TextureHandle::TextureHandle(TextureCache* cache, Entry* entry) : cache(cache), entry(entry)
+{
+    // solo desde la caché, con su mutex tomado
+    if (entry)
+        cache->addReference(entry);
+}
+
+inline TextureHandle::TextureHandle(const TextureHandle& other) : cache(other.cache), entry(other.entry)
+{
+    if (entry)
+        cache->retain(entry);
+}
+
+inline TextureHandle::~TextureHandle()
+{
+    if (entry)
+        cache->release(entry);
+}
+
+inline unsigned int TextureHandle::id() const { return entry ? entry->resolved().id : 0; }
+inline int TextureHandle::width() const { return entry ? entry->resolved().width : 0; }
+inline int TextureHandle::height() const { return entry ? entry->resolved().height : 0; }
+inline int TextureHandle::channels() const { return entry ? entry->resolved().channels : 0; }
+inline TextureState TextureHandle::state() const { return entry ? entry->resolved().state.load() : TextureState::Failed; }
+inline int TextureHandle::residentLevel() const { return entry ? entry->finestLevel : 0; }
+inline int TextureHandle::levelCount() const { return entry ? (int)entry->levels.size() : 0; }
+
+#endif
@@ -0,0 +1,277 @@
+/**
+ * @file texture_container.h
+ * @brief Contenedor binario de texturas cocinadas (.ltex), al estilo KTX2
+ * @details Un encabezado fijo, una tabla de niveles y los niveles de mipmap
+ *          contiguos, cada uno alineado a 16 bytes y ya en el formato que espera
+ *          la GPU. En tiempo de ejecución el archivo se proyecta en memoria y cada
+ *          nivel se sube directamente, sin decodificar JPEG ni generar mipmaps.
+ *          Todos los campos son little-endian. No depende de GL: lo usan tanto la
+ *          herramienta de cocinado como el runtime.
+ */
+#ifndef TEXTURE_CONTAINER_H
+#define TEXTURE_CONTAINER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/// Identificador al inicio de todo archivo .ltex
+const char COOKED_TEXTURE_MAGIC[4] = { 'L', 'T', 'E', 'X' };
+/// Versión del formato; se incrementa ante cambios incompatibles
+const uint32_t COOKED_TEXTURE_VERSION = 1;
+/// Alineación de los datos de cada nivel
+const uint32_t COOKED_TEXTURE_ALIGNMENT = 16;
+
+/**
+ * @enum CookedFormat
+ * @brief Formato de los píxeles almacenados
+ */
+enum CookedFormat : uint32_t
+{
+    COOKED_FORMAT_R8 = 1,    ///< 1 byte por píxel
+    COOKED_FORMAT_RG8 = 2,   ///< 2 bytes por píxel
+    COOKED_FORMAT_RGB8 = 3,  ///< 3 bytes por píxel
+    COOKED_FORMAT_RGBA8 = 4, ///< 4 bytes por píxel
+    COOKED_FORMAT_BC1 = 16,  ///< Bloques BC1 de 8 bytes (RGB)
+    COOKED_FORMAT_BC3 = 17,  ///< Bloques BC3 de 16 bytes (RGBA)
+    COOKED_FORMAT_BC7 = 18   ///< Bloques BC7 de 16 bytes (RGBA)
+};
+
+/**
+ * @enum CookedFlags
+ * @brief Banderas del encabezado
+ */
+enum CookedFlags : uint32_t
+{
+    COOKED_FLAG_SRGB = 1u << 0 ///< Los colores están en espacio sRGB
+};
+
+/**
+ * @struct CookedTextureHeader
+ * @brief Encabezado fijo de 32 bytes
+ */
+struct CookedTextureHeader
+{
+    char magic[4];       ///< "LTEX"
+    uint32_t version;    ///< COOKED_TEXTURE_VERSION
+    uint32_t width;      ///< Ancho del nivel 0
+    uint32_t height;     ///< Alto del nivel 0
+    uint32_t format;     ///< CookedFormat
+    uint32_t flags;      ///< CookedFlags
+    uint32_t levelCount; ///< Niveles de mipmap almacenados
+    uint32_t reserved;   ///< Cero
+};
+static_assert(sizeof(CookedTextureHeader) == 32, "CookedTextureHeader debe medir 32 bytes");
+
+/**
+ * @struct CookedLevelEntry
+ * @brief Entrada de la tabla de niveles (sigue al encabezado)
+ */
+struct CookedLevelEntry
+{
+    uint64_t offset; ///< Offset de los datos desde el inicio del archivo
+    uint64_t size;   ///< Tamaño de los datos en bytes
+    uint32_t width;  ///< Ancho del nivel
+    uint32_t height; ///< Alto del nivel
+};
+static_assert(sizeof(CookedLevelEntry) == 24, "CookedLevelEntry debe medir 24 bytes");
+
+/**
+ * @brief Bytes por píxel de un formato sin comprimir (0 si no es de píxeles sueltos)
+ */
+inline uint32_t cookedBytesPerPixel(uint32_t format)
+{
+    switch (format)
+    {
+        case COOKED_FORMAT_R8: return 1;
+        case COOKED_FORMAT_RG8: return 2;
+        case COOKED_FORMAT_RGB8: return 3;
+        case COOKED_FORMAT_RGBA8: return 4;
+        default: return 0;
+    }
+}
+
+/**
+ * @brief Bytes por bloque de 4x4 de un formato comprimido (0 si no lo es)
+ */
+inline uint32_t cookedBytesPerBlock(uint32_t format)
+{
+    switch (format)
+    {
+        case COOKED_FORMAT_BC1: return 8;
+        case COOKED_FORMAT_BC3: return 16;
+        case COOKED_FORMAT_BC7: return 16;
+        default: return 0;
+    }
+}
+
+/**
+ * @brief Canales con que se muestrea la textura (0 si el formato es desconocido)
+ */
+inline uint32_t cookedChannels(uint32_t format)
+{
+    if (format == COOKED_FORMAT_BC1)
+        return 3;
+    if (format == COOKED_FORMAT_BC3 || format == COOKED_FORMAT_BC7)
+        return 4;
+    return cookedBytesPerPixel(format);
+}
+
+/**
+ * @brief Tamaño en bytes de un nivel en el formato indicado
+ */
+inline uint64_t cookedLevelSize(uint32_t format, uint32_t width, uint32_t height)
+{
+    if (cookedBytesPerBlock(format) != 0)
+        return (uint64_t)((width + 3) / 4) * ((height + 3) / 4) * cookedBytesPerBlock(format);
+    return (uint64_t)width * height * cookedBytesPerPixel(format);
+}
+
+/**
+ * @struct CookedLevelView
+ * @brief Nivel de una textura cocinada, apuntando dentro del archivo
+ */
+struct CookedLevelView
+{
+    const unsigned char* data;
+    size_t size;
+    uint32_t width;
+    uint32_t height;
+};
+
+/**
+ * @struct CookedTextureView
+ * @brief Textura cocinada validada; no es dueña de los datos
+ */
+struct CookedTextureView
+{
+    CookedTextureHeader header;
+    std::vector<CookedLevelView> levels;
+};
+
+/**
+ * @brief Valida un contenedor en memoria y obtiene vistas a sus niveles
+ * @param data Contenido completo del archivo (p.ej. proyectado con MappedFile)
+ * @param size Tamaño en bytes
+ * @param texture Resultado
+ * @param error Motivo del rechazo, si falla
+ * @return true si el contenedor es válido
+ */
+inline bool parseCookedTexture(const unsigned char* data, size_t size, CookedTextureView& texture, std::string& error)
+{
+    if (!data || size < sizeof(CookedTextureHeader))
+    {
+        error = "archivo demasiado pequeño";
+        return false;
+    }
+    memcpy(&texture.header, data, sizeof(CookedTextureHeader));
+    const CookedTextureHeader& header = texture.header;
+    if (memcmp(header.magic, COOKED_TEXTURE_MAGIC, 4) != 0)
+    {
+        error = "no es un archivo LTEX";
+        return false;
+    }
+    if (header.version != COOKED_TEXTURE_VERSION)
+    {
+        error = "versión de LTEX no soportada";
+        return false;
+    }
+    if (header.levelCount == 0 || header.levelCount > 32 || header.width == 0 || header.height == 0)
+    {
+        error = "encabezado inválido";
+        return false;
+    }
+    size_t tableEnd = sizeof(CookedTextureHeader) + (size_t)header.levelCount * sizeof(CookedLevelEntry);
+    if (tableEnd > size)
+    {
+        error = "tabla de niveles truncada";
+        return false;
+    }
+    texture.levels.clear();
+    for (uint32_t i = 0; i < header.levelCount; i++)
+    {
+        CookedLevelEntry entry;
+        memcpy(&entry, data + sizeof(CookedTextureHeader) + i * sizeof(CookedLevelEntry), sizeof(entry));
+        if (entry.offset > size || entry.size > size - entry.offset
+            || entry.size < cookedLevelSize(header.format, entry.width, entry.height))
+        {
+            error = "nivel fuera del archivo";
+            return false;
+        }
+        CookedLevelView level;
+        level.data = data + entry.offset;
+        level.size = (size_t)entry.size;
+        level.width = entry.width;
+        level.height = entry.height;
+        texture.levels.push_back(level);
+    }
+    return true;
+}
+
+/**
+ * @struct CookedLevelData
+ * @brief Nivel en memoria, para escribir un contenedor
+ */
+struct CookedLevelData
+{
+    uint32_t width;
+    uint32_t height;
+    std::vector<unsigned char> pixels;
+};
+
+/**
+ * @brief Escribe un contenedor .ltex
+ * @param path Ruta de salida
+ * @param format Formato de los niveles
+ * @param flags Banderas (COOKED_FLAG_SRGB, ...)
+ * @param levels Niveles del 0 (más grande) al último
+ * @return true si se escribió completo
+ */
+inline bool writeCookedTexture(const std::string& path, uint32_t format, uint32_t flags,
+                               const std::vector<CookedLevelData>& levels)
+{
+    if (levels.empty())
+        return false;
+    CookedTextureHeader header;
+    memcpy(header.magic, COOKED_TEXTURE_MAGIC, 4);
+    header.version = COOKED_TEXTURE_VERSION;
+    header.width = levels[0].width;
+    header.height = levels[0].height;
+    header.format = format;
+    header.flags = flags;
+    header.levelCount = (uint32_t)levels.size();
+    header.reserved = 0;
+
+    std::vector<CookedLevelEntry> table(levels.size());
+    uint64_t offset = sizeof(CookedTextureHeader) + levels.size() * sizeof(CookedLevelEntry);
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        offset = (offset + COOKED_TEXTURE_ALIGNMENT - 1) / COOKED_TEXTURE_ALIGNMENT * COOKED_TEXTURE_ALIGNMENT;
+        table[i].offset = offset;
+        table[i].size = levels[i].pixels.size();
+        table[i].width = levels[i].width;
+        table[i].height = levels[i].height;
+        offset += levels[i].pixels.size();
+    }
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && fwrite(table.data(), sizeof(CookedLevelEntry), table.size(), file) == table.size();
+    uint64_t written = sizeof(CookedTextureHeader) + table.size() * sizeof(CookedLevelEntry);
+    static const unsigned char padding[COOKED_TEXTURE_ALIGNMENT] = { 0 };
+    for (size_t i = 0; ok && i < levels.size(); i++)
+    {
+        ok = fwrite(padding, 1, (size_t)(table[i].offset - written), file) == table[i].offset - written;
+        ok = ok && (levels[i].pixels.empty()
+                    || fwrite(levels[i].pixels.data(), 1, levels[i].pixels.size(), file) == levels[i].pixels.size());
+        written = table[i].offset + levels[i].pixels.size();
+    }
+    ok = (fclose(file) == 0) && ok;
+    return ok;
+}
+
+#endif
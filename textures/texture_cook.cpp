@@ -0,0 +1,134 @@
+/**
+ * @file texture_cook.cpp
+ * @brief Herramienta offline que cocina imágenes a contenedores .ltex
+ * @details Decodifica la imagen con stb_image, genera la cadena completa de
+ *          mipmaps en CPU y escribe un .ltex listo para subir a la GPU. Con
+ *          --compress cada nivel se guarda comprimido por bloques (BC1/BC3/BC7).
+ *
+ *          Compilar:  g++ -std=c++17 -O2 -pthread texture_cook.cpp -o texture_cook
+ *          Usar:      ./texture_cook wall.jpg wall.ltex [--srgb] [--channels N] [--filter box|kaiser|lanczos]
+ *                     [--compress bc1|bc3|bc7]
+ */
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "image_memory.h" // STBI_MALLOC/STBI_FREE al pool; antes que stb_image.h
+#include "stb_image.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bc_encoder.h"
+#include "mipmap.h"
+#include "texture_container.h"
+
+using namespace std;
+
+/**
+ * @brief Imprime la forma de uso
+ */
+void printUsage(const char* program) {
+    cout << "Uso: " << program << " <entrada> <salida.ltex> [--srgb] [--channels N] [--filter F] [--compress C]" << endl;
+    cout << "  --srgb        marca la textura como sRGB (los mipmaps se filtran en lineal)" << endl;
+    cout << "  --channels N  fuerza 1-4 canales (por defecto, los de la imagen)" << endl;
+    cout << "  --filter F    box (por defecto), kaiser o lanczos" << endl;
+    cout << "  --compress C  bc1 (RGB), bc3 (RGBA) o bc7 (RGBA, mejor calidad)" << endl;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    string input = argv[1];
+    string output = argv[2];
+    uint32_t flags = 0;
+    int requestedChannels = 0;
+    MipOptions mipOptions;
+    bool compress = false;
+    BlockFormat blockFormat = BlockFormat::BC1;
+    uint32_t cookedFormat = 0;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--srgb") == 0) {
+            flags |= COOKED_FLAG_SRGB;
+        } else if (strcmp(argv[i], "--channels") == 0 && i + 1 < argc) {
+            requestedChannels = atoi(argv[++i]);
+            if (requestedChannels < 1 || requestedChannels > 4) {
+                cout << "--channels debe estar entre 1 y 4" << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            string filter = argv[++i];
+            if (filter == "box") {
+                mipOptions.filter = MipFilter::Box;
+            } else if (filter == "kaiser") {
+                mipOptions.filter = MipFilter::Kaiser;
+            } else if (filter == "lanczos") {
+                mipOptions.filter = MipFilter::Lanczos;
+            } else {
+                cout << "--filter debe ser box, kaiser o lanczos" << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--compress") == 0 && i + 1 < argc) {
+            string format = argv[++i];
+            compress = true;
+            if (format == "bc1") {
+                blockFormat = BlockFormat::BC1;
+                cookedFormat = COOKED_FORMAT_BC1;
+            } else if (format == "bc3") {
+                blockFormat = BlockFormat::BC3;
+                cookedFormat = COOKED_FORMAT_BC3;
+            } else if (format == "bc7") {
+                blockFormat = BlockFormat::BC7;
+                cookedFormat = COOKED_FORMAT_BC7;
+            } else {
+                cout << "--compress debe ser bc1, bc3 o bc7" << endl;
+                return 1;
+            }
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    int width, height, channels;
+    unsigned char* data = stbi_load(input.c_str(), &width, &height, &channels, requestedChannels);
+    if (!data) {
+        cout << "Failed to load texture: " << input << " (" << stbi_failure_reason() << ")" << endl;
+        return 1;
+    }
+    if (requestedChannels != 0) {
+        channels = requestedChannels;
+    }
+
+    mipOptions.srgb = (flags & COOKED_FLAG_SRGB) != 0;
+    vector<MipLevel> chain = generateMipChain(data, width, height, channels, mipOptions);
+    stbi_image_free(data);
+
+    vector<CookedLevelData> levels(chain.size());
+    size_t totalBytes = 0;
+    for (size_t i = 0; i < chain.size(); i++) {
+        levels[i].width = (uint32_t)chain[i].width;
+        levels[i].height = (uint32_t)chain[i].height;
+        if (compress) {
+            levels[i].pixels = compressImage(chain[i].pixels.data(), chain[i].width, chain[i].height, channels, blockFormat);
+        } else {
+            levels[i].pixels = std::move(chain[i].pixels);
+        }
+        totalBytes += levels[i].pixels.size();
+    }
+
+    // sin comprimir, CookedFormat coincide numéricamente con la cantidad de canales
+    if (!compress) {
+        cookedFormat = (uint32_t)channels;
+    }
+    if (!writeCookedTexture(output, cookedFormat, flags, levels)) {
+        cout << "No se pudo escribir " << output << endl;
+        return 1;
+    }
+    cout << input << " -> " << output << ": " << width << "x" << height << ", " << channels
+         << " canales, " << levels.size() << " niveles, " << totalBytes << " bytes" << endl;
+    return 0;
+}
@@ -0,0 +1,24 @@
+/**
+ * @file texture_source.h
+ * @brief Interfaz mínima para texturas cuyo ID GL puede cambiar en tiempo de ejecución
+ * @details Los materiales solo necesitan saber qué textura enlazar al dibujar; quien
+ *          carga o reemplaza la textura (la caché con streaming, por ejemplo)
+ *          implementa esta interfaz y los materiales no dependen de él.
+ */
+#ifndef TEXTURE_SOURCE_H
+#define TEXTURE_SOURCE_H
+
+/**
+ * @class TextureSource
+ * @brief Algo que sabe qué textura GL enlazar ahora
+ */
+class TextureSource
+{
+public:
+    virtual ~TextureSource() {}
+
+    /// ID de la textura GL a enlazar en este momento (0 si no hay ninguna)
+    virtual unsigned int textureId() const = 0;
+};
+
+#endif
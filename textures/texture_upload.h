@@ -0,0 +1,184 @@
+/**
+ * @file texture_upload.h
+ * @brief Formatos GL y ajustes para subir imágenes decodificadas a texturas
+ */
+#ifndef TEXTURE_UPLOAD_H
+#define TEXTURE_UPLOAD_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+#include "bc_encoder.h"
+#include "image_decoder.h"
+#include "mipmap.h"
+#include "texture_container.h"
+
+/**
+ * @brief Formato GL de los píxeles según la cantidad de canales
+ * @param channels 1 (gris), 2 (gris + alfa), 3 (RGB) o 4 (RGBA)
+ */
+inline GLenum pixelFormatForChannels(int channels)
+{
+    switch (channels)
+    {
+        case 1: return GL_RED;
+        case 2: return GL_RG;
+        case 4: return GL_RGBA;
+        default: return GL_RGB;
+    }
+}
+
+/**
+ * @brief Formato interno de 8 bits por canal según la cantidad de canales
+ */
+inline GLenum internalFormatForChannels(int channels)
+{
+    switch (channels)
+    {
+        case 1: return GL_R8;
+        case 2: return GL_RG8;
+        case 4: return GL_RGBA8;
+        default: return GL_RGB8;
+    }
+}
+
+/**
+ * @brief Hace que una textura de 1 o 2 canales se muestree como gris
+ * @details GL_R8 se lee (r,0,0,1) y GL_RG8 (r,g,0,1): el swizzle replica el gris
+ *          en RGB y, con 2 canales, lleva el segundo al alfa. Con 3-4 no hace nada.
+ */
+inline void setGreyscaleSwizzle(GLenum target, int channels)
+{
+    if (channels > 2)
+        return;
+    GLint swizzle[4] = { GL_RED, GL_RED, GL_RED, channels == 1 ? GL_ONE : GL_GREEN };
+    glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+}
+
+/**
+ * @brief Formato de decodificación para subir una imagen de N canales
+ * @details Gris + alfa se expande a RGBA: GL no tiene un formato de luminancia
+ *          y alfa en core. sRGB solo aplica a 3 y 4 canales.
+ */
+inline ImagePixelFormat imagePixelFormatFor(int channels, bool srgb)
+{
+    switch (channels)
+    {
+        case 1: return ImagePixelFormat::R8;
+        case 3: return srgb ? ImagePixelFormat::SRGB8 : ImagePixelFormat::RGB8;
+        default: return srgb ? ImagePixelFormat::SRGB8_ALPHA8 : ImagePixelFormat::RGBA8;
+    }
+}
+
+/// Formato interno GL de un formato de decodificación
+inline GLenum internalFormatForPixelFormat(ImagePixelFormat format)
+{
+    switch (format)
+    {
+        case ImagePixelFormat::SRGB8: return GL_SRGB8;
+        case ImagePixelFormat::SRGB8_ALPHA8: return GL_SRGB8_ALPHA8;
+        default: return internalFormatForChannels(imagePixelFormatChannels(format));
+    }
+}
+
+/**
+ * @brief Bytes que ocupa en GPU una textura con toda su cadena de mipmaps
+ * @details La cadena completa suma un tercio más que el nivel base.
+ */
+inline size_t textureMemoryBytes(int width, int height, int channels, bool mipmaps)
+{
+    size_t base = (size_t)width * (size_t)height * (size_t)channels;
+    return mipmaps ? base + base / 3 : base;
+}
+
+/**
+ * @enum TextureCompression
+ * @brief Compresión por bloques preferida al subir texturas
+ */
+enum class TextureCompression
+{
+    None,       ///< Sin comprimir
+    Fast,       ///< BC1 (RGB) / BC3 (RGBA): codificación rápida
+    HighQuality ///< BC7 si hay BPTC; si no, como Fast
+};
+
+/**
+ * @brief true si el contexto acepta texturas en ese formato de bloques
+ * @details BC1/BC3 necesitan EXT_texture_compression_s3tc (y EXT_texture_sRGB
+ *          para sus variantes sRGB); BC7 necesita ARB_texture_compression_bptc.
+ */
+inline bool blockFormatSupported(BlockFormat format, bool srgb)
+{
+    if (format == BlockFormat::BC7)
+        return GLAD_GL_ARB_texture_compression_bptc != 0;
+    return GLAD_GL_EXT_texture_compression_s3tc && (!srgb || GLAD_GL_EXT_texture_sRGB);
+}
+
+/**
+ * @brief Formato interno GL de un formato de bloques
+ */
+inline GLenum internalFormatForBlocks(BlockFormat format, bool srgb)
+{
+    switch (format)
+    {
+        case BlockFormat::BC1: return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case BlockFormat::BC3: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        default: return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB : GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+    }
+}
+
+/**
+ * @brief Elige el formato de bloques para una textura según lo que soporta el contexto
+ * @return false si hay que subirla sin comprimir
+ */
+inline bool chooseBlockFormat(TextureCompression compression, int channels, bool srgb, BlockFormat& format)
+{
+    if (compression == TextureCompression::None)
+        return false;
+    if (compression == TextureCompression::HighQuality && blockFormatSupported(BlockFormat::BC7, srgb))
+    {
+        format = BlockFormat::BC7;
+        return true;
+    }
+    // gris + alfa también necesita el alfa de BC3 (loadBlock lo lleva al canal 3)
+    format = channels == 4 || channels == 2 ? BlockFormat::BC3 : BlockFormat::BC1;
+    return blockFormatSupported(format, srgb);
+}
+
+/**
+ * @brief Formato de bloques de un formato cocinado comprimido
+ * @return false si el formato no es de bloques
+ */
+inline bool blockFormatForCooked(uint32_t cookedFormat, BlockFormat& format)
+{
+    switch (cookedFormat)
+    {
+        case COOKED_FORMAT_BC1: format = BlockFormat::BC1; return true;
+        case COOKED_FORMAT_BC3: format = BlockFormat::BC3; return true;
+        case COOKED_FORMAT_BC7: format = BlockFormat::BC7; return true;
+        default: return false;
+    }
+}
+
+/**
+ * @brief Formato interno para un contenedor cocinado (respeta la bandera sRGB)
+ */
+inline GLenum internalFormatForCooked(const CookedTextureHeader& header)
+{
+    bool srgb = (header.flags & COOKED_FLAG_SRGB) != 0;
+    BlockFormat blocks;
+    if (blockFormatForCooked(header.format, blocks))
+        return internalFormatForBlocks(blocks, srgb);
+    int channels = (int)cookedBytesPerPixel(header.format);
+    if (srgb)
+    {
+        if (channels == 3)
+            return GL_SRGB8;
+        if (channels == 4)
+            return GL_SRGB8_ALPHA8;
+    }
+    return internalFormatForChannels(channels);
+}
+
+#endif
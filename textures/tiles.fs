@@ -0,0 +1,13 @@
+#version 330 core
+out vec4 FragColor;
+
+#include "material_uniforms.glsl"
+
+in vec2 TextCoord;
+in float Layer;
+
+uniform sampler2DArray uTextures;
+
+void main() {
+    FragColor = texture(uTextures, vec3(TextCoord, Layer)) * uTint;
+}
@@ -0,0 +1,18 @@
+#version 330 core
+
+#include "frame_uniforms.glsl"
+#include "material_uniforms.glsl"
+
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in vec2 aTextCoord;
+layout (location = 3) in float aLayer; // capa del GL_TEXTURE_2D_ARRAY (ver setLayerAttribute)
+
+out vec2 TextCoord;
+out float Layer;
+
+void main()
+{
+    gl_Position = uProjection * uView * vec4(aPos, 1.0);
+    TextCoord = aTextCoord * uUvScaleOffset.xy + uUvScaleOffset.zw;
+    Layer = aLayer;
+}
@@ -0,0 +1,285 @@
+/**
+ * @file uniform_buffer.h
+ * @brief Uniform buffer objects para constantes por frame y por material
+ * @details Las constantes por frame (tiempo, resolución y vista/proyección) se
+ *          escriben una sola vez por frame en un UBO con anillo de varios frames
+ *          y se enlazan con glBindBufferRange; todos los programas las leen
+ *          desde el bloque FrameData (frame_uniforms.glsl) en lugar de
+ *          recibir un glUniform por programa. Los bloques por material viven en un
+ *          UBO compartido y se enlazan por rango en el punto MATERIAL_UNIFORM_BINDING.
+ */
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+/**
+ * @defgroup ubo Puntos de enlace de bloques uniformes
+ * @brief Deben coincidir con los bloques declarados en los .glsl comunes
+ * @{
+ */
+const unsigned int FRAME_UNIFORM_BINDING = 0;    ///< Bloque FrameData
+const unsigned int MATERIAL_UNIFORM_BINDING = 1; ///< Bloque MaterialData
+/** @} */
+
+/**
+ * @struct FrameUniforms
+ * @brief Espejo en C++ (layout std140) del bloque FrameData
+ * @details Los offsets siguen las reglas std140: mat4 ocupa 64 bytes, vec2 se
+ *          alinea a 8 y vec4 a 16. Ver frame_uniforms.glsl.
+ */
+struct FrameUniforms
+{
+    float view[16];        ///< mat4 uView        (offset 0)
+    float projection[16];  ///< mat4 uProjection  (offset 64)
+    float resolution[2];   ///< vec2 uResolution  (offset 128)
+    float time;            ///< float uTime       (offset 136)
+    float deltaTime;       ///< float uDeltaTime  (offset 140)
+};
+static_assert(offsetof(FrameUniforms, resolution) == 128, "FrameUniforms no respeta std140");
+static_assert(sizeof(FrameUniforms) == 144, "FrameUniforms no respeta std140");
+
+/**
+ * @struct MaterialUniforms
+ * @brief Espejo en C++ (layout std140) del bloque MaterialData
+ */
+struct MaterialUniforms
+{
+    float tint[4];          ///< vec4 uTint             (offset 0)
+    float uvScaleOffset[4]; ///< vec4 uUvScaleOffset    (offset 16): xy escala, zw desplazamiento
+};
+static_assert(sizeof(MaterialUniforms) == 32, "MaterialUniforms no respeta std140");
+
+/**
+ * @brief Escribe la matriz identidad (column-major) en m
+ */
+inline void setIdentity(float m[16])
+{
+    for (int i = 0; i < 16; i++)
+        m[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+}
+
+/**
+ * @brief Alineación mínima de offsets de glBindBufferRange para GL_UNIFORM_BUFFER
+ */
+inline size_t uniformBufferAlignment()
+{
+    int alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    return alignment > 0 ? static_cast<size_t>(alignment) : 256;
+}
+
+/// Redondea size hacia arriba al múltiplo de alignment
+inline size_t alignUp(size_t size, size_t alignment)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * @brief Enlaza los bloques comunes de un programa a sus puntos fijos
+ * @details Llamar una vez tras enlazar el programa; los bloques que el programa no
+ *          usa simplemente no se encuentran.
+ */
+inline void bindCommonUniformBlocks(unsigned int program)
+{
+    unsigned int frameBlock = glGetUniformBlockIndex(program, "FrameData");
+    if (frameBlock != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, frameBlock, FRAME_UNIFORM_BINDING);
+    unsigned int materialBlock = glGetUniformBlockIndex(program, "MaterialData");
+    if (materialBlock != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, materialBlock, MATERIAL_UNIFORM_BINDING);
+}
+
+/**
+ * @class FrameUniformBuffer
+ * @brief UBO en anillo para FrameUniforms
+ * @details Cada frame escribe en una ranura distinta, protegida con un fence, de
+ *          modo que la CPU nunca sobrescribe datos que la GPU aún está leyendo y no
+ *          hace falta sincronizar el driver al mapear.
+ */
+class FrameUniformBuffer
+{
+public:
+    static const unsigned int FRAMES_IN_FLIGHT = 3;
+
+    FrameUniformBuffer() : buffer(0), slotSize(0), slot(0)
+    {
+        for (unsigned int i = 0; i < FRAMES_IN_FLIGHT; i++)
+            fences[i] = 0;
+        slotSize = alignUp(sizeof(FrameUniforms), uniformBufferAlignment());
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferData(GL_UNIFORM_BUFFER, slotSize * FRAMES_IN_FLIGHT, NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    ~FrameUniformBuffer()
+    {
+        for (unsigned int i = 0; i < FRAMES_IN_FLIGHT; i++)
+        {
+            if (fences[i])
+                glDeleteSync(fences[i]);
+        }
+        glDeleteBuffers(1, &buffer);
+    }
+
+    FrameUniformBuffer(const FrameUniformBuffer&) = delete;
+    FrameUniformBuffer& operator=(const FrameUniformBuffer&) = delete;
+
+    /**
+     * @brief Escribe las constantes del frame y las enlaza en FRAME_UNIFORM_BINDING
+     * @details Llamar una vez por frame, antes de dibujar.
+     */
+    void update(const FrameUniforms& uniforms)
+    {
+        slot = (slot + 1) % FRAMES_IN_FLIGHT;
+        waitForSlot(slot);
+
+        GLintptr offset = static_cast<GLintptr>(slot * slotSize);
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        void* mapped = glMapBufferRange(GL_UNIFORM_BUFFER, offset, sizeof(FrameUniforms),
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (mapped)
+        {
+            memcpy(mapped, &uniforms, sizeof(FrameUniforms));
+            glUnmapBuffer(GL_UNIFORM_BUFFER);
+        }
+        else
+        {
+            glBufferSubData(GL_UNIFORM_BUFFER, offset, sizeof(FrameUniforms), &uniforms);
+        }
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, buffer, offset, sizeof(FrameUniforms));
+    }
+
+    /**
+     * @brief Marca el fin del uso de la ranura actual; llamar tras el último draw del frame
+     */
+    void endFrame()
+    {
+        if (fences[slot])
+            glDeleteSync(fences[slot]);
+        fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+private:
+    unsigned int buffer;
+    size_t slotSize;
+    unsigned int slot;
+    GLsync fences[FRAMES_IN_FLIGHT];
+
+    void waitForSlot(unsigned int index)
+    {
+        if (!fences[index])
+            return;
+        // normalmente ya se señalizó hace dos frames, así que no hay espera real
+        GLenum result = glClientWaitSync(fences[index], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+        if (result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED)
+            std::cout << "ERROR::UBO::FENCE_NO_SEÑALIZADO" << std::endl;
+        glDeleteSync(fences[index]);
+        fences[index] = 0;
+    }
+};
+
+/**
+ * @struct MaterialBlock
+ * @brief Rango de un bloque de material dentro del MaterialUniformBuffer
+ */
+struct MaterialBlock
+{
+    size_t offset = 0; ///< Offset en bytes (alineado)
+    size_t size = 0;   ///< Tamaño del bloque en bytes
+};
+
+/**
+ * @class MaterialUniformBuffer
+ * @brief UBO compartido con los bloques de todos los materiales
+ * @details Cada material reserva un rango alineado una sola vez; dibujar con él
+ *          solo requiere un glBindBufferRange, sin reenviar los datos.
+ */
+class MaterialUniformBuffer
+{
+public:
+    explicit MaterialUniformBuffer(size_t initialCapacity = 64 * 1024)
+        : buffer(0), capacity(initialCapacity), used(0), alignment(uniformBufferAlignment())
+    {
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferData(GL_UNIFORM_BUFFER, capacity, NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    ~MaterialUniformBuffer()
+    {
+        glDeleteBuffers(1, &buffer);
+    }
+
+    MaterialUniformBuffer(const MaterialUniformBuffer&) = delete;
+    MaterialUniformBuffer& operator=(const MaterialUniformBuffer&) = delete;
+
+    /**
+     * @brief Reserva y escribe un bloque de material
+     * @param data Datos en layout std140
+     * @param size Tamaño en bytes
+     */
+    MaterialBlock allocate(const void* data, size_t size)
+    {
+        MaterialBlock block;
+        block.offset = alignUp(used, alignment);
+        block.size = size;
+        if (block.offset + size > capacity)
+            grow(block.offset + size);
+        used = block.offset + size;
+        write(block, data);
+        return block;
+    }
+
+    /// Reescribe el contenido de un bloque ya reservado
+    void write(const MaterialBlock& block, const void* data)
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, static_cast<GLintptr>(block.offset), block.size, data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    /// Enlaza el bloque en MATERIAL_UNIFORM_BINDING
+    void bind(const MaterialBlock& block) const
+    {
+        glBindBufferRange(GL_UNIFORM_BUFFER, MATERIAL_UNIFORM_BINDING, buffer,
+                          static_cast<GLintptr>(block.offset), block.size);
+    }
+
+    /// ID del buffer GL (para enlazar rangos a mano)
+    unsigned int id() const { return buffer; }
+
+private:
+    unsigned int buffer;
+    size_t capacity;
+    size_t used;
+    size_t alignment;
+
+    /// Duplica la capacidad copiando en GPU los bloques ya escritos
+    void grow(size_t required)
+    {
+        size_t newCapacity = capacity * 2;
+        while (newCapacity < required)
+            newCapacity *= 2;
+        unsigned int newBuffer;
+        glGenBuffers(1, &newBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, newCapacity, NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glDeleteBuffers(1, &buffer);
+        buffer = newBuffer;
+        capacity = newCapacity;
+    }
+};
+
+#endif
@@ -0,0 +1,49 @@
+// Muestreo de una textura virtual (ver virtual_texture.h).
+// Uniforms que fija VirtualTexture::bind:
+//   uVtIndirection  una entrada por página y nivel: xy = casilla en la caché,
+//                   z = nivel de la página cargada (puede ser un ancestro)
+//   uVtCache        caché física de páginas con borde
+//   uVtParams       xy = imagen / extensión virtual, z = páginas por lado en el
+//                   nivel 0, w = último nivel
+//   uVtCacheParams  x = lado de página, y = borde, z = lado de la caché en píxeles,
+//                   w = sesgo de nivel del pase de feedback
+uniform sampler2D uVtIndirection;
+uniform sampler2D uVtCache;
+uniform vec4 uVtParams;
+uniform vec4 uVtCacheParams;
+
+vec2 vtVirtualUv(vec2 uv)
+{
+    return clamp(uv, 0.0, 1.0) * uVtParams.xy;
+}
+
+// Nivel de detalle a partir de cuánto cambia la coordenada en texels por píxel
+float vtLevel(vec2 vuv, float bias)
+{
+    vec2 texel = vuv * uVtParams.z * uVtCacheParams.x;
+    vec2 dx = dFdx(texel);
+    vec2 dy = dFdy(texel);
+    float level = 0.5 * log2(max(dot(dx, dx), dot(dy, dy))) + bias;
+    return clamp(level, 0.0, uVtParams.w);
+}
+
+vec4 vtSample(vec2 uv)
+{
+    vec2 vuv = vtVirtualUv(uv);
+    float level = floor(vtLevel(vuv, 0.0));
+    vec3 entry = floor(textureLod(uVtIndirection, vuv, level).xyz * 255.0 + 0.5);
+    float pages = uVtParams.z * exp2(-entry.z);
+    vec2 local = fract(min(vuv, 0.99999) * pages);
+    float slotSize = uVtCacheParams.x + 2.0 * uVtCacheParams.y;
+    vec2 texel = entry.xy * slotSize + uVtCacheParams.y + local * uVtCacheParams.x;
+    return textureLod(uVtCache, texel / uVtCacheParams.z, 0.0);
+}
+
+// Salida del pase de feedback (color GL_RGBA16UI): página y nivel que pide este píxel
+uvec4 vtFeedback(vec2 uv)
+{
+    vec2 vuv = vtVirtualUv(uv);
+    float level = floor(vtLevel(vuv, uVtCacheParams.w));
+    vec2 page = floor(min(vuv, 0.99999) * uVtParams.z * exp2(-level));
+    return uvec4(uvec2(page), uint(level), 1u);
+}
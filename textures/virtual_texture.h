@@ -0,0 +1,1100 @@
+/**
+ * @file virtual_texture.h
+ * @brief Texturas virtuales: imágenes más grandes que GL_MAX_TEXTURE_SIZE
+ * @details La imagen se divide en páginas cuadradas por nivel de mipmap. Solo las
+ *          páginas visibles viven en la GPU, dentro de una caché física (una
+ *          textura 2D con casillas de página + borde); una textura de indirección,
+ *          con un texel por página y por nivel, dice en qué casilla está cada una
+ *          o, si aún no llegó, la de su ancestro más cercano ya cargado. Un pase de
+ *          feedback a baja resolución escribe qué página y nivel pide cada píxel
+ *          (virtual_texture.glsl, vtFeedback); se lee sin bloquear con un PBO un
+ *          frame después, las páginas que faltan se leen de la fuente en un hilo
+ *          aparte y las casillas se reciclan por LRU. Todo con GL 3.3 core:
+ *          texturas enteras, FBO, PBO y textureLod.
+ *
+ *          La extensión virtual se redondea a páginas * 2^n por lado, así que cada
+ *          nivel tiene exactamente la mitad de páginas que el anterior; la imagen
+ *          ocupa la esquina superior izquierda y uVtParams.xy lleva las
+ *          coordenadas de la imagen a esa extensión.
+ */
+#ifndef VIRTUAL_TEXTURE_H
+#define VIRTUAL_TEXTURE_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "stb_image.h"
+#include "asset_io.h"
+#include "mipmap.h"
+
+/**
+ * @class VirtualTextureSource
+ * @brief Origen de las páginas de una textura virtual, en RGBA8
+ * @details readPage se llama desde el hilo de carga: debe ser seguro en paralelo.
+ */
+class VirtualTextureSource
+{
+public:
+    virtual ~VirtualTextureSource() {}
+    virtual int width() const = 0;
+    virtual int height() const = 0;
+
+    /**
+     * @brief Lee una página con su borde
+     * @param level Nivel de mipmap
+     * @param pageX Columna de la página en ese nivel
+     * @param pageY Fila de la página en ese nivel
+     * @param pageSize Lado de la página sin borde
+     * @param border Píxeles de borde por lado (copiados de las páginas vecinas)
+     * @param rgba Destino de (pageSize + 2 * border)^2 píxeles RGBA
+     * @return false si la página no se pudo leer
+     */
+    virtual bool readPage(int level, int pageX, int pageY, int pageSize, int border, unsigned char* rgba) const = 0;
+};
+
+/**
+ * @class ImageVirtualSource
+ * @brief Fuente en memoria: la imagen completa y su cadena de mipmaps
+ * @details Solo para imágenes que stb_image decodifica enteras: ancho * alto * 4
+ *          debe caber en un int (unos 536 Mpx; en PNG, 2^30 bytes), y load()
+ *          rechaza las demás con IMAGE_TOO_LARGE. Las
+ *          más grandes se cortan offline con vtex_build desde un PPM binario, que
+ *          se lee por bandas de filas (writeVirtualTilesFromRows), y se leen con
+ *          TileAssetSource.
+ */
+class ImageVirtualSource : public VirtualTextureSource
+{
+public:
+    ImageVirtualSource(const unsigned char* rgba, int width, int height, const MipOptions& options = MipOptions())
+        : chain(generateMipChain(rgba, width, height, 4, options))
+    {
+    }
+
+    /// Decodifica una imagen (de disco o de un pack montado); nullptr si falla
+    static std::shared_ptr<ImageVirtualSource> load(const std::string& path, const MipOptions& options = MipOptions())
+    {
+        int width, height, channels;
+        if (!fitsInMemoryDecode(path))
+            return nullptr;
+        unsigned char* data = loadImageAsset(path, &width, &height, &channels, 4);
+        if (!data)
+        {
+            std::cout << "Failed to load texture: " << path << std::endl;
+            return nullptr;
+        }
+        std::shared_ptr<ImageVirtualSource> source = std::make_shared<ImageVirtualSource>(data, width, height, options);
+        stbi_image_free(data);
+        return source;
+    }
+
+    /**
+     * @brief true si la imagen se puede decodificar entera en RGBA8
+     * @details Lee solo la cabecera. Si es demasiado grande informa el error y
+     *          sugiere el camino por bandas.
+     */
+    static bool fitsInMemoryDecode(const std::string& path)
+    {
+        AssetFile file = openAsset(path);
+        int width = 0, height = 0, channels;
+        bool known = imageAssetInfo(file, &width, &height, &channels);
+        long long pixels = (long long)width * height;
+        bool tooLarge = pixels * 4 > INT_MAX;
+        // stb_image ya rechaza la cabecera de un PNG de más de 2^30 bytes: se leen las medidas del IHDR
+        static const unsigned char pngSignature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+        if (!known && file && file->size() >= 26 && memcmp(file->data(), pngSignature, 8) == 0)
+        {
+            const unsigned char* ihdr = file->data() + 16;
+            long long pngWidth = ((long long)ihdr[0] << 24) | (ihdr[1] << 16) | (ihdr[2] << 8) | ihdr[3];
+            long long pngHeight = ((long long)ihdr[4] << 24) | (ihdr[5] << 16) | (ihdr[6] << 8) | ihdr[7];
+            static const int colorChannels[7] = { 1, 0, 3, 1, 2, 0, 4 };
+            int pngChannels = ihdr[9] < 7 ? colorChannels[ihdr[9]] : 0;
+            pixels = pngWidth * pngHeight;
+            tooLarge = pngChannels > 0 && pixels * pngChannels > (1 << 30);
+        }
+        if (tooLarge)
+        {
+            std::cout << "ERROR::VIRTUAL_TEXTURE::IMAGE_TOO_LARGE\n" << path << " (" << pixels / 1000000
+                      << " Mpx): stb_image no la decodifica entera en RGBA;"
+                      << " convertirla a PPM binario y cortarla con vtex_build" << std::endl;
+            return false;
+        }
+        if (!known)
+            std::cout << "Failed to load texture: " << path << std::endl;
+        return known;
+    }
+
+    int width() const override { return chain[0].width; }
+    int height() const override { return chain[0].height; }
+
+    bool readPage(int level, int pageX, int pageY, int pageSize, int border, unsigned char* rgba) const override
+    {
+        const MipLevel& mip = chain[std::min<size_t>(level, chain.size() - 1)];
+        int side = pageSize + 2 * border;
+        int originX = pageX * pageSize - border;
+        int originY = pageY * pageSize - border;
+        for (int y = 0; y < side; y++)
+        {
+            int sourceY = std::min(std::max(originY + y, 0), mip.height - 1);
+            const unsigned char* row = mip.pixels.data() + (size_t)sourceY * mip.width * 4;
+            for (int x = 0; x < side; x++)
+            {
+                int sourceX = std::min(std::max(originX + x, 0), mip.width - 1);
+                memcpy(rgba + ((size_t)y * side + x) * 4, row + (size_t)sourceX * 4, 4);
+            }
+        }
+        return true;
+    }
+
+private:
+    std::vector<MipLevel> chain;
+};
+
+/**
+ * @brief Ruta de una página cortada offline: prefix/nivel/x_y.tile
+ */
+inline std::string virtualTilePath(const std::string& prefix, int level, int pageX, int pageY)
+{
+    return prefix + "/" + std::to_string(level) + "/" + std::to_string(pageX) + "_" + std::to_string(pageY) + ".tile";
+}
+
+/**
+ * @class TileAssetSource
+ * @brief Fuente de páginas ya cortadas (ver writeVirtualTiles)
+ * @details Cada página es un archivo RGBA8 crudo con borde; se abren con openAsset,
+ *          así que pueden venir de un .lpak montado (proyectado y, si se empaquetó
+ *          con --lz4, comprimido). prefix/info guarda "LVTX ancho alto página borde".
+ */
+class TileAssetSource : public VirtualTextureSource
+{
+public:
+    explicit TileAssetSource(const std::string& prefix) : prefix(prefix)
+    {
+        AssetFile info = openAsset(prefix + "/info");
+        std::string text = info ? std::string((const char*)info->data(), info->size()) : std::string();
+        if (sscanf(text.c_str(), "LVTX %d %d %d %d", &imageWidth, &imageHeight, &tilePage, &tileBorder) != 4)
+        {
+            std::cout << "ERROR::VIRTUAL_TEXTURE::INFO_NOT_FOUND\n" << prefix << "/info" << std::endl;
+            imageWidth = imageHeight = 0;
+        }
+    }
+
+    bool valid() const { return imageWidth > 0 && imageHeight > 0; }
+    int width() const override { return imageWidth; }
+    int height() const override { return imageHeight; }
+    int pageSize() const { return tilePage; }
+    int border() const { return tileBorder; }
+
+    bool readPage(int level, int pageX, int pageY, int pageSize, int border, unsigned char* rgba) const override
+    {
+        if (pageSize != tilePage || border != tileBorder)
+            return false;
+        AssetFile tile = openAsset(virtualTilePath(prefix, level, pageX, pageY));
+        size_t bytes = (size_t)(pageSize + 2 * border) * (pageSize + 2 * border) * 4;
+        if (!tile || tile->size() != bytes)
+            return false;
+        memcpy(rgba, tile->data(), bytes);
+        return true;
+    }
+
+private:
+    std::string prefix;
+    int imageWidth = 0;
+    int imageHeight = 0;
+    int tilePage = 0;
+    int tileBorder = 0;
+};
+
+/**
+ * @brief Páginas por lado del nivel 0 (potencia de 2) para cubrir la imagen
+ */
+inline int virtualPagesPerSide(int width, int height, int pageSize)
+{
+    int pages = 1;
+    while ((long long)pages * pageSize < std::max(width, height))
+        pages *= 2;
+    return pages;
+}
+
+/**
+ * @brief Corta una fuente en páginas de todos los niveles para TileAssetSource
+ * @return Páginas escritas, o -1 si falló una escritura
+ * @details Las páginas que quedan completamente fuera de la imagen no se escriben:
+ *          nunca se piden.
+ */
+inline long long writeVirtualTiles(const VirtualTextureSource& source, const std::string& prefix, int pageSize, int border)
+{
+    std::error_code error;
+    std::filesystem::create_directories(prefix, error);
+    FILE* info = fopen((prefix + "/info").c_str(), "wb");
+    if (!info)
+        return -1;
+    fprintf(info, "LVTX %d %d %d %d\n", source.width(), source.height(), pageSize, border);
+    fclose(info);
+
+    int side = pageSize + 2 * border;
+    std::vector<unsigned char> page((size_t)side * side * 4);
+    long long written = 0;
+    int pages = virtualPagesPerSide(source.width(), source.height(), pageSize);
+    for (int level = 0; (pages >> level) >= 1; level++)
+    {
+        std::filesystem::create_directories(prefix + "/" + std::to_string(level), error);
+        // redondeo hacia arriba: el shader puede pedir la página del último píxel parcial
+        int levelWidth = (source.width() + (1 << level) - 1) >> level;
+        int levelHeight = (source.height() + (1 << level) - 1) >> level;
+        for (int y = 0; y * pageSize < levelHeight; y++)
+        {
+            for (int x = 0; x * pageSize < levelWidth; x++)
+            {
+                if (!source.readPage(level, x, y, pageSize, border, page.data()))
+                    return -1;
+                FILE* file = fopen(virtualTilePath(prefix, level, x, y).c_str(), "wb");
+                bool ok = file && fwrite(page.data(), 1, page.size(), file) == page.size();
+                ok = file && fclose(file) == 0 && ok;
+                if (!ok)
+                    return -1;
+                written++;
+            }
+        }
+    }
+    return written;
+}
+
+/**
+ * @class VirtualRowSource
+ * @brief Imagen RGBA8 que se lee de arriba hacia abajo, de a tandas de filas
+ * @details Para cortar imágenes que no caben enteras en memoria (ver
+ *          writeVirtualTilesFromRows).
+ */
+class VirtualRowSource
+{
+public:
+    virtual ~VirtualRowSource() {}
+    virtual int width() const = 0;
+    virtual int height() const = 0;
+
+    /**
+     * @brief Lee las siguientes count filas
+     * @param rgba Destino de count * width() píxeles RGBA
+     * @return false si no se pudieron leer
+     */
+    virtual bool readRows(int count, unsigned char* rgba) = 0;
+};
+
+/**
+ * @class PpmRowSource
+ * @brief PPM (P6) o PGM (P5) binario de 8 bits, leído por filas desde disco
+ * @details Sin límite de tamaño: solo se lee la cabecera al abrirlo y después
+ *          las filas que se piden. Lo escriben sin cargar la imagen entera
+ *          herramientas como vips o ImageMagick (-limit).
+ */
+class PpmRowSource : public VirtualRowSource
+{
+public:
+    explicit PpmRowSource(const std::string& path) : file(fopen(path.c_str(), "rb"))
+    {
+        if (!file || !readHeader())
+        {
+            std::cout << "ERROR::VIRTUAL_TEXTURE::PPM_NOT_SUPPORTED\n" << path
+                      << " (se esperaba P6 o P5 binario con valor máximo 255)" << std::endl;
+            imageWidth = imageHeight = 0;
+        }
+    }
+
+    ~PpmRowSource()
+    {
+        if (file)
+            fclose(file);
+    }
+
+    PpmRowSource(const PpmRowSource&) = delete;
+    PpmRowSource& operator=(const PpmRowSource&) = delete;
+
+    /// true si el archivo tiene extensión .ppm o .pgm
+    static bool handles(const std::string& path)
+    {
+        std::string extension = std::filesystem::path(path).extension().string();
+        return extension == ".ppm" || extension == ".pgm";
+    }
+
+    bool valid() const { return imageWidth > 0 && imageHeight > 0; }
+    int width() const override { return imageWidth; }
+    int height() const override { return imageHeight; }
+
+    bool readRows(int count, unsigned char* rgba) override
+    {
+        size_t pixels = (size_t)count * imageWidth;
+        row.resize(pixels * channels);
+        if (!valid() || fread(row.data(), 1, row.size(), file) != row.size())
+            return false;
+        for (size_t i = 0; i < pixels; i++)
+        {
+            const unsigned char* source = row.data() + i * channels;
+            rgba[i * 4 + 0] = source[0];
+            rgba[i * 4 + 1] = source[channels == 3 ? 1 : 0];
+            rgba[i * 4 + 2] = source[channels == 3 ? 2 : 0];
+            rgba[i * 4 + 3] = 255;
+        }
+        return true;
+    }
+
+private:
+    FILE* file;
+    int imageWidth = 0;
+    int imageHeight = 0;
+    int channels = 3;
+    std::vector<unsigned char> row;
+
+    /// Siguiente número de la cabecera, saltando espacios y comentarios
+    bool readHeaderNumber(long long& value)
+    {
+        int c = fgetc(file);
+        while (c == '#' || isspace(c))
+        {
+            if (c == '#')
+            {
+                while (c != '\n' && c != EOF)
+                    c = fgetc(file);
+            }
+            c = fgetc(file);
+        }
+        if (!isdigit(c))
+            return false;
+        value = 0;
+        while (isdigit(c) && value < INT_MAX)
+        {
+            value = value * 10 + (c - '0');
+            c = fgetc(file);
+        }
+        // un único espacio separa la cabecera de los píxeles
+        return isspace(c);
+    }
+
+    bool readHeader()
+    {
+        char magic[2];
+        if (fread(magic, 1, 2, file) != 2 || magic[0] != 'P' || (magic[1] != '6' && magic[1] != '5'))
+            return false;
+        channels = magic[1] == '6' ? 3 : 1;
+        long long w, h, maxValue;
+        if (!readHeaderNumber(w) || !readHeaderNumber(h) || !readHeaderNumber(maxValue))
+            return false;
+        if (w <= 0 || h <= 0 || w >= INT_MAX || h >= INT_MAX || maxValue != 255)
+            return false;
+        imageWidth = (int)w;
+        imageHeight = (int)h;
+        return true;
+    }
+};
+
+/**
+ * @class ImageRowSource
+ * @brief Filas de una imagen ya decodificada en memoria (RGBA8)
+ */
+class ImageRowSource : public VirtualRowSource
+{
+public:
+    ImageRowSource(const unsigned char* rgba, int width, int height)
+        : pixels(rgba), imageWidth(width), imageHeight(height), nextRow(0)
+    {
+    }
+
+    int width() const override { return imageWidth; }
+    int height() const override { return imageHeight; }
+
+    bool readRows(int count, unsigned char* rgba) override
+    {
+        if (nextRow + count > imageHeight)
+            return false;
+        size_t bytes = (size_t)count * imageWidth * 4;
+        memcpy(rgba, pixels + (size_t)nextRow * imageWidth * 4, bytes);
+        nextRow += count;
+        return true;
+    }
+
+private:
+    const unsigned char* pixels;
+    int imageWidth;
+    int imageHeight;
+    int nextRow;
+};
+
+/**
+ * @brief Corta una imagen en páginas leyéndola por bandas de filas
+ * @details Escribe lo mismo que writeVirtualTiles con un ImageVirtualSource de
+ *          filtro caja, pero sin tener nunca la imagen ni sus mipmaps enteros en
+ *          memoria: cada nivel guarda solo las filas que todavía necesitan su
+ *          próxima fila de páginas (con borde) o el nivel siguiente, y cada par
+ *          de filas que llega se reduce con downsampleBoxRows a una fila del nivel
+ *          de abajo. La memoria es del orden de ancho * (página + 2 * borde) * 4
+ *          bytes por nivel, así que el límite lo pone el disco, no la RAM.
+ * @return Páginas escritas, o -1 si falló una lectura o una escritura
+ */
+inline long long writeVirtualTilesFromRows(VirtualRowSource& source, const std::string& prefix, int pageSize, int border)
+{
+    /**
+     * @struct Band
+     * @brief Filas retenidas de un nivel: [firstRow, firstRow + rows.size() / stride)
+     */
+    struct Band
+    {
+        int width;       ///< Ancho del nivel, como en generateMipChain
+        int height;
+        int pageColumns; ///< Páginas por fila, redondeando hacia arriba como writeVirtualTiles
+        int pageRows;
+        int firstRow = 0;
+        int nextPageRow = 0;
+        int nextChildRow = 0;
+        std::vector<unsigned char> rows;
+
+        size_t stride() const { return (size_t)width * 4; }
+        int available() const { return firstRow + (int)(rows.size() / stride()); }
+        const unsigned char* rowAt(int y) const { return rows.data() + (size_t)(y - firstRow) * stride(); }
+    };
+
+    std::error_code error;
+    std::filesystem::create_directories(prefix, error);
+    FILE* info = fopen((prefix + "/info").c_str(), "wb");
+    if (!info)
+        return -1;
+    fprintf(info, "LVTX %d %d %d %d\n", source.width(), source.height(), pageSize, border);
+    fclose(info);
+
+    int pages = virtualPagesPerSide(source.width(), source.height(), pageSize);
+    // los mismos niveles que writeVirtualTiles; nunca más que la cadena de mipmaps
+    int levelCount = 1;
+    while ((pages >> levelCount) >= 1)
+        levelCount++;
+    levelCount = std::min(levelCount, mipLevelCount(source.width(), source.height()));
+    std::vector<Band> bands(levelCount);
+    for (int level = 0; level < levelCount; level++)
+    {
+        Band& band = bands[level];
+        band.width = level == 0 ? source.width() : std::max(1, bands[level - 1].width / 2);
+        band.height = level == 0 ? source.height() : std::max(1, bands[level - 1].height / 2);
+        int levelWidth = (source.width() + (1 << level) - 1) >> level;
+        int levelHeight = (source.height() + (1 << level) - 1) >> level;
+        band.pageColumns = (levelWidth + pageSize - 1) / pageSize;
+        band.pageRows = (levelHeight + pageSize - 1) / pageSize;
+        std::filesystem::create_directories(prefix + "/" + std::to_string(level), error);
+    }
+
+    int side = pageSize + 2 * border;
+    std::vector<unsigned char> page((size_t)side * side * 4);
+    long long written = 0;
+    bool failed = false;
+
+    // escribe las filas de páginas de un nivel cuyas filas (con borde) ya llegaron
+    auto writePages = [&](int level) {
+        Band& band = bands[level];
+        while (!failed && band.nextPageRow < band.pageRows)
+        {
+            int originY = band.nextPageRow * pageSize - border;
+            if (band.available() < std::min(originY + side, band.height))
+                break;
+            for (int pageX = 0; pageX < band.pageColumns && !failed; pageX++)
+            {
+                int originX = pageX * pageSize - border;
+                for (int y = 0; y < side; y++)
+                {
+                    const unsigned char* row = band.rowAt(std::min(std::max(originY + y, 0), band.height - 1));
+                    for (int x = 0; x < side; x++)
+                    {
+                        int sourceX = std::min(std::max(originX + x, 0), band.width - 1);
+                        memcpy(page.data() + ((size_t)y * side + x) * 4, row + (size_t)sourceX * 4, 4);
+                    }
+                }
+                FILE* file = fopen(virtualTilePath(prefix, level, pageX, band.nextPageRow).c_str(), "wb");
+                bool ok = file && fwrite(page.data(), 1, page.size(), file) == page.size();
+                ok = file && fclose(file) == 0 && ok;
+                failed = !ok;
+                written++;
+            }
+            band.nextPageRow++;
+        }
+    };
+
+    // reduce las filas nuevas al nivel siguiente, escribe páginas y descarta lo que ya no hace falta
+    std::function<void(int)> advance = [&](int level) {
+        Band& band = bands[level];
+        writePages(level);
+        if (level + 1 < levelCount)
+        {
+            Band& child = bands[level + 1];
+            std::vector<unsigned char> reduced;
+            int produced = 0;
+            while (child.nextChildRow < child.height)
+            {
+                int row0 = 2 * child.nextChildRow;
+                int rows = std::min(2, band.height - row0);
+                if (band.available() < row0 + rows)
+                    break;
+                reduced.resize(reduced.size() + child.stride());
+                downsampleBoxRows(band.rowAt(row0), band.width, rows, 4,
+                                  reduced.data() + (size_t)produced * child.stride(), child.width, 0, 1, true);
+                child.nextChildRow++;
+                produced++;
+            }
+            if (produced > 0)
+            {
+                child.rows.insert(child.rows.end(), reduced.begin(), reduced.end());
+                advance(level + 1);
+            }
+        }
+        int keepPages = band.nextPageRow < band.pageRows ? band.nextPageRow * pageSize - border : band.height;
+        int keepChild = level + 1 < levelCount && bands[level + 1].nextChildRow < bands[level + 1].height
+            ? 2 * bands[level + 1].nextChildRow : band.height;
+        int keep = std::min(std::min(keepPages, keepChild), band.available());
+        if (keep > band.firstRow)
+        {
+            band.rows.erase(band.rows.begin(), band.rows.begin() + (size_t)(keep - band.firstRow) * band.stride());
+            band.firstRow = keep;
+        }
+    };
+
+    Band& top = bands[0];
+    int batch = std::max(1, pageSize);
+    for (int y = 0; y < source.height() && !failed; y += batch)
+    {
+        int count = std::min(batch, source.height() - y);
+        size_t offset = top.rows.size();
+        top.rows.resize(offset + (size_t)count * top.stride());
+        if (!source.readRows(count, top.rows.data() + offset))
+            return -1;
+        advance(0);
+    }
+    return failed ? -1 : written;
+}
+
+/**
+ * @class VirtualTexture
+ * @brief Caché física de páginas, indirección y carga bajo demanda
+ */
+class VirtualTexture
+{
+public:
+    /**
+     * @param source Origen de las páginas
+     * @param pageSize Lado de página en píxeles, sin borde
+     * @param border Borde por lado para el filtrado bilineal
+     * @param cacheSlots Casillas por lado de la caché física (hasta 256)
+     * @param uploadsPerFrame Páginas que update() sube como máximo
+     */
+    VirtualTexture(std::shared_ptr<const VirtualTextureSource> source, int pageSize = 128, int border = 1,
+                   int cacheSlots = 16, int uploadsPerFrame = 8)
+        : source(source), pageSize(pageSize), border(border), slotSize(pageSize + 2 * border),
+          slotsPerSide(std::min(cacheSlots, 256)), uploadsPerFrame(uploadsPerFrame), running(true)
+    {
+        pagesPerSide = virtualPagesPerSide(source->width(), source->height(), pageSize);
+        levelCount = 1;
+        while ((pagesPerSide >> (levelCount - 1)) > 1)
+            levelCount++;
+        slots.resize((size_t)slotsPerSide * slotsPerSide);
+        indirection.resize(levelCount);
+        for (int level = 0; level < levelCount; level++)
+            indirection[level].assign((size_t)levelPages(level) * levelPages(level) * 4, 0);
+
+        int cacheSize = slotsPerSide * slotSize;
+        glGenTextures(1, &cacheTexture);
+        glBindTexture(GL_TEXTURE_2D, cacheTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, cacheSize, cacheSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+        glGenTextures(1, &indirectionTexture);
+        glBindTexture(GL_TEXTURE_2D, indirectionTexture);
+        for (int level = 0; level < levelCount; level++)
+        {
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, levelPages(level), levelPages(level), 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+
+        // la página raíz cubre toda la imagen: se carga ya y nunca se expulsa, así
+        // siempre hay un ancestro al que caer
+        LoadedPage root;
+        root.key = pageKey(levelCount - 1, 0, 0);
+        root.pixels.resize((size_t)slotSize * slotSize * 4);
+        if (!source->readPage(levelCount - 1, 0, 0, pageSize, border, root.pixels.data()))
+            std::cout << "ERROR::VIRTUAL_TEXTURE::ROOT_PAGE_NOT_LOADED" << std::endl;
+        store(root, 0);
+        slots[0].pinned = true;
+        rebuildIndirection();
+
+        loader = std::thread(&VirtualTexture::loadLoop, this);
+    }
+
+    ~VirtualTexture()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        wake.notify_all();
+        loader.join();
+        glDeleteTextures(1, &cacheTexture);
+        glDeleteTextures(1, &indirectionTexture);
+    }
+
+    VirtualTexture(const VirtualTexture&) = delete;
+    VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+    /**
+     * @brief Registra las páginas que pidió el pase de feedback
+     * @param texels Texels RGBA16UI (x, y, nivel, válido) leídos del feedback
+     * @param count Cantidad de texels
+     * @details Marca como usadas las residentes y encola las que faltan, junto con
+     *          sus ancestros, de la más gruesa a la más fina. Las peticiones
+     *          anteriores que nadie volvió a pedir se descartan.
+     */
+    void processFeedback(const uint16_t* texels, size_t count)
+    {
+        frame++;
+        std::unordered_set<uint64_t> needed;
+        for (size_t i = 0; i < count; i++)
+        {
+            const uint16_t* texel = texels + i * 4;
+            if (texel[3] == 0 || texel[2] >= levelCount)
+                continue;
+            int level = texel[2];
+            int x = texel[0];
+            int y = texel[1];
+            if (x >= levelPages(level) || y >= levelPages(level))
+                continue;
+            // subir por los ancestros hasta uno ya visto en este frame
+            for (; level < levelCount && needed.insert(pageKey(level, x, y)).second; level++, x /= 2, y /= 2)
+            {
+            }
+        }
+
+        std::vector<uint64_t> missing;
+        for (uint64_t key : needed)
+        {
+            auto resident = pageTable.find(key);
+            if (resident != pageTable.end())
+                slots[resident->second].lastUsed = frame;
+            else
+                missing.push_back(key);
+        }
+        // nivel en los bits altos: orden descendente = primero las más gruesas
+        std::sort(missing.begin(), missing.end(), std::greater<uint64_t>());
+
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.assign(missing.begin(), missing.end());
+        wake.notify_one();
+    }
+
+    /**
+     * @brief Sube las páginas que terminó de leer el hilo de carga
+     * @details Llamar una vez por frame desde el hilo de render.
+     */
+    void update()
+    {
+        std::vector<LoadedPage> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t take = std::min<size_t>(loaded.size(), (size_t)uploadsPerFrame);
+            ready.assign(std::make_move_iterator(loaded.begin()), std::make_move_iterator(loaded.begin() + take));
+            loaded.erase(loaded.begin(), loaded.begin() + take);
+        }
+        bool changed = false;
+        for (LoadedPage& page : ready)
+        {
+            if (pageTable.count(page.key))
+                continue;
+            int slot = evictableSlot();
+            if (slot < 0)
+                break; // todo lo residente se usa en este frame: quedan los ancestros
+            store(page, slot);
+            changed = true;
+        }
+        if (changed)
+            rebuildIndirection();
+    }
+
+    /**
+     * @brief Enlaza la caché y la indirección y fija los uniforms de virtual_texture.glsl
+     * @param program Programa en uso (glUseProgram ya llamado)
+     * @param feedbackBias Sesgo de nivel para el pase de feedback (ver VirtualTextureFeedback::bias)
+     */
+    void bind(unsigned int program, unsigned int cacheUnit = 0, unsigned int indirectionUnit = 1, float feedbackBias = 0.0f) const
+    {
+        glActiveTexture(GL_TEXTURE0 + cacheUnit);
+        glBindTexture(GL_TEXTURE_2D, cacheTexture);
+        glActiveTexture(GL_TEXTURE0 + indirectionUnit);
+        glBindTexture(GL_TEXTURE_2D, indirectionTexture);
+        glUniform1i(glGetUniformLocation(program, "uVtCache"), (int)cacheUnit);
+        glUniform1i(glGetUniformLocation(program, "uVtIndirection"), (int)indirectionUnit);
+        float extent = (float)pagesPerSide * pageSize;
+        glUniform4f(glGetUniformLocation(program, "uVtParams"), source->width() / extent, source->height() / extent,
+                    (float)pagesPerSide, (float)(levelCount - 1));
+        glUniform4f(glGetUniformLocation(program, "uVtCacheParams"), (float)pageSize, (float)border,
+                    (float)(slotsPerSide * slotSize), feedbackBias);
+    }
+
+    int levels() const { return levelCount; }
+    size_t residentPages() const { return pageTable.size(); }
+
+    size_t pendingPages()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return requests.size() + loaded.size();
+    }
+
+private:
+    /**
+     * @struct Slot
+     * @brief Casilla de la caché física
+     */
+    struct Slot
+    {
+        uint64_t key = 0;
+        uint64_t lastUsed = 0;
+        bool used = false;
+        bool pinned = false;
+    };
+
+    /**
+     * @struct LoadedPage
+     * @brief Página leída por el hilo de carga, lista para subir
+     */
+    struct LoadedPage
+    {
+        uint64_t key = 0;
+        std::vector<unsigned char> pixels;
+    };
+
+    std::shared_ptr<const VirtualTextureSource> source;
+    int pageSize;
+    int border;
+    int slotSize;
+    int slotsPerSide;
+    int uploadsPerFrame;
+    int pagesPerSide = 1;
+    int levelCount = 1;
+    unsigned int cacheTexture = 0;
+    unsigned int indirectionTexture = 0;
+    uint64_t frame = 0;
+    std::vector<Slot> slots;
+    std::unordered_map<uint64_t, int> pageTable; ///< Página residente -> casilla
+    std::vector<std::vector<unsigned char>> indirection;
+    std::vector<uint64_t> changedPages; ///< Guardadas o expulsadas desde la última subida de la indirección
+
+    // compartido con el hilo de carga
+    std::thread loader;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<uint64_t> requests;
+    std::vector<LoadedPage> loaded;
+    bool running;
+
+    int levelPages(int level) const { return std::max(1, pagesPerSide >> level); }
+
+    static uint64_t pageKey(int level, int x, int y)
+    {
+        return ((uint64_t)level << 48) | ((uint64_t)y << 24) | (uint64_t)x;
+    }
+
+    static void unpackKey(uint64_t key, int& level, int& x, int& y)
+    {
+        level = (int)(key >> 48);
+        y = (int)((key >> 24) & 0xFFFFFF);
+        x = (int)(key & 0xFFFFFF);
+    }
+
+    /// Casilla libre o la usada hace más tiempo; -1 si todas se usan en este frame
+    int evictableSlot() const
+    {
+        int best = -1;
+        for (size_t i = 0; i < slots.size(); i++)
+        {
+            if (slots[i].pinned)
+                continue;
+            if (!slots[i].used)
+                return (int)i;
+            if (slots[i].lastUsed < frame && (best < 0 || slots[i].lastUsed < slots[best].lastUsed))
+                best = (int)i;
+        }
+        return best;
+    }
+
+    void store(const LoadedPage& page, int slot)
+    {
+        Slot& target = slots[slot];
+        if (target.used)
+        {
+            pageTable.erase(target.key);
+            changedPages.push_back(target.key);
+        }
+        changedPages.push_back(page.key);
+        target.key = page.key;
+        target.lastUsed = frame;
+        target.used = true;
+        pageTable[page.key] = slot;
+
+        glBindTexture(GL_TEXTURE_2D, cacheTexture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, (slot % slotsPerSide) * slotSize, (slot / slotsPerSide) * slotSize,
+                        slotSize, slotSize, GL_RGBA, GL_UNSIGNED_BYTE, page.pixels.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+
+    /**
+     * @brief Reescribe la indirección bajo las páginas guardadas o expulsadas
+     * @details Cada página no residente hereda la entrada de su padre, así el
+     *          shader siempre encuentra el ancestro cargado más fino. Solo cambia
+     *          el subárbol de cada página tocada: se recalcula y se sube un
+     *          rectángulo por nivel, la unión de esos subárboles, de arriba hacia
+     *          abajo para que cada nivel lea a su padre ya actualizado.
+     */
+    void rebuildIndirection()
+    {
+        if (changedPages.empty())
+            return;
+        // rectángulos [x0, x1) x [y0, y1) por nivel; x0 == x1 = nivel sin cambios
+        std::vector<int> x0(levelCount, 0), y0(levelCount, 0), x1(levelCount, 0), y1(levelCount, 0);
+        for (uint64_t key : changedPages)
+        {
+            int pageLevel, pageX, pageY;
+            unpackKey(key, pageLevel, pageX, pageY);
+            for (int level = pageLevel; level >= 0; level--)
+            {
+                int shift = pageLevel - level;
+                int pages = levelPages(level);
+                int left = std::min(pages, pageX << shift);
+                int top = std::min(pages, pageY << shift);
+                int right = std::min(pages, (pageX + 1) << shift);
+                int bottom = std::min(pages, (pageY + 1) << shift);
+                if (x0[level] == x1[level])
+                {
+                    x0[level] = left;
+                    y0[level] = top;
+                    x1[level] = right;
+                    y1[level] = bottom;
+                }
+                else
+                {
+                    x0[level] = std::min(x0[level], left);
+                    y0[level] = std::min(y0[level], top);
+                    x1[level] = std::max(x1[level], right);
+                    y1[level] = std::max(y1[level], bottom);
+                }
+            }
+        }
+        changedPages.clear();
+
+        glBindTexture(GL_TEXTURE_2D, indirectionTexture);
+        for (int level = levelCount - 1; level >= 0; level--)
+        {
+            if (x0[level] == x1[level])
+                continue;
+            int pages = levelPages(level);
+            std::vector<unsigned char>& entries = indirection[level];
+            for (int y = y0[level]; y < y1[level]; y++)
+            {
+                for (int x = x0[level]; x < x1[level]; x++)
+                {
+                    unsigned char* entry = &entries[((size_t)y * pages + x) * 4];
+                    auto resident = pageTable.find(pageKey(level, x, y));
+                    if (resident != pageTable.end())
+                    {
+                        entry[0] = (unsigned char)(resident->second % slotsPerSide);
+                        entry[1] = (unsigned char)(resident->second / slotsPerSide);
+                        entry[2] = (unsigned char)level;
+                        entry[3] = 255;
+                    }
+                    else
+                    {
+                        int parentPages = levelPages(level + 1);
+                        memcpy(entry, &indirection[level + 1][((size_t)(y / 2) * parentPages + x / 2) * 4], 4);
+                    }
+                }
+            }
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, pages);
+            glPixelStorei(GL_UNPACK_SKIP_PIXELS, x0[level]);
+            glPixelStorei(GL_UNPACK_SKIP_ROWS, y0[level]);
+            glTexSubImage2D(GL_TEXTURE_2D, level, x0[level], y0[level], x1[level] - x0[level], y1[level] - y0[level],
+                            GL_RGBA, GL_UNSIGNED_BYTE, entries.data());
+        }
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    }
+
+    void loadLoop()
+    {
+        std::vector<unsigned char> pixels;
+        for (;;)
+        {
+            uint64_t key;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return !running || !requests.empty(); });
+                if (!running)
+                    return;
+                key = requests.front();
+                requests.pop_front();
+            }
+            int level, x, y;
+            unpackKey(key, level, x, y);
+            LoadedPage page;
+            page.key = key;
+            page.pixels.resize((size_t)slotSize * slotSize * 4);
+            if (!source->readPage(level, x, y, pageSize, border, page.pixels.data()))
+                continue; // queda el ancestro; se volverá a pedir si sigue visible
+
+            std::lock_guard<std::mutex> lock(mutex);
+            loaded.push_back(std::move(page));
+        }
+    }
+};
+
+/**
+ * @class VirtualTextureFeedback
+ * @brief Framebuffer reducido del pase de feedback y su lectura asíncrona
+ * @details end() copia el color a un PBO; read() mapea el PBO del frame anterior,
+ *          así la lectura no espera a que la GPU termine el frame actual.
+ */
+class VirtualTextureFeedback
+{
+public:
+    /**
+     * @param width Ancho de la pantalla
+     * @param height Alto de la pantalla
+     * @param scale Divisor de resolución del feedback (8 = un texel cada 8x8 píxeles)
+     */
+    VirtualTextureFeedback(int width, int height, int scale = 8) : scale(std::max(1, scale))
+    {
+        glGenFramebuffers(1, &framebuffer);
+        glGenTextures(1, &color);
+        glGenRenderbuffers(1, &depth);
+        glGenBuffers(2, pixelBuffers);
+        resize(width, height);
+    }
+
+    ~VirtualTextureFeedback()
+    {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteTextures(1, &color);
+        glDeleteRenderbuffers(1, &depth);
+        glDeleteBuffers(2, pixelBuffers);
+    }
+
+    VirtualTextureFeedback(const VirtualTextureFeedback&) = delete;
+    VirtualTextureFeedback& operator=(const VirtualTextureFeedback&) = delete;
+
+    /// Redimensiona con la pantalla; descarta las lecturas en curso
+    void resize(int screenWidth, int screenHeight)
+    {
+        width = std::max(1, screenWidth / scale);
+        height = std::max(1, screenHeight / scale);
+        glBindTexture(GL_TEXTURE_2D, color);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16UI, width, height, 0, GL_RGBA_INTEGER, GL_UNSIGNED_SHORT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindRenderbuffer(GL_RENDERBUFFER, depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::VIRTUAL_TEXTURE::FEEDBACK_FRAMEBUFFER_INCOMPLETE" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        for (int i = 0; i < 2; i++)
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[i]);
+            glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width * height * 4 * sizeof(uint16_t), nullptr, GL_STREAM_READ);
+            pending[i] = false;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    /// Sesgo de nivel: el feedback ve derivadas scale veces mayores que la pantalla
+    float bias() const { return -std::log2((float)scale); }
+
+    /// Enlaza y limpia el framebuffer del feedback; dibujar con vtFeedback
+    void begin()
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(0, 0, width, height);
+        const GLuint clearColor[4] = { 0, 0, 0, 0 };
+        glClearBufferuiv(GL_COLOR, 0, clearColor);
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+
+    /**
+     * @brief Encola la copia al PBO y restaura el framebuffer por defecto
+     * @param screenWidth Viewport a restaurar
+     * @param screenHeight Viewport a restaurar
+     */
+    void end(int screenWidth, int screenHeight)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[current]);
+        glReadPixels(0, 0, width, height, GL_RGBA_INTEGER, GL_UNSIGNED_SHORT, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        pending[current] = true;
+        current ^= 1;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, screenWidth, screenHeight);
+    }
+
+    /**
+     * @brief Copia los texels del feedback del frame anterior
+     * @return false si todavía no hay ninguno
+     */
+    bool read(std::vector<uint16_t>& texels)
+    {
+        // current ya apunta al PBO escrito hace un frame
+        if (!pending[current])
+            return false;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[current]);
+        size_t count = (size_t)width * height * 4;
+        const uint16_t* data = (const uint16_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, count * sizeof(uint16_t), GL_MAP_READ_BIT);
+        if (data)
+            texels.assign(data, data + count);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        pending[current] = false;
+        return data != nullptr;
+    }
+
+private:
+    unsigned int framebuffer = 0;
+    unsigned int color = 0;
+    unsigned int depth = 0;
+    unsigned int pixelBuffers[2] = { 0, 0 };
+    bool pending[2] = { false, false };
+    int current = 0;
+    int scale;
+    int width = 0;
+    int height = 0;
+};
+
+#endif
@@ -0,0 +1,101 @@
+/**
+ * @file vtex_build.cpp
+ * @brief Herramienta offline que corta una imagen en páginas de textura virtual
+ * @details Escribe prefix/info y prefix/nivel/x_y.tile para TileAssetSource
+ *          (virtual_texture.h). El directorio se puede empaquetar con pack_build
+ *          para leer las páginas proyectadas desde un .lpak.
+ *
+ *          La imagen se recorre por bandas de filas y los mipmaps se arman a
+ *          medida que llegan (writeVirtualTilesFromRows). Un .ppm/.pgm binario se
+ *          lee así directo del disco, sin límite de tamaño; los demás formatos
+ *          los decodifica stb_image enteros, hasta unos 536 Mpx en RGBA.
+ *
+ *          Compilar:  g++ -std=c++17 -O2 -pthread vtex_build.cpp -o vtex_build
+ *          Usar:      ./vtex_build scan.png tiles/scan [--page 128] [--border 1]
+ *                     ./vtex_build huge.ppm tiles/huge
+ *                     ./pack_build scan.lpak --lz4 tiles/scan
+ */
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "image_memory.h" // STBI_MALLOC/STBI_FREE al pool; antes que stb_image.h
+#include "stb_image.h"
+#undef STB_IMAGE_IMPLEMENTATION // los demás headers solo necesitan las declaraciones
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "virtual_texture.h"
+
+using namespace std;
+
+/**
+ * @brief Imprime la forma de uso
+ */
+void printUsage(const char* program) {
+    cout << "Uso: " << program << " <imagen> <prefijo> [--page N] [--border N]" << endl;
+    cout << "  --page N    lado de página en píxeles (potencia de 2, por defecto 128)" << endl;
+    cout << "  --border N  borde por lado para el filtrado (por defecto 1)" << endl;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    string input = argv[1];
+    string prefix = argv[2];
+    int pageSize = 128;
+    int border = 1;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--page") == 0 && i + 1 < argc) {
+            pageSize = atoi(argv[++i]);
+            if (pageSize < 16 || (pageSize & (pageSize - 1)) != 0) {
+                cout << "--page debe ser una potencia de 2 mayor o igual a 16" << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--border") == 0 && i + 1 < argc) {
+            border = atoi(argv[++i]);
+            if (border < 0 || border > pageSize / 4) {
+                cout << "--border debe estar entre 0 y página / 4" << endl;
+                return 1;
+            }
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // un PPM se lee por filas; el resto se decodifica entero, sin la cadena de mipmaps
+    unique_ptr<VirtualRowSource> source;
+    unsigned char* pixels = nullptr;
+    if (PpmRowSource::handles(input)) {
+        unique_ptr<PpmRowSource> ppm(new PpmRowSource(input));
+        if (!ppm->valid()) {
+            return 1;
+        }
+        source = move(ppm);
+    } else {
+        if (!ImageVirtualSource::fitsInMemoryDecode(input)) {
+            return 1;
+        }
+        int width, height, channels;
+        pixels = loadImageAsset(input, &width, &height, &channels, 4);
+        if (!pixels) {
+            cout << "Failed to load texture: " << input << endl;
+            return 1;
+        }
+        source.reset(new ImageRowSource(pixels, width, height));
+    }
+    long long pages = writeVirtualTilesFromRows(*source, prefix, pageSize, border);
+    stbi_image_free(pixels);
+    if (pages < 0) {
+        cout << "No se pudo escribir " << prefix << endl;
+        return 1;
+    }
+    int side = virtualPagesPerSide(source->width(), source->height(), pageSize);
+    cout << input << " -> " << prefix << ": " << source->width() << "x" << source->height() << ", "
+         << side << "x" << side << " páginas en el nivel 0, " << pages << " archivos" << endl;
+    return 0;
+}